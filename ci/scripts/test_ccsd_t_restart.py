@@ -0,0 +1,109 @@
+#!/usr/bin/env python
+
+# Restarts a screened CCSD(T) run from its (T) checkpoint and checks that the [T]/(T) energies
+# and the screening report (skipped tasks, error bound) match those of an uninterrupted run.
+#
+# The first run of the restarted job is killed after kill_after seconds, which have to fall in
+# its (T) step; the CCSD amplitudes written by that run are read back by the restart.
+
+import glob
+import json
+import os
+import shutil
+import signal
+import subprocess
+import sys
+
+if len(sys.argv) < 4:
+    print("\nUsage: python3 test_ccsd_t_restart.py CCSD_T_executable input.json kill_after_seconds"
+          " [launcher ...]")
+    print("   e.g. python3 test_ccsd_t_restart.py build/CCSD_T inputs/h2o.json 30 mpirun -n 4")
+    sys.exit(1)
+
+exe        = os.path.abspath(sys.argv[1])
+input_path = os.path.abspath(sys.argv[2])
+kill_after = float(sys.argv[3])
+launcher   = sys.argv[4:]
+screen     = 1e-9
+
+with open(input_path) as f:
+    base_input = json.load(f)
+name = os.path.splitext(os.path.basename(input_path))[0]
+
+def make_run(dir, ckpt_interval):
+    if os.path.exists(dir): shutil.rmtree(dir)
+    os.makedirs(dir)
+    data = json.loads(json.dumps(base_input))
+    pt = data.setdefault("CC", {}).setdefault("CCSD(T)", {})
+    pt["ccsdt_screen_thresh"] = screen
+    pt["ccsdt_ckpt_interval"] = ckpt_interval
+    with open(os.path.join(dir, name + ".json"), "w") as f:
+        json.dump(data, f, indent=2)
+    return launcher + [exe, name + ".json"]
+
+def run(dir, cmd, timeout=None):
+    with open(os.path.join(dir, "output.log"), "a") as log:
+        proc = subprocess.Popen(cmd, cwd=dir, stdout=log, stderr=subprocess.STDOUT,
+                                start_new_session=True)
+        try:
+            return proc.wait(timeout=timeout)
+        except subprocess.TimeoutExpired:
+            os.killpg(proc.pid, signal.SIGKILL)
+            proc.wait()
+            return None
+
+def results(dir):
+    files = glob.glob(os.path.join(dir, "**", "*.ccsd_t.json"), recursive=True)
+    if not files:
+        print("ERROR: no CCSD(T) results in " + dir)
+        sys.exit(1)
+    with open(files[0]) as f:
+        return json.load(f)["output"]["CCSD(T)"]
+
+workdir = os.path.abspath("ccsd_t_restart_test")
+
+# the reference, run without checkpoints
+ref_dir = os.path.join(workdir, "reference")
+if run(ref_dir, make_run(ref_dir, 0)) != 0:
+    print("ERROR: the reference run failed, see " + ref_dir + "/output.log")
+    sys.exit(1)
+
+# killed in (T), then restarted from the checkpoint
+rst_dir = os.path.join(workdir, "restart")
+cmd     = make_run(rst_dir, 1)
+if run(rst_dir, cmd, kill_after) is not None:
+    print("ERROR: the run finished before it was killed, lower kill_after_seconds")
+    sys.exit(1)
+if not glob.glob(os.path.join(rst_dir, "**", "*.ccsdt_ckpt.*"), recursive=True):
+    print("ERROR: the run was killed before its first (T) checkpoint, raise kill_after_seconds")
+    sys.exit(1)
+if run(rst_dir, cmd) != 0:
+    print("ERROR: the restarted run failed, see " + rst_dir + "/output.log")
+    sys.exit(1)
+with open(os.path.join(rst_dir, "output.log")) as f:
+    if "Restarting (T) from checkpoint" not in f.read():
+        print("ERROR: the restarted run did not resume (T) from the checkpoint")
+        sys.exit(1)
+
+ref = results(ref_dir)
+cur = results(rst_dir)
+
+def check(what, ref_value, cur_value, tol):
+    if abs(ref_value - cur_value) > tol:
+        print("ERROR: mismatch in " + what + "\nreference: " + str(ref_value) + ", restarted: "
+              + str(cur_value))
+        return False
+    return True
+
+ok  = check("[T] correction energy", ref["[T]Energies"]["correction"],
+            cur["[T]Energies"]["correction"], 1e-10)
+ok &= check("(T) correction energy", ref["(T)Energies"]["correction"],
+            cur["(T)Energies"]["correction"], 1e-10)
+ok &= check("screened tasks", ref["screening"]["skipped_tasks"],
+            cur["screening"]["skipped_tasks"], 0)
+ok &= check("screening error bound", ref["screening"]["error_bound"],
+            cur["screening"]["error_bound"], 1e-9 * abs(ref["screening"]["error_bound"]))
+if not ok: sys.exit(1)
+
+print(name + ": restarted screened CCSD(T) run matches the uninterrupted one ("
+      + str(int(cur["screening"]["skipped_tasks"])) + " tasks screened)")
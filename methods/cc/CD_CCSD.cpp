@@ -78,12 +78,14 @@ void ccsd_driver() {
   Tensor<T>              d_r1, d_r2, d_t1, d_t2;
   std::vector<Tensor<T>> d_r1s, d_r2s, d_t1s, d_t2s;
 
+  // the DIIS history tensors, unless the history goes to disk or is compressed
+  const int diis_slots = ccsd_options.diis_storage == "memory" ? ccsd_options.ndiis : 0;
   if(is_rhf)
     std::tie(p_evl_sorted, d_t1, d_t2, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s) = setupTensors_cs(
-      ec, MO, d_f1, ccsd_options.ndiis, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
+      ec, MO, d_f1, diis_slots, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
   else
     std::tie(p_evl_sorted, d_t1, d_t2, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s) = setupTensors(
-      ec, MO, d_f1, ccsd_options.ndiis, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
+      ec, MO, d_f1, diis_slots, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
 
   if(ccsd_restart) {
     read_from_disk(d_f1, f1file);
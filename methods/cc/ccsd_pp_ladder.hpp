@@ -0,0 +1,107 @@
+#pragma once
+
+#include "chol_product_tensor.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace tamm;
+
+//
+//  particle-particle ladder with the VVVV integrals built from the Cholesky-like vectors L1, L2:
+//
+//    i0(a,b,i,j) += alpha sum_{c,d} v(a,b,c,d) t2(c,d,i,j),  v(a,b,c,d) = sum_Q L1(a,c,Q) L2(b,d,Q)
+//
+//  the work items are (A,B) tile pairs times ranges of C tiles, enough of them that every rank
+//  gets about two even when there are fewer tile pairs than ranks; they are dealt out round-robin.
+//  an item reads the slices L1(A,C,:) of its C range once, then for every D reads L2(B,D,:) once
+//  and builds each v(A,B,C,D) tile of the range with one GEMM over Q, contracting it against every
+//  occupied tile pair (I,J) of t2(C,D,I,J) before moving on. every VVVV tile is thus built once
+//  per call, instead of once per occupied tile pair as when v is a lazy tensor in a TAMM
+//  contraction. the partial results for all (I,J) are accumulated locally and added to i0 at the
+//  end of the item. collective over ec.
+//
+//  i0, t2 are on (Va,Vb,Oa,Ob), L1 on (Va,Va,CI) and L2 on (Vb,Vb,CI).
+//
+template<typename T>
+void ccsd_pp_ladder(ExecutionContext& ec, Tensor<T> i0, Tensor<T> t2, Tensor<T> L1, Tensor<T> L2,
+                    T alpha) {
+  const auto&  tis    = i0.tiled_index_spaces();
+  const size_t nva    = tis[0].num_tiles();
+  const size_t nvb    = tis[1].num_tiles();
+  const size_t noa    = tis[2].num_tiles();
+  const size_t nob    = tis[3].num_tiles();
+  const size_t rank   = ec.pg().rank().value();
+  const size_t nranks = ec.pg().size().value();
+
+  // C ranges per tile pair
+  const size_t npairs  = nva * nvb;
+  const size_t nranges = std::min(nva, std::max<size_t>(1, (2 * nranks + npairs - 1) / npairs));
+
+  std::vector<std::vector<T>> l1;
+  std::vector<T>              l2, lbuf, w, wp, tbuf;
+  std::vector<std::vector<T>> r(noa * nob);
+
+  for(size_t item = rank; item < npairs * nranges; item += nranks) {
+    const size_t A = item / (nvb * nranges), B = item / nranges % nvb, range = item % nranges;
+    const size_t C0 = range * nva / nranges, C1 = (range + 1) * nva / nranges;
+
+    const auto   abdims = i0.block_dims({A, B, 0, 0});
+    const size_t na = abdims[0], nb = abdims[1];
+    for(size_t I = 0; I < noa; I++)
+      for(size_t J = 0; J < nob; J++) {
+        auto& rij = r[I * nob + J];
+        rij.clear();
+        if(i0.is_non_zero({A, B, I, J})) rij.assign(i0.block_size({A, B, I, J}), 0);
+      }
+
+    // L1(A,C,:) of the range, as l1[C - C0]
+    bool any = false;
+    l1.resize(C1 - C0);
+    for(size_t C = C0; C < C1; C++) {
+      get_chol_slice(L1, A, C, l1[C - C0], lbuf);
+      any = any || !l1[C - C0].empty();
+    }
+    if(!any) continue;
+
+    for(size_t D = 0; D < nvb; D++) {
+      get_chol_slice(L2, B, D, l2, lbuf);
+      if(l2.empty()) continue;
+      const size_t nd = L2.block_dims({B, D, 0})[1];
+
+      for(size_t C = C0; C < C1; C++) {
+        const auto& l1c = l1[C - C0];
+        if(l1c.empty()) continue;
+        const size_t nc = L1.block_dims({A, C, 0})[1];
+        const size_t nq = l1c.size() / (na * nc);
+
+        // v(a,c,b,d) with one GEMM over Q, then as the (ab) x (cd) matrix of the contraction
+        w.resize(na * nc * nb * nd);
+        blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::Trans, na * nc, nb * nd,
+                   nq, alpha, l1c.data(), nq, l2.data(), nq, T{0}, w.data(), nb * nd);
+        wp.resize(w.size());
+        for(size_t a = 0; a < na; a++)
+          for(size_t c = 0; c < nc; c++)
+            for(size_t b = 0; b < nb; b++)
+              std::copy(&w[((a * nc + c) * nb + b) * nd], &w[((a * nc + c) * nb + b) * nd] + nd,
+                        &wp[((a * nb + b) * nc + c) * nd]);
+
+        for(size_t I = 0; I < noa; I++)
+          for(size_t J = 0; J < nob; J++) {
+            auto& rij = r[I * nob + J];
+            if(rij.empty() || !t2.is_non_zero({C, D, I, J})) continue;
+            tbuf.resize(t2.block_size({C, D, I, J}));
+            t2.get({C, D, I, J}, tbuf);
+            const size_t nij = tbuf.size() / (nc * nd);
+            blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::NoTrans, na * nb, nij,
+                       nc * nd, T{1}, wp.data(), nc * nd, tbuf.data(), nij, T{1}, rij.data(), nij);
+          }
+      }
+    }
+
+    for(size_t I = 0; I < noa; I++)
+      for(size_t J = 0; J < nob; J++)
+        if(!r[I * nob + J].empty()) i0.add({A, B, I, J}, r[I * nob + J]);
+  }
+  ec.pg().barrier();
+}
@@ -1,18 +1,41 @@
 // clang-format off
 #include "cc/cd_ccsd_os_ann.hpp"
 #include "cc/ccsd_t/ccsd_t_fused_driver.hpp"
+#include "cc/ccsd_t/ccsd_t_closed_shell.hpp"
+#include "cc/ccsd_t/ccsd_t_ijk.hpp"
+#include "cc/ccsd_t/ccsd_t_chol_iabc.hpp"
+#include "cc/ccsd_t/ccsd_t_autotune.hpp"
+#include "cc/ccsd_t/ccsd_t_phase_ranks.hpp"
 // clang-format on
 
 void        ccsd_t_driver();
 std::string filename;
-double      ccsdt_s1_t1_GetTime  = 0;
-double      ccsdt_s1_v2_GetTime  = 0;
-double      ccsdt_d1_t2_GetTime  = 0;
-double      ccsdt_d1_v2_GetTime  = 0;
-double      ccsdt_d2_t2_GetTime  = 0;
-double      ccsdt_d2_v2_GetTime  = 0;
-double      genTime              = 0;
-double      ccsd_t_data_per_rank = 0; // in GB
+double      ccsdt_s1_t1_GetTime     = 0;
+double      ccsdt_s1_v2_GetTime     = 0;
+double      ccsdt_d1_t2_GetTime     = 0;
+double      ccsdt_d1_v2_GetTime     = 0;
+double      ccsdt_d2_t2_GetTime     = 0;
+double      ccsdt_d2_v2_GetTime     = 0;
+double      ccsdt_prefetch_DataTime = 0;
+double      ccsdt_prefetch_WaitTime = 0;
+double      ccsdt_task_fetches      = 0;
+double      ccsdt_num_ops           = 0;
+double      ccsdt_fp32_samples      = 0;
+double      ccsdt_cs_GetTime        = 0;
+double      ccsdt_ijk_GetTime       = 0;
+double      genTime                 = 0;
+int         ccsdt_stage_threads     = 1;
+double      ccsd_t_data_per_rank    = 0; // bytes, reported in GB
+std::mutex  ccsdt_ga_lock;
+
+double ccsdt_lru_lookups[CCSDT_CACHE_D2V + 1] = {};
+double ccsdt_lru_hits[CCSDT_CACHE_D2V + 1]    = {};
+double ccsdt_fp32_error[2]                    = {};
+
+ccsd_t_node_cache ccsdt_node_cache;
+ccsd_t_checkpoint ccsdt_checkpoint;
+ccsd_t_screening  ccsdt_screening;
+ccsd_t_chol_iabc  ccsdt_chol_iabc;
 
 int main(int argc, char* argv[]) {
   if(argc < 2) {
@@ -49,7 +72,7 @@ void ccsd_t_driver() {
         AO_tis, scf_conv] = hartree_fock_driver<T>(ec, filename);
 
   CCSDOptions& ccsd_options   = sys_data.options_map.ccsd_options;
-  const int    ccsdt_tilesize = ccsd_options.ccsdt_tilesize;
+  int          ccsdt_tilesize = ccsd_options.ccsdt_tilesize; // may be set by ccsdt_autotune
 
   sys_data.n_frozen_core    = sys_data.options_map.ccsd_options.freeze_core;
   sys_data.n_frozen_virtual = sys_data.options_map.ccsd_options.freeze_virtual;
@@ -59,36 +82,6 @@ void ccsd_t_driver() {
   if(!t_errmsg.empty()) tamm_terminate(t_errmsg);
 #endif
 
-  int nsranks = sys_data.nbf / 15;
-  if(nsranks < 1) nsranks = 1;
-  int ga_cnn = ec.nnodes();
-  if(nsranks > ga_cnn) nsranks = ga_cnn;
-  nsranks = nsranks * GA_Cluster_nprocs(0);
-  int subranks[nsranks];
-  for(int i = 0; i < nsranks; i++) subranks[i] = i;
-
-#if defined(USE_UPCXX)
-  upcxx::team subcomm = upcxx::world().split((rank < nsranks) ? 0 : upcxx::team::color_none, 0);
-#else
-  auto      world_comm = ec.pg().comm();
-  MPI_Group world_group;
-  MPI_Comm_group(world_comm, &world_group);
-  MPI_Group subgroup;
-  MPI_Group_incl(world_group, nsranks, subranks, &subgroup);
-  MPI_Comm subcomm;
-  MPI_Comm_create(world_comm, subgroup, &subcomm);
-#endif
-
-  ProcGroup         sub_pg;
-  ExecutionContext* sub_ec = nullptr;
-
-  if(rank < nsranks) {
-    sub_pg = ProcGroup::create_coll(subcomm);
-    sub_ec = new ExecutionContext(sub_pg, DistributionKind::nw, MemoryManagerKind::ga);
-  }
-
-  Scheduler sub_sch{*sub_ec};
-
   // force writet on
   ccsd_options.writet       = true;
   ccsd_options.computeTData = true;
@@ -100,7 +93,9 @@ void ccsd_t_driver() {
   if(rank == 0)
     cout << endl << "#occupied, #virtual = " << sys_data.nocc << ", " << sys_data.nvir << endl;
 
-  auto [MO, total_orbitals] = setupMOIS(sys_data);
+  TiledIndexSpace MO;
+  TAMM_SIZE       total_orbitals;
+  std::tie(MO, total_orbitals) = setupMOIS(sys_data);
 
   std::string out_fp       = sys_data.output_file_prefix + "." + ccsd_options.basis;
   std::string files_dir    = out_fp + "_files/" + sys_data.options_map.scf_options.scf_type;
@@ -115,6 +110,43 @@ void ccsd_t_driver() {
   const bool is_rhf       = sys_data.is_restricted;
   bool       computeTData = ccsd_options.computeTData;
 
+  // spin-adapted (T) straight from the closed-shell amplitudes, kept in memory after CCSD
+  const bool cs_engine = is_rhf && !skip_ccsd && ccsd_options.ccsdt_engine == "closed_shell";
+  if(ccsd_options.ccsdt_engine == "closed_shell" && !cs_engine && rank == 0)
+    cout << "ccsdt_engine = closed_shell needs an RHF reference and the CCSD step, "
+         << "using the tiled engine" << endl;
+  if(cs_engine) ccsd_options.writev = false;
+  // occupied-triplet DGEMM (T) on the same inputs as the tiled engine
+  const bool ijk_engine = ccsd_options.ccsdt_engine == "ijk";
+  // FP32 inputs, t3 and GEMMs with FP64 energy sums, in the CPU kernels of the tiled engine
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+  const bool cpu_tiled = false;
+#else
+  const bool cpu_tiled = !cs_engine && !ijk_engine;
+#endif
+  if(ccsd_options.ccsdt_precision == "mixed" && !cpu_tiled) {
+    if(rank == 0) cout << "ccsdt_precision = mixed only applies to the tiled CPU engine" << endl;
+    ccsd_options.ccsdt_precision = "double";
+  }
+  // the staging thread fetches blocks while the main thread takes tasks from the counter; their
+  // calls are serialized (ccsd_t_ga_call), but come from two threads
+  if(ccsd_options.ccsdt_prefetch) {
+    int thread_level;
+    MPI_Query_thread(&thread_level);
+    if(thread_level < MPI_THREAD_SERIALIZED) {
+      if(rank == 0)
+        cout << "ccsdt_prefetch needs MPI_THREAD_SERIALIZED, disabling the (T) input block prefetch"
+             << endl;
+      ccsd_options.ccsdt_prefetch = false;
+    }
+  }
+  // v2iabc blocks built from the retiled Cholesky vectors instead of stored
+  const bool chol_iabc =
+    ccsd_options.ccsdt_iabc_cholesky && !cs_engine && computeTData && !skip_ccsd;
+  if(ccsd_options.ccsdt_iabc_cholesky && !chol_iabc && rank == 0)
+    cout << "ccsdt_iabc_cholesky needs the Cholesky vectors of the CCSD step and a spin-orbital "
+         << "engine, storing v2iabc" << endl;
+
   bool ccsd_restart = ccsd_options.readt || ((fs::exists(t1file) && fs::exists(t2file) &&
                                               fs::exists(f1file) && fs::exists(v2file)));
 
@@ -130,6 +162,111 @@ void ccsd_t_driver() {
   std::vector<T> p_evl_sorted;
   double         residual = 0, corr_energy = 0;
 
+  const double gib = (1024 * 1024 * 1024.0);
+  const std::vector<std::string> v2_names =
+    chol_iabc ? std::vector<std::string>{"ijab", "ijka"}
+              : std::vector<std::string>{"ijab", "ijka", "iabc"};
+
+  // memory (GiB) of the (T) input tensors on a tiling MOT of the (T) space
+  auto input_tensor_mem = [&](const TiledIndexSpace& MOT) {
+    const double Osize = MO("occ").max_num_indices();
+    const double Vsize = MO("virt").max_num_indices();
+    // const double Nsize = N.max_num_indices();
+    // const double cind_size = CI.max_num_indices();
+    Tensor<T>    t_t1{{MOT("virt"), MOT("occ")}, {1, 1}};
+    Tensor<T>    t_t2{{MOT("virt"), MOT("virt"), MOT("occ"), MOT("occ")}, {2, 2}};
+    Tensor<T>    t_cv2{{MOT("all"), MOT("all"), CI}, {1, 1}};
+    V2Tensors<T> t_v2(v2_names);
+
+    T mem = cs_engine ? sum_tensor_sizes(d_f1) : sum_tensor_sizes(d_f1, t_t1, t_t2);
+    if(cs_engine) mem += sum_tensor_sizes(d_t1, d_t2) + ccsd_t_cs_inputs<T>{MOT}.tensor_sizes();
+    else if(!skip_ccsd) {
+      // auto v2_setup_mem = sum_tensor_sizes(d_f1,t_d_v2,t_d_cv2);
+      // auto cv2_retile = (Nsize*Nsize*cind_size*8)/gib + sum_tensor_sizes(d_f1,cholVpr,t_d_cv2);
+      if(is_rhf) mem += sum_tensor_sizes(dt1_full, dt2_full);
+      else mem += sum_tensor_sizes(d_t1, d_t2);
+
+      // retiling allocates full GA versions of the t1,t2 tensors.
+      mem += (Osize * Vsize + Vsize * Vsize * Osize * Osize) * 8 / gib;
+    }
+
+    // const auto ccsd_t_mem_old = ccsd_t_mem + sum_tensor_sizes(t_d_v2);
+    if(!cs_engine) mem += t_v2.tensor_sizes(MOT);
+    // the FP32 copies of t1, t2 and v2 in mixed precision
+    if(ccsd_options.ccsdt_precision == "mixed")
+      mem += (sum_tensor_sizes(t_t1, t_t2) + t_v2.tensor_sizes(MOT)) / 2;
+    if(chol_iabc) mem += sum_tensor_sizes(t_cv2);
+    return mem;
+  };
+
+  //
+  //  the (T) space MO1. it is set up after CCSD, or before it when the v2 blocks are built while
+  //  CCSD runs.
+  //
+  TiledIndexSpace MO1;
+  TAMM_SIZE       total_orbitals1;
+
+  auto setup_triples_space = [&]() {
+    // ccsdt_tilesize and cache_size from the time and memory model, before the (T) space is tiled
+    const bool autotune = ccsd_options.ccsdt_autotune && !cs_engine && !ijk_engine;
+    if(ccsd_options.ccsdt_autotune && !autotune && rank == 0)
+      cout << "ccsdt_autotune models the tiled engine, keeping ccsdt_tilesize and cache_size"
+           << endl;
+    if(autotune) {
+      auto [MOT, total_orbitals_t] = setupMOIS(sys_data, true);
+      const double     node_cache_mem = ccsd_options.ccsdt_node_cache_mb * ec.nnodes() / 1024.0;
+      const double     mem_limit      = static_cast<double>(ec.mem_info().total_cpu_mem);
+      ccsd_t_autotuner tuner(sys_data, is_rhf, ec.pg().size().value(), GA_Cluster_nprocs(0),
+                             input_tensor_mem(MOT), node_cache_mem,
+                             chol_iabc ? (double) CI.max_num_indices() : 0.0);
+      tuner.calibrate(ec);
+
+      std::vector<ccsd_t_tuning> tried;
+      const ccsd_t_tuning        tuned  = tuner.tune(mem_limit, tried);
+      const std::string          reason = tuned.fits
+                                            ? "fastest predicted run within the available memory"
+                                            : "nothing fits in the available memory, smallest "
+                                              "memory requirement";
+      ccsd_options.ccsdt_tilesize = ccsdt_tilesize = tuned.tilesize;
+      ccsd_options.cache_size                      = tuned.cache_size;
+
+      if(rank == 0) {
+        std::sort(tried.begin(), tried.end(), [](const ccsd_t_tuning& a, const ccsd_t_tuning& b) {
+          return a.time() < b.time();
+        });
+        cout << endl
+             << "(T) autotuning: dgemm " << std::fixed << std::setprecision(1)
+             << tuner.rate() / 1e9 << " GFLOP/s, memory bandwidth " << tuner.bandwidth() / 1e9
+             << " GB/s per rank, memory available " << mem_limit << " GiB" << endl;
+        cout << " tilesize  cache_size  memory (GiB)  compute (s)  communication (s)" << endl;
+        int shown = 0;
+        for(auto& tn: tried) {
+          if(!tn.fits || shown++ == 5) continue;
+          cout << std::setw(9) << tn.tilesize << std::setw(12) << tn.cache_size << std::setw(14)
+               << tn.mem << std::setw(13) << tn.compute << std::setw(19) << tn.comm << endl;
+        }
+        cout << "ccsdt_tilesize = " << tuned.tilesize << ", cache_size = " << tuned.cache_size
+             << ": " << reason << " (predicted " << tuned.time() << " s, " << tuned.mem
+             << " GiB)" << endl
+             << endl;
+
+        auto& jtune             = sys_data.results["output"]["CCSD(T)"]["autotune"];
+        jtune["ccsdt_tilesize"] = tuned.tilesize;
+        jtune["cache_size"]     = tuned.cache_size;
+        jtune["predicted_time"] = tuned.time();
+        jtune["memory"]         = tuned.mem;
+        jtune["reason"]         = reason;
+      }
+    }
+
+    std::tie(MO1, total_orbitals1) = setupMOIS(sys_data, true);
+  };
+  V2Tensors<T> v2tensors(v2_names);
+  Tensor<T>    t_d_cv2;
+
+  ccsd_t_phase_plan                   phases;
+  std::unique_ptr<ccsd_t_phase_group> v2_group;
+
   if(!skip_ccsd) {
     // deallocates F_AO, C_AO
     std::tie(cholVpr, d_f1, lcao, chol_count, max_cvecs, CI) =
@@ -142,12 +279,14 @@ void ccsd_t_driver() {
     Tensor<T>              d_r1, d_r2;
     std::vector<Tensor<T>> d_r1s, d_r2s, d_t1s, d_t2s;
 
+    // the DIIS history tensors, unless the history goes to disk or is compressed
+    const int diis_slots = ccsd_options.diis_storage == "memory" ? ccsd_options.ndiis : 0;
     if(is_rhf)
       std::tie(p_evl_sorted, d_t1, d_t2, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s) = setupTensors_cs(
-        ec, MO, d_f1, ccsd_options.ndiis, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
+        ec, MO, d_f1, diis_slots, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
     else
       std::tie(p_evl_sorted, d_t1, d_t2, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s) = setupTensors(
-        ec, MO, d_f1, ccsd_options.ndiis, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
+        ec, MO, d_f1, diis_slots, ccsd_restart && fs::exists(ccsdstatus) && scf_conv);
 
     if(ccsd_restart) {
       read_from_disk(d_f1, f1file);
@@ -193,46 +332,54 @@ void ccsd_t_driver() {
     if(ccsd_options.writev)
       computeTData = computeTData && !fs::exists(t1file) && !fs::exists(t2file);
 
-    if(computeTData && is_rhf) setup_full_t1t2(ec, MO, dt1_full, dt2_full);
-
-    if(is_rhf) {
-      if(ccsd_restart) {
-        if(rank < nsranks) {
-          const int ppn = GA_Cluster_nprocs(0);
-          if(rank == 0)
-            std::cout << "Executing with " << nsranks << " ranks (" << nsranks / ppn << " nodes)"
-                      << std::endl;
-          std::tie(residual, corr_energy) = cd_ccsd_cs_driver<T>(
-            sys_data, *sub_ec, MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s,
-            p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData);
-        }
-        ec.pg().barrier();
-      }
-      else {
-        std::tie(residual, corr_energy) = cd_ccsd_cs_driver<T>(
-          sys_data, ec, MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s,
-          p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData);
-      }
+    if(computeTData && is_rhf && !cs_engine) setup_full_t1t2(ec, MO, dt1_full, dt2_full);
+
+    // ranks of the CCSD and v2 setup phases; the tensors stay on all the ranks
+    double ccsd_alloc_mem =
+      sum_tensor_sizes(cholVpr, d_f1) + sum_tensor_sizes(d_t1, d_t2) * (2 + 4 * diis_slots);
+    if(computeTData && is_rhf && !cs_engine)
+      ccsd_alloc_mem += sum_tensor_sizes(dt1_full, dt2_full);
+    phases = ccsd_t_plan_phases(ec, sys_data, MO, (double) CI.max_num_indices(), ccsd_alloc_mem,
+                                computeTData && !cs_engine && !ccsd_options.writev);
+    if(rank == 0) {
+      cout << "CCSD on " << phases.ccsd_nodes << " nodes (" << phases.ccsd_ranks() << " ranks)";
+      if(computeTData && !cs_engine)
+        cout << ", v2 setup on " << phases.v2_nodes << " nodes (" << phases.v2_ranks() << " ranks)"
+             << (phases.overlap ? " while CCSD runs" : "");
+      cout << endl;
     }
-    else {
-      if(ccsd_restart) {
-        if(rank < nsranks) {
-          const int ppn = GA_Cluster_nprocs(0);
-          if(rank == 0)
-            std::cout << "Executing with " << nsranks << " ranks (" << nsranks / ppn << " nodes)"
-                      << std::endl;
-          std::tie(residual, corr_energy) = cd_ccsd_os_driver<T>(
-            sys_data, *sub_ec, MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s,
-            p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData);
-        }
-        ec.pg().barrier();
-      }
-      else {
+
+    ccsd_t_phase_group ccsd_group(ec, 0, phases.ccsd_ranks());
+    if(computeTData && !cs_engine)
+      v2_group = std::make_unique<ccsd_t_phase_group>(ec, phases.v2_first(), phases.v2_ranks());
+
+    // the v2 setup needs only the Cholesky vectors, so it can start on the ranks CCSD leaves idle
+    if(phases.overlap) {
+      setup_triples_space();
+      t_d_cv2 = Tensor<T>{{MO1("all"), MO1("all"), CI}, {1, 1}};
+      Tensor<T>::allocate(&ec, t_d_cv2);
+      retile_tamm_tensor(cholVpr, t_d_cv2, "CholV2");
+      v2tensors.allocate(ec, MO1);
+    }
+
+    if(ccsd_group.member()) {
+      if(is_rhf)
+        std::tie(residual, corr_energy) = cd_ccsd_cs_driver<T>(
+          sys_data, ccsd_group.ec(), MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s,
+          d_t2s, p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData && !cs_engine);
+      else
         std::tie(residual, corr_energy) = cd_ccsd_os_driver<T>(
-          sys_data, ec, MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s, d_t2s,
-          p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData);
-      }
+          sys_data, ccsd_group.ec(), MO, CI, d_t1, d_t2, d_f1, d_r1, d_r2, d_r1s, d_r2s, d_t1s,
+          d_t2s, p_evl_sorted, cholVpr, ccsd_restart, files_prefix, computeTData);
+    }
+    else if(phases.overlap && v2_group->member())
+      computeV2Tensors(v2_group->ec(), v2tensors, t_d_cv2, ex_hw);
+    ec.pg().barrier();
+    if(phases.ccsd_nodes < phases.nnodes) {
+      ec.pg().broadcast(&residual, 0);
+      ec.pg().broadcast(&corr_energy, 0);
     }
+    if(phases.overlap) v2_group->destroy();
 
     if(computeTData && is_rhf) {
       if(ccsd_options.writev) {
@@ -255,14 +402,7 @@ void ccsd_t_driver() {
       }
     }
 
-    if(rank < nsranks) {
-      (*sub_ec).flush_and_sync();
-#ifdef USE_UPCXX
-      subcomm.destroy();
-#else
-      MPI_Comm_free(&subcomm);
-#endif
-    }
+    ccsd_group.destroy();
 
     auto   cc_t2 = std::chrono::high_resolution_clock::now();
     double ccsd_time =
@@ -285,7 +425,7 @@ void ccsd_t_driver() {
       free_vec_tensors(d_r1s, d_r2s, d_t1s, d_t2s);
     }
 
-    if(is_rhf) free_tensors(d_t1, d_t2);
+    if(is_rhf && !cs_engine) free_tensors(d_t1, d_t2);
     ec.flush_and_sync();
   }
   else { // skip ccsd
@@ -296,7 +436,7 @@ void ccsd_t_driver() {
     if(rank == 0) sys_data.print();
   }
 
-  auto [MO1, total_orbitals1] = setupMOIS(sys_data, true);
+  if(!phases.overlap) setup_triples_space();
   TiledIndexSpace N1          = MO1("all");
   TiledIndexSpace O1          = MO1("occ");
   TiledIndexSpace V1          = MO1("virt");
@@ -305,31 +445,12 @@ void ccsd_t_driver() {
   // Tensor<T> t_d_f1{{N1,N1},{1,1}};
   // Tensor<T> t_d_v2{{N1,N1,N1,N1}, {2,2}};
 
-  Tensor<T>    t_d_t1{{V1, O1}, {1, 1}};
-  Tensor<T>    t_d_t2{{V1, V1, O1, O1}, {2, 2}};
-  Tensor<T>    t_d_cv2{{N1, N1, CI}, {1, 1}};
-  V2Tensors<T> v2tensors({"ijab", "ijka", "iabc"});
+  Tensor<T>           t_d_t1{{V1, O1}, {1, 1}};
+  Tensor<T>           t_d_t2{{V1, V1, O1, O1}, {2, 2}};
+  ccsd_t_cs_inputs<T> cs_inputs{MO1};
+  if(!phases.overlap) t_d_cv2 = Tensor<T>{{N1, N1, CI}, {1, 1}};
 
-  T            ccsd_t_mem{};
-  const double gib   = (1024 * 1024 * 1024.0);
-  const double Osize = MO("occ").max_num_indices();
-  const double Vsize = MO("virt").max_num_indices();
-  // const double Nsize = N.max_num_indices();
-  // const double cind_size = CI.max_num_indices();
-
-  ccsd_t_mem = sum_tensor_sizes(d_f1, t_d_t1, t_d_t2);
-  if(!skip_ccsd) {
-    // auto v2_setup_mem = sum_tensor_sizes(d_f1,t_d_v2,t_d_cv2);
-    // auto cv2_retile = (Nsize*Nsize*cind_size*8)/gib + sum_tensor_sizes(d_f1,cholVpr,t_d_cv2);
-    if(is_rhf) ccsd_t_mem += sum_tensor_sizes(dt1_full, dt2_full);
-    else ccsd_t_mem += sum_tensor_sizes(d_t1, d_t2);
-
-    // retiling allocates full GA versions of the t1,t2 tensors.
-    ccsd_t_mem += (Osize * Vsize + Vsize * Vsize * Osize * Osize) * 8 / gib;
-  }
-
-  // const auto ccsd_t_mem_old = ccsd_t_mem + sum_tensor_sizes(t_d_v2);
-  ccsd_t_mem += v2tensors.tensor_sizes(MO1);
+  T ccsd_t_mem = input_tensor_mem(MO1);
 
   Index noab       = MO1("occ").num_tiles();
   Index nvab       = MO1("virt").num_tiles();
@@ -349,29 +470,38 @@ void ccsd_t_driver() {
       max_pdim = std::max(max_pdim, k_range[t_p4b]);
     for(size_t t_h1b = 0; t_h1b < noab; t_h1b++) max_hdim = std::max(max_hdim, k_range[t_h1b]);
 
-    size_t max_d1_kernels_pertask = 9 * noa;
-    size_t max_d2_kernels_pertask = 9 * nva;
-    size_t size_T_s1_t1           = 9 * (max_pdim) * (max_hdim);
-    size_t size_T_s1_v2           = 9 * (max_pdim * max_pdim) * (max_hdim * max_hdim);
-    size_t size_T_d1_t2 = max_d1_kernels_pertask * (max_pdim * max_pdim) * (max_hdim * max_hdim);
-    size_t size_T_d1_v2 = max_d1_kernels_pertask * (max_pdim) * (max_hdim * max_hdim * max_hdim);
-    size_t size_T_d2_t2 = max_d2_kernels_pertask * (max_pdim * max_pdim) * (max_hdim * max_hdim);
-    size_t size_T_d2_v2 = max_d2_kernels_pertask * (max_pdim * max_pdim * max_pdim) * (max_hdim);
-
-    double extra_buf_mem_per_rank =
-      size_T_s1_t1 + size_T_s1_v2 + size_T_d1_t2 + size_T_d1_v2 + size_T_d2_t2 + size_T_d2_v2;
-    extra_buf_mem_per_rank     = extra_buf_mem_per_rank * 8 / gib;
-    double total_extra_buf_mem = extra_buf_mem_per_rank * nranks;
-
-    size_t cache_buf_size =
-      ccsdt_tilesize * ccsdt_tilesize * ccsdt_tilesize * ccsdt_tilesize * 8; // bytes
-    double cache_mem_per_rank =
-      (ccsdt_tilesize * ccsdt_tilesize * 8 + cache_buf_size) * cache_size; // s1 t1+v2
-    cache_mem_per_rank += (noab + nvab) * 2 * cache_size * cache_buf_size; // d1,d2 t2+v2
-    cache_mem_per_rank     = cache_mem_per_rank / gib;
+    auto tiled_mem = ccsd_t_tiled_mem_per_rank(k_range, noa, nva, noab, nvab, ccsdt_tilesize,
+                                               cache_size,
+                                               chol_iabc ? (double) CI.max_num_indices() : 0.0);
+    double extra_buf_mem_per_rank = tiled_mem.buffers;
+    double total_extra_buf_mem    = extra_buf_mem_per_rank * nranks;
+    double cache_mem_per_rank     = tiled_mem.cache;
+
+    if(cs_engine) {
+      // W of the six orderings of a task and one product; cached blocks are at most o*v^3
+      extra_buf_mem_per_rank = 7 * std::pow(max_hdim, 3) * std::pow(max_pdim, 3) * 8 / gib;
+      total_extra_buf_mem    = extra_buf_mem_per_rank * nranks;
+      cache_mem_per_rank = cache_size * (noa + nva) * max_hdim * std::pow(max_pdim, 3) * 8 / gib;
+    }
+    if(ijk_engine) {
+      // pair operands of an occupied tile triplet, the slabs of cache_size virtual tiles and the
+      // three blocks of W of a virtual tile pair per thread
+      const double o_n = std::accumulate(k_range.begin(), k_range.begin() + noab, 0.0);
+      const double v_n = std::accumulate(k_range.begin() + noab, k_range.end(), 0.0);
+      const double t_n = max_hdim, x_n = max_pdim;
+      extra_buf_mem_per_rank = 3 * t_n * t_n * (2 * v_n + o_n) * v_n + o_n * v_n +
+                               std::max<double>(2, cache_size) * 3 * t_n * (v_n + o_n) * x_n * v_n +
+                               omp_get_max_threads() * 3 * v_n * x_n * x_n;
+      extra_buf_mem_per_rank = extra_buf_mem_per_rank * 8 / gib;
+      total_extra_buf_mem    = extra_buf_mem_per_rank * nranks;
+      cache_mem_per_rank     = 0;
+    }
     double total_cache_mem = cache_mem_per_rank * nranks; // GiB
 
-    double total_ccsd_t_mem = ccsd_t_mem + total_extra_buf_mem + total_cache_mem;
+    double total_node_cache_mem = ccsd_options.ccsdt_node_cache_mb * ec.nnodes() / 1024.0; // GiB
+
+    double total_ccsd_t_mem =
+      ccsd_t_mem + total_extra_buf_mem + total_cache_mem + total_node_cache_mem;
     if(rank == 0) {
       std::cout << std::string(70, '-') << std::fixed << std::setprecision(2) << std::endl;
       std::cout << "Total CPU memory required for (T) calculation = " << total_ccsd_t_mem << " GiB"
@@ -385,6 +515,9 @@ void ccsd_t_driver() {
         cache_msg += " (set cache_size option in the input file to a lower value to reduce this "
                      "memory requirement further)";
       std::cout << cache_msg << ": " << total_cache_mem << " GiB" << std::endl;
+      if(total_node_cache_mem > 0)
+        std::cout << " -- memory required for the node-shared block cache: " << total_node_cache_mem
+                  << " GiB" << std::endl;
       // std::cout << "***** old memory requirement was "
       //           << ccsd_t_mem_old + total_extra_buf_mem + total_cache_mem
       //           << " GiB (old v2 = " << sum_tensor_sizes(t_d_v2)
@@ -395,16 +528,35 @@ void ccsd_t_driver() {
   }
 
   if(computeTData && !skip_ccsd) {
-    Tensor<T>::allocate(&ec, t_d_cv2);
-    retile_tamm_tensor(cholVpr, t_d_cv2, "CholV2");
+    if(!phases.overlap) {
+      Tensor<T>::allocate(&ec, t_d_cv2);
+      retile_tamm_tensor(cholVpr, t_d_cv2, "CholV2");
+    }
     free_tensors(cholVpr);
 
-    v2tensors = setupV2Tensors<T>(ec, t_d_cv2, ex_hw, v2tensors.get_blocks());
-    if(ccsd_options.writev) {
-      v2tensors.write_to_disk(files_prefix);
-      v2tensors.deallocate();
+    if(cs_engine) {
+      cs_inputs.allocate(ec);
+      ccsd_t_cs_setup(ec, cs_inputs, t_d_cv2, d_t1, d_t2, ex_hw);
+      free_tensors(d_t1, d_t2);
     }
-    free_tensors(t_d_cv2);
+    else {
+      if(!phases.overlap) {
+        v2tensors.allocate(ec, MO1);
+        if(v2_group->member()) computeV2Tensors(v2_group->ec(), v2tensors, t_d_cv2, ex_hw);
+        ec.pg().barrier();
+        v2_group->destroy();
+      }
+      if(ccsd_options.writev) {
+        v2tensors.write_to_disk(files_prefix);
+        v2tensors.deallocate();
+      }
+    }
+    if(chol_iabc) {
+      auto                mo_tiles = MO1.input_tile_sizes();
+      std::vector<size_t> k_range(mo_tiles.begin(), mo_tiles.end());
+      ccsdt_chol_iabc.init(t_d_cv2, noab, k_range, cache_size * nvab);
+    }
+    else free_tensors(t_d_cv2);
   }
 
   double energy1 = 0, energy2 = 0;
@@ -414,13 +566,13 @@ void ccsd_t_driver() {
     cout << endl << "CCSD MO Tiles = " << mo_tiles << endl;
   }
 
-  Tensor<T>::allocate(&ec, t_d_t1, t_d_t2);
+  if(!cs_engine) Tensor<T>::allocate(&ec, t_d_t1, t_d_t2);
   if(skip_ccsd) v2tensors.allocate(ec, MO1);
 
   bool ccsd_t_restart = fs::exists(t1file) && fs::exists(t2file) && fs::exists(f1file) &&
                         v2tensors.exist_on_disk(files_prefix);
 
-  if(!ccsd_t_restart && !skip_ccsd) {
+  if(!ccsd_t_restart && !skip_ccsd && !cs_engine) {
     if(!is_rhf) {
       dt1_full = d_t1;
       dt2_full = d_t2;
@@ -486,11 +638,41 @@ void ccsd_t_driver() {
   for(tamm::Index x = 0; x < nvab / 2; x++) k_spin.push_back(1);
   for(tamm::Index x = nvab / 2; x < nvab; x++) k_spin.push_back(2);
 
-  double ccsd_t_time = 0, total_t_time = 0;
+  {
+    size_t max_tile = 0;
+    for(auto x: MO1.input_tile_sizes()) max_tile = std::max<size_t>(max_tile, x);
+    ccsdt_node_cache.init(ec.pg().comm(), (size_t) ccsd_options.ccsdt_node_cache_mb * 1024 * 1024,
+                          max_tile * max_tile * max_tile * max_tile * sizeof(T));
+  }
+  initMemModule(ccsd_options.ccsdt_huge_pages);
+  ccsdt_checkpoint.init(ec.pg().comm(), files_prefix + ".ccsdt_ckpt",
+                        ccsd_options.ccsdt_ckpt_interval);
+  if(ccsd_options.ccsdt_screen_thresh > 0) {
+    if(cs_engine || ijk_engine) {
+      if(rank == 0) cout << "ccsdt_screen_thresh only applies to the tiled engine" << endl;
+    }
+    else {
+      auto                mo_tiles = MO1.input_tile_sizes();
+      std::vector<size_t> k_range(mo_tiles.begin(), mo_tiles.end());
+      ccsdt_screening.init(ec, ccsd_options.ccsdt_screen_thresh, noab, nvab, k_range,
+                           p_evl_sorted, t_d_t1, t_d_t2, v2tensors);
+    }
+  }
+
+  double ccsd_t_time    = 0, total_t_time = 0;
+  double engine_num_ops = 0;
   // cc_t1 = std::chrono::high_resolution_clock::now();
-  std::tie(energy1, energy2, ccsd_t_time, total_t_time) = ccsd_t_fused_driver_new<T>(
-    sys_data, ec, k_spin, MO1, t_d_t1, t_d_t2, v2tensors, p_evl_sorted, hf_energy + corr_energy,
-    is_restricted, cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v, seq_h3b);
+  if(cs_engine)
+    std::tie(energy1, energy2, ccsd_t_time, total_t_time) =
+      ccsd_t_cs_driver<T>(sys_data, ec, MO1, cs_inputs, p_evl_sorted, engine_num_ops);
+  else if(ijk_engine)
+    std::tie(energy1, energy2, ccsd_t_time, total_t_time) =
+      ccsd_t_ijk_driver<T>(sys_data, ec, k_spin, MO1, t_d_t1, t_d_t2, v2tensors, p_evl_sorted,
+                           is_restricted, engine_num_ops);
+  else
+    std::tie(energy1, energy2, ccsd_t_time, total_t_time) = ccsd_t_fused_driver_new<T>(
+      sys_data, ec, k_spin, MO1, t_d_t1, t_d_t2, v2tensors, p_evl_sorted, hf_energy + corr_energy,
+      is_restricted, cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v, seq_h3b);
 
   // cc_t2 = std::chrono::high_resolution_clock::now();
   // auto ccsd_t_time =
@@ -498,6 +680,7 @@ void ccsd_t_driver() {
 
   energy1 = ec.pg().reduce(&energy1, ReduceOp::sum, 0);
   energy2 = ec.pg().reduce(&energy2, ReduceOp::sum, 0);
+  ccsdt_checkpoint.finalize();
 
   if(rank == 0 && !skip_ccsd) {
     std::cout.precision(15);
@@ -519,18 +702,41 @@ void ccsd_t_driver() {
       hf_energy + corr_energy + energy2;
   }
 
-  long double total_num_ops = 0;
+  if(ccsdt_screening.enabled()) {
+    double g_skipped = ec.pg().reduce(&ccsdt_screening.skipped, ReduceOp::sum, 0);
+    double g_error   = ec.pg().reduce(&ccsdt_screening.error, ReduceOp::sum, 0);
+    if(rank == 0) {
+      cout << "(T) screening: " << g_skipped
+           << " tasks skipped, bound on the [T]/(T) energy error = " << g_error << endl;
+      sys_data.results["output"]["CCSD(T)"]["screening"]["skipped_tasks"] = g_skipped;
+      sys_data.results["output"]["CCSD(T)"]["screening"]["error_bound"]   = g_error;
+    }
+  }
+
   //
-  if(rank == 0) {
-    // std::cout << "--------------------------------------------------------------------" <<
-    // std::endl;
-    ccsd_t_fused_driver_calculator_ops<T>(sys_data, ec, k_spin, MO1, p_evl_sorted,
-                                          hf_energy + corr_energy, is_restricted, total_num_ops,
-                                          seq_h3b);
-    // std::cout << "--------------------------------------------------------------------" <<
-    // std::endl;
+  //  the FP32 error of the mixed-precision run: the FP32 - FP64 energy differences of the sampled
+  //  tasks, scaled up to all the tasks
+  //
+  if(ccsd_options.ccsdt_precision == "mixed" && ccsd_options.ccsdt_fp32_sample > 0) {
+    double g_samples = ec.pg().reduce(&ccsdt_fp32_samples, ReduceOp::sum, 0);
+    double g_error1  = ec.pg().reduce(&ccsdt_fp32_error[0], ReduceOp::sum, 0);
+    double g_error2  = ec.pg().reduce(&ccsdt_fp32_error[1], ReduceOp::sum, 0);
+    if(rank == 0) {
+      g_error1 /= ccsd_options.ccsdt_fp32_sample;
+      g_error2 /= ccsd_options.ccsdt_fp32_sample;
+      cout << "(T) mixed precision: " << g_samples << " tasks re-run in FP64, estimated "
+           << "FP32 error of the [T] energy = " << g_error1 << ", of the (T) energy = " << g_error2
+           << endl;
+      sys_data.results["output"]["CCSD(T)"]["mixed_precision"]["sampled_tasks"] = g_samples;
+      sys_data.results["output"]["CCSD(T)"]["mixed_precision"]["[T]error"]      = g_error1;
+      sys_data.results["output"]["CCSD(T)"]["mixed_precision"]["(T)error"]      = g_error2;
+    }
   }
 
+  // operations of the tasks each rank ran, counted during the run
+  if(!cs_engine && !ijk_engine) engine_num_ops = ccsdt_num_ops;
+  long double total_num_ops = ec.pg().reduce(&engine_num_ops, ReduceOp::sum, 0);
+
   ec.pg().barrier();
 
   auto nranks = ec.pg().size().value();
@@ -572,22 +778,97 @@ void ccsd_t_driver() {
     write_json_data(sys_data, "CCSD_T");
   }
 
-  comm_stats("S1-T1 GetTime", ccsdt_s1_t1_GetTime);
-  comm_stats("S1-V2 GetTime", ccsdt_s1_v2_GetTime);
-  comm_stats("D1-T2 GetTime", ccsdt_d1_t2_GetTime);
-  comm_stats("D1-V2 GetTime", ccsdt_d1_v2_GetTime);
-  comm_stats("D2-T2 GetTime", ccsdt_d2_t2_GetTime);
-  comm_stats("D2-V2 GetTime", ccsdt_d2_v2_GetTime);
+  if(ccsd_options.ccsdt_task_schedule == "guided" || ccsd_options.ccsdt_task_order != "loop") {
+    double g_task_fetches = ec.pg().reduce(&ccsdt_task_fetches, ReduceOp::sum, 0);
+    if(rank == 0)
+      std::cout << std::defaultfloat << "   -> Task counter fetches: " << g_task_fetches
+                << std::fixed << std::endl;
+  }
 
-  ccsd_t_data_per_rank          = (ccsd_t_data_per_rank * 8.0) / (1024 * 1024.0 * 1024); // GB
+  if(cs_engine) comm_stats("Closed-shell GetTime", ccsdt_cs_GetTime);
+  else if(ijk_engine) comm_stats("ijk GetTime", ccsdt_ijk_GetTime);
+  else {
+    comm_stats("S1-T1 GetTime", ccsdt_s1_t1_GetTime);
+    comm_stats("S1-V2 GetTime", ccsdt_s1_v2_GetTime);
+    comm_stats("D1-T2 GetTime", ccsdt_d1_t2_GetTime);
+    comm_stats("D1-V2 GetTime", ccsdt_d1_v2_GetTime);
+    comm_stats("D2-T2 GetTime", ccsdt_d2_t2_GetTime);
+    comm_stats("D2-V2 GetTime", ccsdt_d2_v2_GetTime);
+  }
+  if(ccsd_options.ccsdt_prefetch) {
+    const double data_time = comm_stats("Prefetch DataTime", ccsdt_prefetch_DataTime);
+    const double wait_time = comm_stats("Prefetch WaitTime", ccsdt_prefetch_WaitTime);
+    if(rank == 0 && data_time > 0)
+      std::cout << "   -> Overlapped communication: " << data_time - wait_time << "s ("
+                << (data_time - wait_time) * 100.0 / data_time << "%)" << std::endl;
+  }
+
+  ccsd_t_data_per_rank          = ccsd_t_data_per_rank / (1024 * 1024.0 * 1024); // GB
   double g_ccsd_t_data_per_rank = ec.pg().reduce(&ccsd_t_data_per_rank, ReduceOp::sum, 0);
   if(rank == 0)
     std::cout << "   -> Data Transfer (GB): " << g_ccsd_t_data_per_rank / nranks << std::endl;
 
+  if(!cs_engine && !ijk_engine) {
+    if(rank == 0) std::cout << "   -> LRU Cache Hit Rates:";
+    for(int id = CCSDT_CACHE_S1T; id <= CCSDT_CACHE_D2V; id++) {
+      double g_lookups = ec.pg().reduce(&ccsdt_lru_lookups[id], ReduceOp::sum, 0);
+      double g_hits    = ec.pg().reduce(&ccsdt_lru_hits[id], ReduceOp::sum, 0);
+      if(rank == 0)
+        std::cout << " " << ccsd_t_cache_names[id] << " "
+                  << (g_lookups > 0 ? g_hits * 100.0 / g_lookups : 0.0) << "%";
+    }
+    if(rank == 0) std::cout << std::endl;
+  }
+
+  if(ccsdt_chol_iabc.enabled()) {
+    double g_generated = ec.pg().reduce(&ccsdt_chol_iabc.generated, ReduceOp::sum, 0);
+    if(rank == 0)
+      std::cout << std::defaultfloat << "   -> v2iabc blocks built from Cholesky vectors: "
+                << g_generated << std::fixed << std::endl;
+  }
+
+  if(ccsdt_node_cache.enabled()) {
+    double g_hits      = ec.pg().reduce(&ccsdt_node_cache.hits, ReduceOp::sum, 0);
+    double g_misses    = ec.pg().reduce(&ccsdt_node_cache.misses, ReduceOp::sum, 0);
+    double g_evictions = ec.pg().reduce(&ccsdt_node_cache.evictions, ReduceOp::sum, 0);
+    if(rank == 0) {
+      std::cout << std::defaultfloat << "   -> Node Cache Hits/Misses/Evictions: " << g_hits << "/"
+                << g_misses << "/" << g_evictions << std::fixed << " (hit rate "
+                << (g_hits + g_misses > 0 ? g_hits * 100.0 / (g_hits + g_misses) : 0.0) << "%)"
+                << std::endl;
+    }
+  }
+  ccsdt_node_cache.finalize();
+
+  // staging buffers of the tiled engine, from the host memory pool
+  if(!cs_engine && !ijk_engine) {
+    hostMemStats_t hms             = getHostMemStats();
+    double         gib             = 1024 * 1024 * 1024.0;
+    double         g_allocations   = ec.pg().reduce(&hms.allocations, ReduceOp::sum, 0);
+    double         g_resurrections = ec.pg().reduce(&hms.resurrections, ReduceOp::sum, 0);
+    double         g_peak_live     = ec.pg().reduce(&hms.peak_live, ReduceOp::max, 0);
+    double         g_peak_reserved = ec.pg().reduce(&hms.peak_reserved, ReduceOp::max, 0);
+    if(rank == 0)
+      std::cout << std::defaultfloat << "   -> Host Memory Pool: " << g_allocations
+                << " allocations, " << g_resurrections << " reused, peak per rank (GiB) "
+                << g_peak_live / gib << " in use, " << g_peak_reserved / gib << " reserved"
+                << std::fixed << std::endl;
+  }
+
   ec.pg().barrier();
 
-  free_tensors(t_d_t1, t_d_t2, d_f1);
-  v2tensors.deallocate();
+  if(cs_engine) {
+    cs_inputs.deallocate();
+    free_tensors(d_f1);
+  }
+  else {
+    free_tensors(t_d_t1, t_d_t2, d_f1);
+    v2tensors.deallocate();
+  }
+  if(ccsdt_chol_iabc.enabled()) {
+    ccsdt_chol_iabc.finalize();
+    free_tensors(t_d_cv2);
+  }
 
   ec.flush_and_sync();
   // delete ec;
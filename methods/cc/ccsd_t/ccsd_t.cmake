@@ -8,6 +8,17 @@ set(CCSD_T_SRCS
     ${CCSD_T_SRCDIR}/hybrid.cpp
     ${CCSD_T_SRCDIR}/ccsd_t_fused_driver.hpp
     ${CCSD_T_SRCDIR}/fused_common.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_node_cache.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_task_order.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_checkpoint.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_transpose.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_closed_shell.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_ijk.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_screening.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_chol_iabc.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_staging.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_autotune.hpp
+    ${CCSD_T_SRCDIR}/ccsd_t_phase_ranks.hpp
     )
 
 if(USE_CUDA)
@@ -29,7 +40,8 @@ elseif(USE_DPCPP)
             ${CCSD_T_SRCDIR}/ccsd_t_all_fused_nontcCuda_Hip_Sycl.cpp)
 else()
     set(CCSD_T_FUSED_SRCS ${CCSD_T_SRCS}
-            ${CCSD_T_SRCDIR}/ccsd_t_all_fused_cpu.hpp)
+            ${CCSD_T_SRCDIR}/ccsd_t_all_fused_cpu.hpp
+            ${CCSD_T_SRCDIR}/ccsd_t_all_fused_cpu_kernels.hpp)
 endif()
 
 add_mpi_gpu_unit_test(CCSD_T "${CCSD_T_FUSED_SRCS}" 2 "${CMAKE_SOURCE_DIR}/../inputs/h2o.json")
@@ -232,22 +232,8 @@ void ccsd_t_fully_fused_none_df_none_task(
   size_t num_blocks = CEIL(base_size_h3b, 4) * CEIL(base_size_h2b, 4) * CEIL(base_size_h1b, 4) *
                       CEIL(base_size_p6b, 4) * CEIL(base_size_p5b, 4) * CEIL(base_size_p4b, 4);
 
-#ifdef OPT_KERNEL_TIMING
-  //
-  long double task_num_ops_s1    = 0;
-  long double task_num_ops_d1    = 0;
-  long double task_num_ops_d2    = 0;
-  long double task_num_ops_total = 0;
-
-  //
-  helper_calculate_num_ops(noab, nvab, df_simple_s1_size, df_simple_d1_size, df_simple_d2_size,
-                           df_simple_s1_exec, df_simple_d1_exec, df_simple_d2_exec, task_num_ops_s1,
-                           task_num_ops_d1, task_num_ops_d2, total_num_ops_s1, total_num_ops_d1,
-                           total_num_ops_d2);
-
-  //
-  task_num_ops_total = task_num_ops_s1 + task_num_ops_d1 + task_num_ops_d2;
-#endif
+  ccsd_t_count_task_ops(noab, nvab, df_simple_s1_size, df_simple_d1_size, df_simple_d2_size,
+                        df_simple_s1_exec, df_simple_d1_exec, df_simple_d2_exec);
 
 #ifdef OPT_KERNEL_TIMING
   gpuEvent_t start_kernel_only, stop_kernel_only;
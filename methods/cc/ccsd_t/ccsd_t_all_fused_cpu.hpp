@@ -1,64 +1,160 @@
 #pragma once
 
+#include "ccsd_t_all_fused_cpu_kernels.hpp"
 #include "fused_common.hpp"
 
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
 #define CEIL(a, b) (((a) + (b) -1) / (b))
 
+extern double ccsdt_prefetch_DataTime;
+extern double ccsdt_prefetch_WaitTime;
+extern double ccsdt_fp32_samples;
+extern double ccsdt_fp32_error[2];
+
+// (h1,h2,h3,p4,p5,p6) tile indices and symmetry factor of one CPU (T) task
+struct ccsd_t_cpu_task {
+  size_t t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b;
+  double factor;
+};
+
+//
+//  whether a mixed-precision task is also run in FP64 to estimate the FP32 error. the choice
+//  hashes the tile indices, so it does not depend on the rank or the order the tasks run in.
+//
+inline bool ccsd_t_cpu_fp64_sample(const ccsd_t_cpu_task& task, const double fraction) {
+  if(fraction <= 0) return false;
+  uint64_t key = 0;
+  for(size_t t: {task.t_h1b, task.t_h2b, task.t_h3b, task.t_p4b, task.t_p5b, task.t_p6b})
+    key = key * 1024 + t;
+  // splitmix64 finalizer
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  key = key ^ (key >> 31);
+  return (key >> 11) * 0x1.0p-53 < fraction;
+}
+
+// host buffers holding the t1/t2/v2 blocks and the enabled-term tables of one task
 template<typename T>
-void total_fused_ccsd_t_cpu(
-  bool is_restricted, const Index noab, const Index nvab, int64_t rank, std::vector<int>& k_spin,
-  std::vector<size_t>& k_range, std::vector<size_t>& k_offset, Tensor<T>& d_t1, Tensor<T>& d_t2,
-  V2Tensors<T>& d_v2, std::vector<T>& k_evl_sorted,
-  //
-  T* df_host_pinned_s1_t1, T* df_host_pinned_s1_v2, T* df_host_pinned_d1_t2,
-  T* df_host_pinned_d1_v2, T* df_host_pinned_d2_t2, T* df_host_pinned_d2_v2, T* host_energies,
-  // for new fully-fused kernel
-  int* host_d1_size_h7b, int* host_d2_size_p7b,
-  //
-  int* df_simple_s1_size, int* df_simple_d1_size, int* df_simple_d2_size, int* df_simple_s1_exec,
-  int* df_simple_d1_exec, int* df_simple_d2_exec,
-  //
-  size_t t_h1b, size_t t_h2b, size_t t_h3b, size_t t_p4b, size_t t_p5b, size_t t_p6b, double factor,
-  size_t taskid, size_t max_d1_kernels_pertask, size_t max_d2_kernels_pertask,
+struct ccsd_t_cpu_buffers {
+  T*   df_host_pinned_s1_t1;
+  T*   df_host_pinned_s1_v2;
+  T*   df_host_pinned_d1_t2;
+  T*   df_host_pinned_d1_v2;
+  T*   df_host_pinned_d2_t2;
+  T*   df_host_pinned_d2_v2;
+  int* host_d1_size_h7b;
+  int* host_d2_size_p7b;
+  int* df_simple_s1_size;
+  int* df_simple_d1_size;
+  int* df_simple_d2_size;
+  int* df_simple_s1_exec;
+  int* df_simple_d1_exec;
+  int* df_simple_d2_exec;
+};
+
+// a buffer set for blocks of up to size_T_* elements, from the host memory pool
+template<typename T>
+ccsd_t_cpu_buffers<T> ccsd_t_cpu_alloc_buffers(const Index noab, const Index nvab,
+                                               size_t size_T_s1_t1, size_t size_T_s1_v2,
+                                               size_t size_T_d1_t2, size_t size_T_d1_v2,
+                                               size_t size_T_d2_t2, size_t size_T_d2_v2) {
+  ccsd_t_cpu_buffers<T> bufs;
+  bufs.df_host_pinned_s1_t1 = (T*) getHostMem(sizeof(T) * size_T_s1_t1);
+  bufs.df_host_pinned_s1_v2 = (T*) getHostMem(sizeof(T) * size_T_s1_v2);
+  bufs.df_host_pinned_d1_t2 = (T*) getHostMem(sizeof(T) * size_T_d1_t2);
+  bufs.df_host_pinned_d1_v2 = (T*) getHostMem(sizeof(T) * size_T_d1_v2);
+  bufs.df_host_pinned_d2_t2 = (T*) getHostMem(sizeof(T) * size_T_d2_t2);
+  bufs.df_host_pinned_d2_v2 = (T*) getHostMem(sizeof(T) * size_T_d2_v2);
+  bufs.host_d1_size_h7b     = (int*) getHostMem(sizeof(int) * (noab));
+  bufs.host_d2_size_p7b     = (int*) getHostMem(sizeof(int) * (nvab));
+  bufs.df_simple_s1_size    = (int*) getHostMem(sizeof(int) * (6));
+  bufs.df_simple_d1_size    = (int*) getHostMem(sizeof(int) * (7 * noab));
+  bufs.df_simple_d2_size    = (int*) getHostMem(sizeof(int) * (7 * nvab));
+  bufs.df_simple_s1_exec    = (int*) getHostMem(sizeof(int) * (9));
+  bufs.df_simple_d1_exec    = (int*) getHostMem(sizeof(int) * (9 * noab));
+  bufs.df_simple_d2_exec    = (int*) getHostMem(sizeof(int) * (9 * nvab));
+  return bufs;
+}
+
+template<typename T>
+void ccsd_t_cpu_free_buffers(ccsd_t_cpu_buffers<T>& bufs) {
+  freeHostMem(bufs.df_host_pinned_s1_t1);
+  freeHostMem(bufs.df_host_pinned_s1_v2);
+  freeHostMem(bufs.df_host_pinned_d1_t2);
+  freeHostMem(bufs.df_host_pinned_d1_v2);
+  freeHostMem(bufs.df_host_pinned_d2_t2);
+  freeHostMem(bufs.df_host_pinned_d2_v2);
+  freeHostMem(bufs.host_d1_size_h7b);
+  freeHostMem(bufs.host_d2_size_p7b);
+  freeHostMem(bufs.df_simple_s1_size);
+  freeHostMem(bufs.df_simple_d1_size);
+  freeHostMem(bufs.df_simple_d2_size);
+  freeHostMem(bufs.df_simple_s1_exec);
+  freeHostMem(bufs.df_simple_d1_exec);
+  freeHostMem(bufs.df_simple_d2_exec);
+}
+
+// collective. copies src into dst, a tensor of the same shape in the precision F
+template<typename T, typename F>
+void ccsd_t_cpu_convert(ExecutionContext& ec, Tensor<T>& src, Tensor<F>& dst) {
+  auto convert = [&](const IndexVector& blockid) {
+    if(!src.is_non_zero(blockid)) return;
+    std::vector<T> buf(src.block_size(blockid));
+    src.get(blockid, buf);
+    std::vector<F> out(buf.begin(), buf.end());
+    dst.put(blockid, out);
+  };
+  block_for(ec, dst(), convert);
+  ec.pg().barrier();
+}
+
+// fetches (or takes from the caches) every block of a task into bufs
+template<typename T>
+void ccsd_t_data_cpu_task(
+  bool is_restricted, const Index noab, const Index nvab, std::vector<int>& k_spin,
+  std::vector<size_t>& k_range, Tensor<T>& d_t1, Tensor<T>& d_t2, V2Tensors<T>& d_v2,
+  std::vector<T>& k_evl_sorted, const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<T>& bufs,
+  size_t max_d1_kernels_pertask, size_t max_d2_kernels_pertask,
   //
   size_t size_T_s1_t1, size_t size_T_s1_v2, size_t size_T_d1_t2, size_t size_T_d1_v2,
   size_t size_T_d2_t2, size_t size_T_d2_v2,
   //
-  std::vector<double>& energy_l, LRUCache<Index, std::vector<T>>& cache_s1t,
-  LRUCache<Index, std::vector<T>>& cache_s1v, LRUCache<Index, std::vector<T>>& cache_d1t,
-  LRUCache<Index, std::vector<T>>& cache_d1v, LRUCache<Index, std::vector<T>>& cache_d2t,
-  LRUCache<Index, std::vector<T>>& cache_d2v)
-
-{
-  size_t base_size_h1b = k_range[t_h1b];
-  size_t base_size_h2b = k_range[t_h2b];
-  size_t base_size_h3b = k_range[t_h3b];
-  size_t base_size_p4b = k_range[t_p4b];
-  size_t base_size_p5b = k_range[t_p5b];
-  size_t base_size_p6b = k_range[t_p6b];
-
-  const size_t max_dim_s1_t1 = size_T_s1_t1 / 9;
-  const size_t max_dim_s1_v2 = size_T_s1_v2 / 9;
-  const size_t max_dim_d1_t2 = size_T_d1_t2 / max_d1_kernels_pertask;
-  const size_t max_dim_d1_v2 = size_T_d1_v2 / max_d1_kernels_pertask;
-  const size_t max_dim_d2_t2 = size_T_d2_t2 / max_d2_kernels_pertask;
-  const size_t max_dim_d2_v2 = size_T_d2_v2 / max_d2_kernels_pertask;
+  LRUCache<Index, std::vector<T>>& cache_s1t, LRUCache<Index, std::vector<T>>& cache_s1v,
+  LRUCache<Index, std::vector<T>>& cache_d1t, LRUCache<Index, std::vector<T>>& cache_d1v,
+  LRUCache<Index, std::vector<T>>& cache_d2t, LRUCache<Index, std::vector<T>>& cache_d2v) {
+  const size_t t_h1b = task.t_h1b, t_h2b = task.t_h2b, t_h3b = task.t_h3b;
+  const size_t t_p4b = task.t_p4b, t_p5b = task.t_p5b, t_p6b = task.t_p6b;
+
+  T*   df_host_pinned_s1_t1 = bufs.df_host_pinned_s1_t1;
+  T*   df_host_pinned_s1_v2 = bufs.df_host_pinned_s1_v2;
+  T*   df_host_pinned_d1_t2 = bufs.df_host_pinned_d1_t2;
+  T*   df_host_pinned_d1_v2 = bufs.df_host_pinned_d1_v2;
+  T*   df_host_pinned_d2_t2 = bufs.df_host_pinned_d2_t2;
+  T*   df_host_pinned_d2_v2 = bufs.df_host_pinned_d2_v2;
+  int* host_d1_size_h7b     = bufs.host_d1_size_h7b;
+  int* host_d2_size_p7b     = bufs.host_d2_size_p7b;
+  int* df_simple_s1_size    = bufs.df_simple_s1_size;
+  int* df_simple_d1_size    = bufs.df_simple_d1_size;
+  int* df_simple_d2_size    = bufs.df_simple_d2_size;
+  int* df_simple_s1_exec    = bufs.df_simple_s1_exec;
+  int* df_simple_d1_exec    = bufs.df_simple_d1_exec;
+  int* df_simple_d2_exec    = bufs.df_simple_d2_exec;
 
   int df_num_s1_enabled;
   int df_num_d1_enabled;
   int df_num_d2_enabled;
 
-  double* host_evl_sorted_h1b = &k_evl_sorted[k_offset[t_h1b]];
-  double* host_evl_sorted_h2b = &k_evl_sorted[k_offset[t_h2b]];
-  double* host_evl_sorted_h3b = &k_evl_sorted[k_offset[t_h3b]];
-  double* host_evl_sorted_p4b = &k_evl_sorted[k_offset[t_p4b]];
-  double* host_evl_sorted_p5b = &k_evl_sorted[k_offset[t_p5b]];
-  double* host_evl_sorted_p6b = &k_evl_sorted[k_offset[t_p6b]];
-
   std::fill(df_simple_s1_exec, df_simple_s1_exec + (9), -1);
   std::fill(df_simple_d1_exec, df_simple_d1_exec + (9 * noab), -1);
   std::fill(df_simple_d2_exec, df_simple_d2_exec + (9 * nvab), -1);
@@ -89,526 +185,250 @@ void total_fused_ccsd_t_cpu(
                      host_d2_size_p7b, df_simple_d2_size, df_simple_d2_exec, &df_num_d2_enabled,
                      //
                      cache_d2t, cache_d2v);
+}
 
-  //
-  size_t size_tensor_t3 =
-    base_size_h3b * base_size_h2b * base_size_h1b * base_size_p6b * base_size_p5b * base_size_p4b;
+//
+//  evaluates the s1/d1/d2 terms of a staged task and accumulates its [T] and (T) energies. the
+//  blocks were staged in the compute type F of the workspace and arena, which the GEMMs and t3
+//  use as well; the sums are in double.
+//
+template<typename T, typename F>
+void ccsd_t_compute_cpu_task(const Index noab, const Index nvab, std::vector<size_t>& k_range,
+                             std::vector<size_t>& k_offset, std::vector<T>& k_evl_sorted,
+                             const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<F>& bufs,
+                             size_t max_d1_kernels_pertask, size_t max_d2_kernels_pertask,
+                             //
+                             size_t size_T_s1_t1, size_t size_T_s1_v2, size_t size_T_d1_t2,
+                             size_t size_T_d1_v2, size_t size_T_d2_t2, size_t size_T_d2_v2,
+                             //
+                             std::vector<double>& energy_l, ccsd_t_cpu_workspace<F>& cpu_ws,
+                             ccsd_t_cpu_t3_arena<F>& t3_arena) {
+  const size_t t_h1b  = task.t_h1b, t_h2b = task.t_h2b, t_h3b = task.t_h3b;
+  const size_t t_p4b  = task.t_p4b, t_p5b = task.t_p5b, t_p6b = task.t_p6b;
+  const double factor = task.factor;
 
-  //
-  double* host_t3_d = (double*) malloc(sizeof(double) * size_tensor_t3);
-  double* host_t3_s = (double*) malloc(sizeof(double) * size_tensor_t3);
+  size_t base_size_h1b = k_range[t_h1b];
+  size_t base_size_h2b = k_range[t_h2b];
+  size_t base_size_h3b = k_range[t_h3b];
+  size_t base_size_p4b = k_range[t_p4b];
+  size_t base_size_p5b = k_range[t_p5b];
+  size_t base_size_p6b = k_range[t_p6b];
 
-  for(size_t i = 0; i < size_tensor_t3; i++) {
-    host_t3_d[i] = 0.000;
-    host_t3_s[i] = 0.000;
-  }
+  const size_t max_dim_s1_t1 = size_T_s1_t1 / 9;
+  const size_t max_dim_s1_v2 = size_T_s1_v2 / 9;
+  const size_t max_dim_d1_t2 = size_T_d1_t2 / max_d1_kernels_pertask;
+  const size_t max_dim_d1_v2 = size_T_d1_v2 / max_d1_kernels_pertask;
+  const size_t max_dim_d2_t2 = size_T_d2_t2 / max_d2_kernels_pertask;
+  const size_t max_dim_d2_v2 = size_T_d2_v2 / max_d2_kernels_pertask;
 
+  F*   df_host_pinned_s1_t1 = bufs.df_host_pinned_s1_t1;
+  F*   df_host_pinned_s1_v2 = bufs.df_host_pinned_s1_v2;
+  F*   df_host_pinned_d1_t2 = bufs.df_host_pinned_d1_t2;
+  F*   df_host_pinned_d1_v2 = bufs.df_host_pinned_d1_v2;
+  F*   df_host_pinned_d2_t2 = bufs.df_host_pinned_d2_t2;
+  F*   df_host_pinned_d2_v2 = bufs.df_host_pinned_d2_v2;
+  int* df_simple_d1_size    = bufs.df_simple_d1_size;
+  int* df_simple_d2_size    = bufs.df_simple_d2_size;
+  int* df_simple_s1_exec    = bufs.df_simple_s1_exec;
+  int* df_simple_d1_exec    = bufs.df_simple_d1_exec;
+  int* df_simple_d2_exec    = bufs.df_simple_d2_exec;
+
+  // tile energies in t3 index order (h3 fastest)
+  const double* host_evl_sorted[6] = {
+    &k_evl_sorted[k_offset[t_h3b]], &k_evl_sorted[k_offset[t_h2b]], &k_evl_sorted[k_offset[t_h1b]],
+    &k_evl_sorted[k_offset[t_p6b]], &k_evl_sorted[k_offset[t_p5b]], &k_evl_sorted[k_offset[t_p4b]]};
+
+  //
+  //  the enabled variants are resolved once per task; each one is a small GEMM over h7 (d1) or
+  //  p7 (d2), evaluated by the register-blocked kernels. the s1 rank-1 updates are folded into
+  //  the energy pass, which reads every t3d element exactly once. the whole task then runs in
+  //  one parallel region (ccsd_t_cpu_run_task).
   //
-  // for (size_t idx_ia6 = 0; idx_ia6 < 9; idx_ia6++){
+  int ext_t3[7] = {(int) base_size_h3b, (int) base_size_h2b, (int) base_size_h1b,
+                   (int) base_size_p6b, (int) base_size_p5b, (int) base_size_p4b, 0};
+
   // d1
   for(size_t idx_noab = 0; idx_noab < noab; idx_noab++) {
-    int flag_d1_1 = (int) df_simple_d1_exec[0 + (idx_noab) *9];
-    int flag_d1_2 = (int) df_simple_d1_exec[1 + (idx_noab) *9];
-    int flag_d1_3 = (int) df_simple_d1_exec[2 + (idx_noab) *9];
-    int flag_d1_4 = (int) df_simple_d1_exec[3 + (idx_noab) *9];
-    int flag_d1_5 = (int) df_simple_d1_exec[4 + (idx_noab) *9];
-    int flag_d1_6 = (int) df_simple_d1_exec[5 + (idx_noab) *9];
-    int flag_d1_7 = (int) df_simple_d1_exec[6 + (idx_noab) *9];
-    int flag_d1_8 = (int) df_simple_d1_exec[7 + (idx_noab) *9];
-    int flag_d1_9 = (int) df_simple_d1_exec[8 + (idx_noab) *9];
-
-    int d1_base_size_h1b = (int) df_simple_d1_size[0 + (idx_noab) *7];
-    int d1_base_size_h2b = (int) df_simple_d1_size[1 + (idx_noab) *7];
-    int d1_base_size_h3b = (int) df_simple_d1_size[2 + (idx_noab) *7];
-    int d1_base_size_h7b = (int) df_simple_d1_size[3 + (idx_noab) *7];
-    int d1_base_size_p4b = (int) df_simple_d1_size[4 + (idx_noab) *7];
-    int d1_base_size_p5b = (int) df_simple_d1_size[5 + (idx_noab) *7];
-    int d1_base_size_p6b = (int) df_simple_d1_size[6 + (idx_noab) *7];
-
-    double* host_d1_t2_1 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_1;
-    double* host_d1_v2_1 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_1;
-    double* host_d1_t2_2 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_2;
-    double* host_d1_v2_2 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_2;
-    double* host_d1_t2_3 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_3;
-    double* host_d1_v2_3 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_3;
-    double* host_d1_t2_4 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_4;
-    double* host_d1_v2_4 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_4;
-    double* host_d1_t2_5 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_5;
-    double* host_d1_v2_5 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_5;
-    double* host_d1_t2_6 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_6;
-    double* host_d1_v2_6 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_6;
-    double* host_d1_t2_7 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_7;
-    double* host_d1_v2_7 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_7;
-    double* host_d1_t2_8 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_8;
-    double* host_d1_v2_8 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_8;
-    double* host_d1_t2_9 = df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1_9;
-    double* host_d1_v2_9 = df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1_9;
-
-#pragma omp parallel for collapse(6)
-    for(int t3_h3 = 0; t3_h3 < d1_base_size_h3b; t3_h3++)
-      for(int t3_h2 = 0; t3_h2 < d1_base_size_h2b; t3_h2++)
-        for(int t3_h1 = 0; t3_h1 < d1_base_size_h1b; t3_h1++)
-          for(int t3_p6 = 0; t3_p6 < d1_base_size_p6b; t3_p6++)
-            for(int t3_p5 = 0; t3_p5 < d1_base_size_p5b; t3_p5++)
-              for(int t3_p4 = 0; t3_p4 < d1_base_size_p4b; t3_p4++) {
-                int t3_idx =
-                  t3_h3 + (t3_h2 + (t3_h1 + (t3_p6 + (t3_p5 + (t3_p4) *d1_base_size_p5b) *
-                                                       d1_base_size_p6b) *
-                                              d1_base_size_h1b) *
-                                     d1_base_size_h2b) *
-                            d1_base_size_h3b;
-
-                for(int t3_h7 = 0; t3_h7 < d1_base_size_h7b; t3_h7++) {
-                  // sd1_1:  t3[h3,h2,h1,p6,p5,p4] -= t2[h7,p4,p5,h1] * v2[h3,h2,p6,h7]
-                  if(flag_d1_1 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d1_t2_1[t3_h7 + (t3_p4 + (t3_p5 + (t3_h1) *d1_base_size_p5b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_1[t3_h3 + (t3_h2 + (t3_p6 + (t3_h7) *d1_base_size_p6b) *
-                                                      d1_base_size_h2b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_2:  t3[h3,h2,h1,p6,p5,p4] += t2[h7,p4,p5,h2] * v2[h3,h1,p6,h7]
-                  if(flag_d1_2 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d1_t2_2[t3_h7 + (t3_p4 + (t3_p5 + (t3_h2) *d1_base_size_p5b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_2[t3_h3 + (t3_h1 + (t3_p6 + (t3_h7) *d1_base_size_p6b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_3:  t3[h3,h2,h1,p6,p5,p4] -= t2[h7,p4,p5,h3] * v2[h2,h1,p6,h7]
-                  if(flag_d1_3 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d1_t2_3[t3_h7 + (t3_p4 + (t3_p5 + (t3_h3) *d1_base_size_p5b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_3[t3_h2 + (t3_h1 + (t3_p6 + (t3_h7) *d1_base_size_p6b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h2b];
-                  }
-
-                  // sd1_4:  t3[h3,h2,h1,p6,p5,p4] -= t2[h7,p5,p6,h1] * v2[h3,h2,p4,h7]
-                  if(flag_d1_4 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d1_t2_4[t3_h7 + (t3_p5 + (t3_p6 + (t3_h1) *d1_base_size_p6b) *
-                                                      d1_base_size_p5b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_4[t3_h3 + (t3_h2 + (t3_p4 + (t3_h7) *d1_base_size_p4b) *
-                                                      d1_base_size_h2b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_5:  t3[h3,h2,h1,p6,p5,p4] += t2[h7,p5,p6,h2] * v2[h3,h1,p4,h7]
-                  if(flag_d1_5 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d1_t2_5[t3_h7 + (t3_p5 + (t3_p6 + (t3_h2) *d1_base_size_p6b) *
-                                                      d1_base_size_p5b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_5[t3_h3 + (t3_h1 + (t3_p4 + (t3_h7) *d1_base_size_p4b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_6:  t3[h3,h2,h1,p6,p5,p4] -= t2[h7,p5,p6,h3] * v2[h2,h1,p4,h7]
-                  if(flag_d1_6 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d1_t2_6[t3_h7 + (t3_p5 + (t3_p6 + (t3_h3) *d1_base_size_p6b) *
-                                                      d1_base_size_p5b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_6[t3_h2 + (t3_h1 + (t3_p4 + (t3_h7) *d1_base_size_p4b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h2b];
-                  }
-
-                  // sd1_7:  t3[h3,h2,h1,p6,p5,p4] += t2[h7,p4,p6,h1] * v2[h3,h2,p5,h7]
-                  if(flag_d1_7 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d1_t2_7[t3_h7 + (t3_p4 + (t3_p6 + (t3_h1) *d1_base_size_p6b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_7[t3_h3 + (t3_h2 + (t3_p5 + (t3_h7) *d1_base_size_p5b) *
-                                                      d1_base_size_h2b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_8:  t3[h3,h2,h1,p6,p5,p4] -= t2[h7,p4,p6,h2] * v2[h3,h1,p5,h7]
-                  if(flag_d1_8 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d1_t2_8[t3_h7 + (t3_p4 + (t3_p6 + (t3_h2) *d1_base_size_p6b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_8[t3_h3 + (t3_h1 + (t3_p5 + (t3_h7) *d1_base_size_p5b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h3b];
-                  }
-
-                  // sd1_9:  t3[h3,h2,h1,p6,p5,p4] += t2[h7,p4,p6,h3] * v2[h2,h1,p5,h7]
-                  if(flag_d1_9 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d1_t2_9[t3_h7 + (t3_p4 + (t3_p6 + (t3_h3) *d1_base_size_p6b) *
-                                                      d1_base_size_p4b) *
-                                             d1_base_size_h7b] *
-                      host_d1_v2_9[t3_h2 + (t3_h1 + (t3_p5 + (t3_h7) *d1_base_size_p5b) *
-                                                      d1_base_size_h1b) *
-                                             d1_base_size_h2b];
-                  }
-                }
-              }
+    ext_t3[T3_K] = df_simple_d1_size[3 + (idx_noab) *7];
+    for(int idx_eq = 0; idx_eq < 9; idx_eq++) {
+      const int flag_d1 = df_simple_d1_exec[idx_eq + (idx_noab) *9];
+      if(flag_d1 < 0) continue;
+      ccsd_t_cpu_plan_term(ccsd_t_cpu_make_term(ccsd_t_cpu_d1_layout[idx_eq],
+                                                df_host_pinned_d1_t2 + max_dim_d1_t2 * flag_d1,
+                                                df_host_pinned_d1_v2 + max_dim_d1_v2 * flag_d1),
+                           ext_t3, cpu_ws);
+    }
   }
 
   // d2
   for(size_t idx_nvab = 0; idx_nvab < nvab; idx_nvab++) {
-    int flag_d2_1 = (int) df_simple_d2_exec[0 + (idx_nvab) *9];
-    int flag_d2_2 = (int) df_simple_d2_exec[1 + (idx_nvab) *9];
-    int flag_d2_3 = (int) df_simple_d2_exec[2 + (idx_nvab) *9];
-    int flag_d2_4 = (int) df_simple_d2_exec[3 + (idx_nvab) *9];
-    int flag_d2_5 = (int) df_simple_d2_exec[4 + (idx_nvab) *9];
-    int flag_d2_6 = (int) df_simple_d2_exec[5 + (idx_nvab) *9];
-    int flag_d2_7 = (int) df_simple_d2_exec[6 + (idx_nvab) *9];
-    int flag_d2_8 = (int) df_simple_d2_exec[7 + (idx_nvab) *9];
-    int flag_d2_9 = (int) df_simple_d2_exec[8 + (idx_nvab) *9];
-
-    int d2_base_size_h1b = (int) df_simple_d2_size[0 + (idx_nvab) *7];
-    int d2_base_size_h2b = (int) df_simple_d2_size[1 + (idx_nvab) *7];
-    int d2_base_size_h3b = (int) df_simple_d2_size[2 + (idx_nvab) *7];
-    int d2_base_size_p4b = (int) df_simple_d2_size[3 + (idx_nvab) *7];
-    int d2_base_size_p5b = (int) df_simple_d2_size[4 + (idx_nvab) *7];
-    int d2_base_size_p6b = (int) df_simple_d2_size[5 + (idx_nvab) *7];
-    int d2_base_size_p7b = (int) df_simple_d2_size[6 + (idx_nvab) *7];
-
-    double* host_d2_t2_1 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_1;
-    double* host_d2_v2_1 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_1;
-    double* host_d2_t2_2 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_2;
-    double* host_d2_v2_2 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_2;
-    double* host_d2_t2_3 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_3;
-    double* host_d2_v2_3 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_3;
-    double* host_d2_t2_4 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_4;
-    double* host_d2_v2_4 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_4;
-    double* host_d2_t2_5 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_5;
-    double* host_d2_v2_5 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_5;
-    double* host_d2_t2_6 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_6;
-    double* host_d2_v2_6 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_6;
-    double* host_d2_t2_7 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_7;
-    double* host_d2_v2_7 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_7;
-    double* host_d2_t2_8 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_8;
-    double* host_d2_v2_8 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_8;
-    double* host_d2_t2_9 = df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2_9;
-    double* host_d2_v2_9 = df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2_9;
-
-#pragma omp parallel for collapse(6)
-    for(int t3_h3 = 0; t3_h3 < d2_base_size_h3b; t3_h3++)
-      for(int t3_h2 = 0; t3_h2 < d2_base_size_h2b; t3_h2++)
-        for(int t3_h1 = 0; t3_h1 < d2_base_size_h1b; t3_h1++)
-          for(int t3_p6 = 0; t3_p6 < d2_base_size_p6b; t3_p6++)
-            for(int t3_p5 = 0; t3_p5 < d2_base_size_p5b; t3_p5++)
-              for(int t3_p4 = 0; t3_p4 < d2_base_size_p4b; t3_p4++) {
-                int t3_idx =
-                  t3_h3 + (t3_h2 + (t3_h1 + (t3_p6 + (t3_p5 + (t3_p4) *d2_base_size_p5b) *
-                                                       d2_base_size_p6b) *
-                                              d2_base_size_h1b) *
-                                     d2_base_size_h2b) *
-                            d2_base_size_h3b;
-
-                for(int t3_p7 = 0; t3_p7 < d2_base_size_p7b; t3_p7++) {
-                  // sd2_1:  t3[h3,h2,h1,p6,p5,p4] −= t2[p7,p4,h1,h2] * v2[p7,h3,p6,p5]
-                  if(flag_d2_1 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d2_t2_1[t3_p7 + (t3_p4 + (t3_h1 + (t3_h2) *d2_base_size_h1b) *
-                                                      d2_base_size_p4b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_1[t3_p7 + (t3_h3 + (t3_p6 + (t3_p5) *d2_base_size_p6b) *
-                                                      d2_base_size_h3b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_2:  t3[h3,h2,h1,p6,p5,p4] −= t2[p7,p4,h2,h3] * v2[p7,h1,p6,p5]
-                  if(flag_d2_2 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d2_t2_2[t3_p7 + (t3_p4 + (t3_h2 + (t3_h3) *d2_base_size_h2b) *
-                                                      d2_base_size_p4b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_2[t3_p7 + (t3_h1 + (t3_p6 + (t3_p5) *d2_base_size_p6b) *
-                                                      d2_base_size_h1b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_3:  t3[h3,h2,h1,p6,p5,p4] += t2[p7,p4,h1,h3] * v2[p7,h2,p6,p5]
-                  if(flag_d2_3 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d2_t2_3[t3_p7 + (t3_p4 + (t3_h1 + (t3_h3) *d2_base_size_h1b) *
-                                                      d2_base_size_p4b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_3[t3_p7 + (t3_h2 + (t3_p6 + (t3_p5) *d2_base_size_p6b) *
-                                                      d2_base_size_h2b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_4:  t3[h3,h2,h1,p6,p5,p4] += t2[p7,p5,h1,h2] * v2[p7,h3,p6,p4]
-                  if(flag_d2_4 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d2_t2_4[t3_p7 + (t3_p5 + (t3_h1 + (t3_h2) *d2_base_size_h1b) *
-                                                      d2_base_size_p5b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_4[t3_p7 + (t3_h3 + (t3_p6 + (t3_p4) *d2_base_size_p6b) *
-                                                      d2_base_size_h3b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_5:  t3[h3,h2,h1,p6,p5,p4] += t2[p7,p5,h2,h3] * v2[p7,h1,p6,p4]
-                  if(flag_d2_5 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d2_t2_5[t3_p7 + (t3_p5 + (t3_h2 + (t3_h3) *d2_base_size_h2b) *
-                                                      d2_base_size_p5b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_5[t3_p7 + (t3_h1 + (t3_p6 + (t3_p4) *d2_base_size_p6b) *
-                                                      d2_base_size_h1b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_6:  t3[h3,h2,h1,p6,p5,p4] −= t2[p7,p5,h1,h3] * v2[p7,h2,p6,p4]
-                  if(flag_d2_6 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d2_t2_6[t3_p7 + (t3_p5 + (t3_h1 + (t3_h3) *d2_base_size_h1b) *
-                                                      d2_base_size_p5b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_6[t3_p7 + (t3_h2 + (t3_p6 + (t3_p4) *d2_base_size_p6b) *
-                                                      d2_base_size_h2b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_7:  t3[h3,h2,h1,p6,p5,p4] −= t2[p7,p6,h1,h2] * v2[p7,h3,p5,p4]
-                  if(flag_d2_7 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d2_t2_7[t3_p7 + (t3_p6 + (t3_h1 + (t3_h2) *d2_base_size_h1b) *
-                                                      d2_base_size_p6b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_7[t3_p7 + (t3_h3 + (t3_p5 + (t3_p4) *d2_base_size_p5b) *
-                                                      d2_base_size_h3b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_8:  t3[h3,h2,h1,p6,p5,p4] −= t2[p7,p6,h2,h3] * v2[p7,h1,p5,p4]
-                  if(flag_d2_8 >= 0) {
-                    host_t3_d[t3_idx] -=
-                      host_d2_t2_8[t3_p7 + (t3_p6 + (t3_h2 + (t3_h3) *d2_base_size_h2b) *
-                                                      d2_base_size_p6b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_8[t3_p7 + (t3_h1 + (t3_p5 + (t3_p4) *d2_base_size_p5b) *
-                                                      d2_base_size_h1b) *
-                                             d2_base_size_p7b];
-                  }
-
-                  // sd2_9:  t3[h3,h2,h1,p6,p5,p4] += t2[p7,p6,h1,h3] * v2[p7,h2,p5,p4]
-                  if(flag_d2_9 >= 0) {
-                    host_t3_d[t3_idx] +=
-                      host_d2_t2_9[t3_p7 + (t3_p6 + (t3_h1 + (t3_h3) *d2_base_size_h1b) *
-                                                      d2_base_size_p6b) *
-                                             d2_base_size_p7b] *
-                      host_d2_v2_9[t3_p7 + (t3_h2 + (t3_p5 + (t3_p4) *d2_base_size_p5b) *
-                                                      d2_base_size_h2b) *
-                                             d2_base_size_p7b];
-                  }
-                }
-              }
+    ext_t3[T3_K] = df_simple_d2_size[6 + (idx_nvab) *7];
+    for(int idx_eq = 0; idx_eq < 9; idx_eq++) {
+      const int flag_d2 = df_simple_d2_exec[idx_eq + (idx_nvab) *9];
+      if(flag_d2 < 0) continue;
+      ccsd_t_cpu_plan_term(ccsd_t_cpu_make_term(ccsd_t_cpu_d2_layout[idx_eq],
+                                                df_host_pinned_d2_t2 + max_dim_d2_t2 * flag_d2,
+                                                df_host_pinned_d2_v2 + max_dim_d2_v2 * flag_d2),
+                           ext_t3, cpu_ws);
+    }
+  }
+
+  // s1 and the energies E(4), E(5)
+  ccsd_t_cpu_term<F> s1_terms[9];
+  int                num_s1_terms = 0;
+  for(int idx_eq = 0; idx_eq < 9; idx_eq++) {
+    const int flag_s1 = df_simple_s1_exec[idx_eq];
+    if(flag_s1 < 0) continue;
+    s1_terms[num_s1_terms++] = ccsd_t_cpu_make_term(
+      ccsd_t_cpu_s1_layout[idx_eq], df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1,
+      df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1);
   }
+  ccsd_t_cpu_run_task(cpu_ws, t3_arena, ext_t3, s1_terms, num_s1_terms, host_evl_sorted, factor,
+                      energy_l[0], energy_l[1]);
 
-  // s1
-  {
-    // 	flags
-    int flag_s1_1 = (int) df_simple_s1_exec[0];
-    int flag_s1_2 = (int) df_simple_s1_exec[1];
-    int flag_s1_3 = (int) df_simple_s1_exec[2];
-    int flag_s1_4 = (int) df_simple_s1_exec[3];
-    int flag_s1_5 = (int) df_simple_s1_exec[4];
-    int flag_s1_6 = (int) df_simple_s1_exec[5];
-    int flag_s1_7 = (int) df_simple_s1_exec[6];
-    int flag_s1_8 = (int) df_simple_s1_exec[7];
-    int flag_s1_9 = (int) df_simple_s1_exec[8];
-
-    int s1_base_size_h1b = (int) df_simple_s1_size[0];
-    int s1_base_size_h2b = (int) df_simple_s1_size[1];
-    int s1_base_size_h3b = (int) df_simple_s1_size[2];
-    int s1_base_size_p4b = (int) df_simple_s1_size[3];
-    int s1_base_size_p5b = (int) df_simple_s1_size[4];
-    int s1_base_size_p6b = (int) df_simple_s1_size[5];
-
-    double* host_s1_t2;
-    double* host_s1_v2;
+  // printf ("E(4): %.14f, E(5): %.14f\n", host_energy_4, host_energy_5);
+  //  printf
+  //  ("========================================================================================\n");
+}
 
 //
-#pragma omp parallel for collapse(6)
-    for(int t3_h3 = 0; t3_h3 < s1_base_size_h3b; t3_h3++)
-      for(int t3_h2 = 0; t3_h2 < s1_base_size_h2b; t3_h2++)
-        for(int t3_h1 = 0; t3_h1 < s1_base_size_h1b; t3_h1++)
-          for(int t3_p6 = 0; t3_p6 < s1_base_size_p6b; t3_p6++)
-            for(int t3_p5 = 0; t3_p5 < s1_base_size_p5b; t3_p5++)
-              for(int t3_p4 = 0; t3_p4 < s1_base_size_p4b; t3_p4++) {
-                int t3_idx =
-                  t3_h3 + (t3_h2 + (t3_h1 + (t3_p6 + (t3_p5 + (t3_p4) *s1_base_size_p5b) *
-                                                       s1_base_size_p6b) *
-                                              s1_base_size_h1b) *
-                                     s1_base_size_h2b) *
-                            s1_base_size_h3b;
-
-                //  s1_1: t3[h3,h2,h1,p6,p5,p4] += t1[p4,h1] * v2[h3,h2,p6,p5]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_1;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_1;
-
-                if(flag_s1_1 >= 0) {
-                  host_t3_s[t3_idx] +=
-                    host_s1_t2[t3_p4 + (t3_h1) *s1_base_size_p4b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h2 + (t3_p6 + (t3_p5) *s1_base_size_p6b) * s1_base_size_h2b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_2: t3[h3,h2,h1,p6,p5,p4] -= t1[p4,h2] * v2[h3,h1,p6,p5]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_2;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_2;
-
-                if(flag_s1_2 >= 0) {
-                  host_t3_s[t3_idx] -=
-                    host_s1_t2[t3_p4 + (t3_h2) *s1_base_size_p4b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h1 + (t3_p6 + (t3_p5) *s1_base_size_p6b) * s1_base_size_h1b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_3: t3[h3,h2,h1,p6,p5,p4] += t1[p4,h3] * v2[h2,h1,p6,p5]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_3;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_3;
-
-                if(flag_s1_3 >= 0) {
-                  host_t3_s[t3_idx] +=
-                    host_s1_t2[t3_p4 + (t3_h3) *s1_base_size_p4b] *
-                    host_s1_v2[t3_h2 +
-                               (t3_h1 + (t3_p6 + (t3_p5) *s1_base_size_p6b) * s1_base_size_h1b) *
-                                 s1_base_size_h2b];
-                }
-
-                // s1_4:   t3[h3,h2,h1,p6,p5,p4] -= t1[p5,h1] * v2[h3,h2,p6,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_4;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_4;
-
-                if(flag_s1_4 >= 0) {
-                  host_t3_s[t3_idx] -=
-                    host_s1_t2[t3_p5 + (t3_h1) *s1_base_size_p5b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h2 + (t3_p6 + (t3_p4) *s1_base_size_p6b) * s1_base_size_h2b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_5:   t3[h3,h2,h1,p6,p5,p4] += t1[p5,h2] * v2[h3,h1,p6,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_5;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_5;
-
-                if(flag_s1_5 >= 0) {
-                  host_t3_s[t3_idx] +=
-                    host_s1_t2[t3_p5 + (t3_h2) *s1_base_size_p5b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h1 + (t3_p6 + (t3_p4) *s1_base_size_p6b) * s1_base_size_h1b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_6:   t3[h3,h2,h1,p6,p5,p4] -= t1[p5,h3] * v2[h2,h1,p6,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_6;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_6;
-
-                if(flag_s1_6 >= 0) {
-                  host_t3_s[t3_idx] -=
-                    host_s1_t2[t3_p5 + (t3_h3) *s1_base_size_p5b] *
-                    host_s1_v2[t3_h2 +
-                               (t3_h1 + (t3_p6 + (t3_p4) *s1_base_size_p6b) * s1_base_size_h1b) *
-                                 s1_base_size_h2b];
-                }
-
-                // s1_7:   t3[h3,h2,h1,p6,p5,p4] -= t1[p6,h1] * v2[h3,h2,p5,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_7;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_7;
-
-                if(flag_s1_7 >= 0) {
-                  host_t3_s[t3_idx] +=
-                    host_s1_t2[t3_p6 + (t3_h1) *s1_base_size_p6b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h2 + (t3_p5 + (t3_p4) *s1_base_size_p5b) * s1_base_size_h2b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_8:   t3[h3,h2,h1,p6,p5,p4] -= t1[p6,h2] * v2[h3,h1,p5,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_8;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_8;
-
-                if(flag_s1_8 >= 0) {
-                  host_t3_s[t3_idx] -=
-                    host_s1_t2[t3_p6 + (t3_h2) *s1_base_size_p6b] *
-                    host_s1_v2[t3_h3 +
-                               (t3_h1 + (t3_p5 + (t3_p4) *s1_base_size_p5b) * s1_base_size_h1b) *
-                                 s1_base_size_h3b];
-                }
-
-                // s1_9:   t3[h3,h2,h1,p6,p5,p4] -= t1[p6,h3] * v2[h2,h1,p5,p4]
-                host_s1_t2 = df_host_pinned_s1_t1 + max_dim_s1_t1 * flag_s1_9;
-                host_s1_v2 = df_host_pinned_s1_v2 + max_dim_s1_v2 * flag_s1_9;
-
-                if(flag_s1_9 >= 0) {
-                  host_t3_s[t3_idx] +=
-                    host_s1_t2[t3_p6 + (t3_h3) *s1_base_size_p6b] *
-                    host_s1_v2[t3_h2 +
-                               (t3_h1 + (t3_p5 + (t3_p4) *s1_base_size_p5b) * s1_base_size_h1b) *
-                                 s1_base_size_h2b];
-                }
-              }
+//  runs the CPU (T) tasks of a rank. with prefetch enabled, the blocks of task i+1 are fetched
+//  into the second buffer set by a staging thread, started once, while task i is computed from
+//  the first one; otherwise every task is fetched and computed in place. the staging thread's
+//  gets and the main thread's counter updates are serialized by ccsd_t_ga_call. data_time is
+//  the time spent staging, wait_time the part of it the compute thread had to wait for (not
+//  overlapped).
+//
+template<typename T>
+class ccsd_t_cpu_prefetcher {
+public:
+  using task_fn = std::function<void(const ccsd_t_cpu_task&, ccsd_t_cpu_buffers<T>&)>;
+
+  ccsd_t_cpu_prefetcher(ccsd_t_cpu_buffers<T> bufs0, ccsd_t_cpu_buffers<T> bufs1, task_fn data_fn,
+                        task_fn compute_fn, bool prefetch):
+    bufs_{bufs0, bufs1}, data_fn_(data_fn), compute_fn_(compute_fn), prefetch_(prefetch) {
+    if(prefetch_) stager_ = std::thread([this]() { stage_loop(); });
   }
-  //} //idx_ia6
 
-  //
-  //  to calculate energies--- E(4) and E(5)
-  //
-  double final_energy_1 = 0.0;
-  double final_energy_2 = 0.0;
+  ~ccsd_t_cpu_prefetcher() {
+    if(!stager_.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    stager_.join();
+  }
 
-  int size_idx_h1 = (int) base_size_h1b;
-  int size_idx_h2 = (int) base_size_h2b;
-  int size_idx_h3 = (int) base_size_h3b;
-  int size_idx_p4 = (int) base_size_p4b;
-  int size_idx_p5 = (int) base_size_p5b;
-  int size_idx_p6 = (int) base_size_p6b;
+  void run(const ccsd_t_cpu_task& task) {
+    if(!prefetch_) {
+      auto t0 = std::chrono::high_resolution_clock::now();
+      data_fn_(task, bufs_[0]);
+      const double dt = elapsed(t0);
+      data_time += dt;
+      wait_time += dt;
+      compute_fn_(task, bufs_[0]);
+      return;
+    }
+
+    if(!has_pending_) {
+      launch(task, 0);
+      pending_     = task;
+      slot_        = 0;
+      has_pending_ = true;
+      return;
+    }
+
+    // the pending task's blocks are ready in slot_; stage the new one into the other set
+    wait();
+    launch(task, slot_ ^ 1);
+    compute_fn_(pending_, bufs_[slot_]);
+    pending_ = task;
+    slot_ ^= 1;
+  }
 
-  //
-  for(int idx_p4 = 0; idx_p4 < size_idx_p4; idx_p4++)
-    for(int idx_p5 = 0; idx_p5 < size_idx_p5; idx_p5++)
-      for(int idx_p6 = 0; idx_p6 < size_idx_p6; idx_p6++)
-        for(int idx_h1 = 0; idx_h1 < size_idx_h1; idx_h1++)
-          for(int idx_h2 = 0; idx_h2 < size_idx_h2; idx_h2++)
-            for(int idx_h3 = 0; idx_h3 < size_idx_h3; idx_h3++) {
-              //
-              int idx_t3 =
-                idx_h3 +
-                (idx_h2 + (idx_h1 + (idx_p6 + (idx_p5 + (idx_p4) *size_idx_p5) * size_idx_p6) *
-                                      size_idx_h1) *
-                            size_idx_h2) *
-                  size_idx_h3;
-
-              //
-              double inner_factor = (host_evl_sorted_h3b[idx_h3] + host_evl_sorted_h2b[idx_h2] +
-                                     host_evl_sorted_h1b[idx_h1] - host_evl_sorted_p6b[idx_p6] -
-                                     host_evl_sorted_p5b[idx_p5] - host_evl_sorted_p4b[idx_p4]);
-              //
-              final_energy_1 += factor * host_t3_d[idx_t3] * (host_t3_d[idx_t3]) / inner_factor;
-              final_energy_2 +=
-                factor * host_t3_d[idx_t3] * (host_t3_d[idx_t3] + host_t3_s[idx_t3]) / inner_factor;
-            }
-
-  energy_l[0] += final_energy_1;
-
-  energy_l[1] += final_energy_2;
+  // computes the last staged task
+  void flush() {
+    if(!has_pending_) return;
+    wait();
+    compute_fn_(pending_, bufs_[slot_]);
+    has_pending_ = false;
+  }
 
-  // printf ("E(4): %.14f, E(5): %.14f\n", host_energy_4, host_energy_5);
-  //  printf
-  //  ("========================================================================================\n");
-}
+  double data_time = 0;
+  double wait_time = 0;
+
+private:
+  static double elapsed(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(
+             (std::chrono::high_resolution_clock::now() - t0))
+      .count();
+  }
+
+  // hands the task to the staging thread
+  void launch(const ccsd_t_cpu_task& task, int slot) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_      = task;
+      job_slot_ = slot;
+      has_job_  = true;
+      job_done_ = false;
+    }
+    cv_.notify_all();
+  }
+
+  // waits for the staging thread to finish the task handed to it
+  void wait() {
+    auto                         t0 = std::chrono::high_resolution_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return job_done_; });
+    data_time += job_time_;
+    wait_time += elapsed(t0);
+    if(job_error_) std::rethrow_exception(std::exchange(job_error_, nullptr));
+  }
+
+  void stage_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true) {
+      cv_.wait(lock, [this]() { return stop_ || has_job_; });
+      if(!has_job_) return;
+      const ccsd_t_cpu_task task = job_;
+      const int             slot = job_slot_;
+      has_job_                   = false;
+      lock.unlock();
+
+      auto               t0 = std::chrono::high_resolution_clock::now();
+      std::exception_ptr error;
+      try {
+        data_fn_(task, bufs_[slot]);
+      } catch(...) { error = std::current_exception(); }
+      const double dt = elapsed(t0);
+
+      lock.lock();
+      job_time_  = dt;
+      job_error_ = error;
+      job_done_  = true;
+      cv_.notify_all();
+    }
+  }
+
+  ccsd_t_cpu_buffers<T> bufs_[2];
+  task_fn               data_fn_;
+  task_fn               compute_fn_;
+  bool                  prefetch_;
+  bool                  has_pending_ = false;
+  int                   slot_        = 0;
+  ccsd_t_cpu_task       pending_;
+
+  // the staging thread and the task handed to it
+  std::thread             stager_;
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  ccsd_t_cpu_task         job_;
+  int                     job_slot_ = 0;
+  bool                    has_job_  = false;
+  bool                    job_done_ = false;
+  bool                    stop_     = false;
+  double                  job_time_ = 0;
+  std::exception_ptr      job_error_;
+};
@@ -0,0 +1,557 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+//
+//  register-blocked CPU kernels for the fully-fused (T) contractions.
+//
+//  every s1, d1 and d2 term has the form
+//      t3[h3,h2,h1,p6,p5,p4] += sign * sum_k A[..k..] * B[..k..]
+//  i.e., a small GEMM over the contracted index k (h7 for d1, p7 for d2, none for s1).
+//  the operand that carries h3 (unit stride in t3) is packed k-major with h3 padded to the SIMD
+//  width (m panel), the other operand is packed k-major with its sign-scaled columns padded to NR
+//  (n panel), and (MV x width) x NR register tiles are accumulated over k and added into t3.
+//
+//  the panels and t3 are of the compute type F: double, or float for the mixed-precision mode,
+//  where the staged FP64 blocks are rounded while packed and the energies are summed in double.
+//
+
+// t3 index ids in t3[h3,h2,h1,p6,p5,p4] storage order (fastest first), and the contracted index
+enum ccsd_t_cpu_idx { T3_H3 = 0, T3_H2, T3_H1, T3_P6, T3_P5, T3_P4, T3_K };
+
+template<typename F>
+struct ccsd_t_simd;
+
+#if defined(__AVX512F__)
+template<>
+struct ccsd_t_simd<double> {
+  using reg                         = __m512d;
+  static constexpr int         width = 8;
+  static constexpr int         nr    = 8;
+  static constexpr const char* name  = "AVX-512";
+
+  static inline reg  zero() { return _mm512_setzero_pd(); }
+  static inline reg  load(const double* p) { return _mm512_loadu_pd(p); }
+  static inline reg  bcast(const double* p) { return _mm512_set1_pd(*p); }
+  static inline reg  fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+  static inline void store(double* p, reg a) { _mm512_storeu_pd(p, a); }
+};
+template<>
+struct ccsd_t_simd<float> {
+  using reg                         = __m512;
+  static constexpr int         width = 16;
+  static constexpr int         nr    = 8;
+  static constexpr const char* name  = "AVX-512";
+
+  static inline reg  zero() { return _mm512_setzero_ps(); }
+  static inline reg  load(const float* p) { return _mm512_loadu_ps(p); }
+  static inline reg  bcast(const float* p) { return _mm512_set1_ps(*p); }
+  static inline reg  fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+  static inline void store(float* p, reg a) { _mm512_storeu_ps(p, a); }
+};
+#elif defined(__AVX2__) && defined(__FMA__)
+template<>
+struct ccsd_t_simd<double> {
+  using reg                         = __m256d;
+  static constexpr int         width = 4;
+  static constexpr int         nr    = 6;
+  static constexpr const char* name  = "AVX2";
+
+  static inline reg  zero() { return _mm256_setzero_pd(); }
+  static inline reg  load(const double* p) { return _mm256_loadu_pd(p); }
+  static inline reg  bcast(const double* p) { return _mm256_broadcast_sd(p); }
+  static inline reg  fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+  static inline void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+};
+template<>
+struct ccsd_t_simd<float> {
+  using reg                         = __m256;
+  static constexpr int         width = 8;
+  static constexpr int         nr    = 6;
+  static constexpr const char* name  = "AVX2";
+
+  static inline reg  zero() { return _mm256_setzero_ps(); }
+  static inline reg  load(const float* p) { return _mm256_loadu_ps(p); }
+  static inline reg  bcast(const float* p) { return _mm256_broadcast_ss(p); }
+  static inline reg  fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+  static inline void store(float* p, reg a) { _mm256_storeu_ps(p, a); }
+};
+#else
+template<typename F>
+struct ccsd_t_simd {
+  using reg                         = F;
+  static constexpr int         width = 1;
+  static constexpr int         nr    = 8;
+  static constexpr const char* name  = "scalar";
+
+  static inline reg  zero() { return 0; }
+  static inline reg  load(const F* p) { return *p; }
+  static inline reg  bcast(const F* p) { return *p; }
+  static inline reg  fmadd(reg a, reg b, reg c) { return a * b + c; }
+  static inline void store(F* p, reg a) { *p = a; }
+};
+#endif
+
+// an operand block as staged in df_host_pinned_* (in the compute type F): up to 4 indices,
+// fastest first
+template<typename F>
+struct ccsd_t_cpu_operand {
+  const F* ptr;
+  int      ndim;
+  int      idx[4];
+};
+
+template<typename F>
+struct ccsd_t_cpu_term {
+  ccsd_t_cpu_operand<F> a;
+  ccsd_t_cpu_operand<F> b;
+  double                sign;
+};
+
+// index layouts (fastest first) and signs of the t1/t2 (a) and v2 (b) operands for the 9 variants
+// of each equation, in the order used by df_simple_{s1,d1,d2}_exec.
+struct ccsd_t_cpu_layout {
+  int    ndim_a;
+  int    a[4];
+  int    b[4];
+  double sign;
+};
+
+// clang-format off
+static const ccsd_t_cpu_layout ccsd_t_cpu_s1_layout[9] = {
+  {2, {T3_P4, T3_H1}, {T3_H3, T3_H2, T3_P6, T3_P5}, +1.0}, // t1[p4,h1] * v2[h3,h2,p6,p5]
+  {2, {T3_P4, T3_H2}, {T3_H3, T3_H1, T3_P6, T3_P5}, -1.0}, // t1[p4,h2] * v2[h3,h1,p6,p5]
+  {2, {T3_P4, T3_H3}, {T3_H2, T3_H1, T3_P6, T3_P5}, +1.0}, // t1[p4,h3] * v2[h2,h1,p6,p5]
+  {2, {T3_P5, T3_H1}, {T3_H3, T3_H2, T3_P6, T3_P4}, -1.0}, // t1[p5,h1] * v2[h3,h2,p6,p4]
+  {2, {T3_P5, T3_H2}, {T3_H3, T3_H1, T3_P6, T3_P4}, +1.0}, // t1[p5,h2] * v2[h3,h1,p6,p4]
+  {2, {T3_P5, T3_H3}, {T3_H2, T3_H1, T3_P6, T3_P4}, -1.0}, // t1[p5,h3] * v2[h2,h1,p6,p4]
+  {2, {T3_P6, T3_H1}, {T3_H3, T3_H2, T3_P5, T3_P4}, +1.0}, // t1[p6,h1] * v2[h3,h2,p5,p4]
+  {2, {T3_P6, T3_H2}, {T3_H3, T3_H1, T3_P5, T3_P4}, -1.0}, // t1[p6,h2] * v2[h3,h1,p5,p4]
+  {2, {T3_P6, T3_H3}, {T3_H2, T3_H1, T3_P5, T3_P4}, +1.0}, // t1[p6,h3] * v2[h2,h1,p5,p4]
+};
+
+static const ccsd_t_cpu_layout ccsd_t_cpu_d1_layout[9] = {
+  {4, {T3_K, T3_P4, T3_P5, T3_H1}, {T3_H3, T3_H2, T3_P6, T3_K}, -1.0}, // t2[h7,p4,p5,h1] * v2[h3,h2,p6,h7]
+  {4, {T3_K, T3_P4, T3_P5, T3_H2}, {T3_H3, T3_H1, T3_P6, T3_K}, +1.0}, // t2[h7,p4,p5,h2] * v2[h3,h1,p6,h7]
+  {4, {T3_K, T3_P4, T3_P5, T3_H3}, {T3_H2, T3_H1, T3_P6, T3_K}, -1.0}, // t2[h7,p4,p5,h3] * v2[h2,h1,p6,h7]
+  {4, {T3_K, T3_P5, T3_P6, T3_H1}, {T3_H3, T3_H2, T3_P4, T3_K}, -1.0}, // t2[h7,p5,p6,h1] * v2[h3,h2,p4,h7]
+  {4, {T3_K, T3_P5, T3_P6, T3_H2}, {T3_H3, T3_H1, T3_P4, T3_K}, +1.0}, // t2[h7,p5,p6,h2] * v2[h3,h1,p4,h7]
+  {4, {T3_K, T3_P5, T3_P6, T3_H3}, {T3_H2, T3_H1, T3_P4, T3_K}, -1.0}, // t2[h7,p5,p6,h3] * v2[h2,h1,p4,h7]
+  {4, {T3_K, T3_P4, T3_P6, T3_H1}, {T3_H3, T3_H2, T3_P5, T3_K}, +1.0}, // t2[h7,p4,p6,h1] * v2[h3,h2,p5,h7]
+  {4, {T3_K, T3_P4, T3_P6, T3_H2}, {T3_H3, T3_H1, T3_P5, T3_K}, -1.0}, // t2[h7,p4,p6,h2] * v2[h3,h1,p5,h7]
+  {4, {T3_K, T3_P4, T3_P6, T3_H3}, {T3_H2, T3_H1, T3_P5, T3_K}, +1.0}, // t2[h7,p4,p6,h3] * v2[h2,h1,p5,h7]
+};
+
+static const ccsd_t_cpu_layout ccsd_t_cpu_d2_layout[9] = {
+  {4, {T3_K, T3_P4, T3_H1, T3_H2}, {T3_K, T3_H3, T3_P6, T3_P5}, -1.0}, // t2[p7,p4,h1,h2] * v2[p7,h3,p6,p5]
+  {4, {T3_K, T3_P4, T3_H2, T3_H3}, {T3_K, T3_H1, T3_P6, T3_P5}, -1.0}, // t2[p7,p4,h2,h3] * v2[p7,h1,p6,p5]
+  {4, {T3_K, T3_P4, T3_H1, T3_H3}, {T3_K, T3_H2, T3_P6, T3_P5}, +1.0}, // t2[p7,p4,h1,h3] * v2[p7,h2,p6,p5]
+  {4, {T3_K, T3_P5, T3_H1, T3_H2}, {T3_K, T3_H3, T3_P6, T3_P4}, +1.0}, // t2[p7,p5,h1,h2] * v2[p7,h3,p6,p4]
+  {4, {T3_K, T3_P5, T3_H2, T3_H3}, {T3_K, T3_H1, T3_P6, T3_P4}, +1.0}, // t2[p7,p5,h2,h3] * v2[p7,h1,p6,p4]
+  {4, {T3_K, T3_P5, T3_H1, T3_H3}, {T3_K, T3_H2, T3_P6, T3_P4}, -1.0}, // t2[p7,p5,h1,h3] * v2[p7,h2,p6,p4]
+  {4, {T3_K, T3_P6, T3_H1, T3_H2}, {T3_K, T3_H3, T3_P5, T3_P4}, -1.0}, // t2[p7,p6,h1,h2] * v2[p7,h3,p5,p4]
+  {4, {T3_K, T3_P6, T3_H2, T3_H3}, {T3_K, T3_H1, T3_P5, T3_P4}, -1.0}, // t2[p7,p6,h2,h3] * v2[p7,h1,p5,p4]
+  {4, {T3_K, T3_P6, T3_H1, T3_H3}, {T3_K, T3_H2, T3_P5, T3_P4}, +1.0}, // t2[p7,p6,h1,h3] * v2[p7,h2,p5,p4]
+};
+// clang-format on
+
+template<typename F>
+inline ccsd_t_cpu_term<F> ccsd_t_cpu_make_term(const ccsd_t_cpu_layout& layout, const F* a,
+                                               const F* b) {
+  ccsd_t_cpu_term<F> term;
+  term.a.ptr  = a;
+  term.a.ndim = layout.ndim_a;
+  term.b.ptr  = b;
+  term.b.ndim = 4;
+  for(int d = 0; d < 4; d++) {
+    term.a.idx[d] = layout.a[d];
+    term.b.idx[d] = layout.b[d];
+  }
+  term.sign = layout.sign;
+  return term;
+}
+
+//
+//  a d1/d2 term set up for the GEMM: which operand forms the m panel (the one carrying h3), the
+//  panel strides of every t3 index and the t3 offsets of the panel rows and columns.
+//
+template<typename F>
+struct ccsd_t_cpu_plan {
+  ccsd_t_cpu_operand<F> mop, nop;
+  double                m_scale, n_scale;
+  int                   ext[7];
+  int                   size_k, size_h3, nvec;
+  size_t                size_h3p, m_outer, size_n, ldm, ldn;
+  size_t                m_stride[7], n_stride[7];
+  std::vector<size_t>   off_m, off_n;
+};
+
+//
+//  plans of the terms of a task and two sets of packing panels. term i is packed into set i % 2,
+//  so packing the next term only has to wait for the GEMM of the term before the current one.
+//
+template<typename F>
+struct ccsd_t_cpu_workspace {
+  std::vector<ccsd_t_cpu_plan<F>> plans;
+  size_t                          num_plans = 0;
+  std::vector<F>                  pack_m[2];
+  std::vector<F>                  pack_n[2];
+};
+
+//
+//  long-lived t3d buffer (host_t3_d) reused across tasks; t3s is never stored.
+//  the buffer is page-aligned and sized for the largest tile. it is zeroed for every task with
+//  the static (p4,p5,p6) partition of the energy pass, and first touched with that partition for
+//  the largest tile, so for the full tiles that make up most tasks each (pinned) thread zeroes
+//  and reads back pages on its own socket. the GEMM tiles are handed out dynamically.
+//
+template<typename F>
+struct ccsd_t_cpu_t3_arena {
+  static constexpr size_t page_size = 4096;
+
+  F*     t3_d     = nullptr;
+  size_t capacity = 0;
+
+  ccsd_t_cpu_t3_arena(size_t max_hdim, size_t max_pdim) {
+    const int ext[7] = {(int) max_hdim, (int) max_hdim, (int) max_hdim, (int) max_pdim,
+                        (int) max_pdim, (int) max_pdim, 0};
+    size_t size = 1;
+    for(int i = T3_H3; i <= T3_P4; i++) size *= ext[i];
+    const size_t bytes =
+      ((sizeof(F) * std::max<size_t>(size, 1) + page_size - 1) / page_size) * page_size;
+    t3_d = static_cast<F*>(std::aligned_alloc(page_size, bytes));
+    if(t3_d == nullptr) throw std::bad_alloc();
+    capacity = bytes / sizeof(F);
+#pragma omp parallel
+    zero(ext); // first touch
+  }
+
+  ~ccsd_t_cpu_t3_arena() { std::free(t3_d); }
+
+  ccsd_t_cpu_t3_arena(const ccsd_t_cpu_t3_arena&)            = delete;
+  ccsd_t_cpu_t3_arena& operator=(const ccsd_t_cpu_t3_arena&) = delete;
+
+  // zero the t3 of a task with tile sizes ext[T3_H3..T3_P4] in the partition of
+  // ccsd_t_cpu_s1_energy; called by every thread of a parallel region, without a barrier at the end
+  void zero(const int* ext) {
+    const int    size_p4 = ext[T3_P4], size_p5 = ext[T3_P5], size_p6 = ext[T3_P6];
+    const size_t row     = (size_t) ext[T3_H1] * ext[T3_H2] * ext[T3_H3];
+#pragma omp for collapse(3) schedule(static) nowait
+    for(int p4 = 0; p4 < size_p4; p4++)
+      for(int p5 = 0; p5 < size_p5; p5++)
+        for(int p6 = 0; p6 < size_p6; p6++) {
+          F* dst = t3_d + (((size_t) p4 * size_p5 + p5) * size_p6 + p6) * row;
+          std::fill(dst, dst + row, F(0));
+        }
+  }
+};
+
+// c[NR][MV * width] = a[k][MV * width]^T * b[k][NR] over k
+template<typename F, int MV>
+inline void ccsd_t_cpu_microkernel(const int size_k, const F* a, const size_t lda, const F* b,
+                                   const size_t ldb, F* c) {
+  using V          = ccsd_t_simd<F>;
+  constexpr int W  = V::width;
+  constexpr int NR = V::nr;
+
+  typename V::reg acc[NR][MV];
+  for(int r = 0; r < NR; r++)
+    for(int v = 0; v < MV; v++) acc[r][v] = V::zero();
+
+  for(int k = 0; k < size_k; k++) {
+    const F*        ak = a + k * lda;
+    const F*        bk = b + k * ldb;
+    typename V::reg av[MV];
+    for(int v = 0; v < MV; v++) av[v] = V::load(ak + v * W);
+    for(int r = 0; r < NR; r++) {
+      const typename V::reg br = V::bcast(bk + r);
+      for(int v = 0; v < MV; v++) acc[r][v] = V::fmadd(av[v], br, acc[r][v]);
+    }
+  }
+
+  for(int r = 0; r < NR; r++)
+    for(int v = 0; v < MV; v++) V::store(c + (r * MV + v) * W, acc[r][v]);
+}
+
+//
+//  appends the plan of t3 += sign * sum_k a * b for one enabled d1/d2 term to ws and grows the
+//  panels. ext[T3_H3..T3_P4] are the t3 tile sizes, ext[T3_K] the size of the contracted index.
+//
+template<typename F>
+inline void ccsd_t_cpu_plan_term(const ccsd_t_cpu_term<F>& term, const int* ext,
+                                 ccsd_t_cpu_workspace<F>& ws) {
+  using V          = ccsd_t_simd<F>;
+  constexpr int W  = V::width;
+  constexpr int NR = V::nr;
+
+  if(ws.plans.size() <= ws.num_plans) ws.plans.resize(ws.num_plans + 1);
+  ccsd_t_cpu_plan<F>& plan = ws.plans[ws.num_plans];
+
+  const bool a_has_h3 = std::find(term.a.idx, term.a.idx + term.a.ndim, (int) T3_H3) !=
+                        term.a.idx + term.a.ndim;
+  plan.mop     = a_has_h3 ? term.a : term.b;
+  plan.nop     = a_has_h3 ? term.b : term.a;
+  plan.m_scale = a_has_h3 ? 1.0 : term.sign;
+  plan.n_scale = a_has_h3 ? term.sign : 1.0;
+  plan.size_k  = ext[T3_K];
+  std::copy(ext, ext + 7, plan.ext);
+
+  // t3 indices of each operand in t3 stride order; m_ids[0] is always h3
+  int m_ids[4], n_ids[4];
+  int nm = 0, nn = 0;
+  for(int d = 0; d < plan.mop.ndim; d++)
+    if(plan.mop.idx[d] != T3_K) m_ids[nm++] = plan.mop.idx[d];
+  for(int d = 0; d < plan.nop.ndim; d++)
+    if(plan.nop.idx[d] != T3_K) n_ids[nn++] = plan.nop.idx[d];
+  std::sort(m_ids, m_ids + nm);
+  std::sort(n_ids, n_ids + nn);
+
+  size_t t3_stride[6];
+  t3_stride[0] = 1;
+  for(int i = 1; i < 6; i++) t3_stride[i] = t3_stride[i - 1] * ext[i - 1];
+
+  plan.size_h3  = ext[T3_H3];
+  plan.nvec     = (plan.size_h3 + W - 1) / W;
+  plan.size_h3p = (size_t) plan.nvec * W;
+  plan.m_outer  = 1;
+  for(int j = 1; j < nm; j++) plan.m_outer *= ext[m_ids[j]];
+  plan.size_n = 1;
+  for(int j = 0; j < nn; j++) plan.size_n *= ext[n_ids[j]];
+  plan.ldm = plan.size_h3p * plan.m_outer;
+  plan.ldn = ((plan.size_n + NR - 1) / NR) * NR;
+
+  std::fill(plan.m_stride, plan.m_stride + 7, 0);
+  std::fill(plan.n_stride, plan.n_stride + 7, 0);
+  plan.m_stride[T3_K]  = plan.ldm;
+  plan.n_stride[T3_K]  = plan.ldn;
+  size_t stride        = plan.size_h3p;
+  plan.m_stride[T3_H3] = 1;
+  for(int j = 1; j < nm; j++) {
+    plan.m_stride[m_ids[j]] = stride;
+    stride *= ext[m_ids[j]];
+  }
+  stride = 1;
+  for(int j = 0; j < nn; j++) {
+    plan.n_stride[n_ids[j]] = stride;
+    stride *= ext[n_ids[j]];
+  }
+
+  // t3 offsets of the m panel rows (without h3) and of the n panel columns
+  plan.off_m.resize(plan.m_outer);
+  plan.off_n.resize(plan.size_n);
+  for(size_t r = 0; r < plan.m_outer; r++) {
+    size_t rem = r, off = 0;
+    for(int j = 1; j < nm; j++) {
+      off += (rem % ext[m_ids[j]]) * t3_stride[m_ids[j]];
+      rem /= ext[m_ids[j]];
+    }
+    plan.off_m[r] = off;
+  }
+  for(size_t c = 0; c < plan.size_n; c++) {
+    size_t rem = c, off = 0;
+    for(int j = 0; j < nn; j++) {
+      off += (rem % ext[n_ids[j]]) * t3_stride[n_ids[j]];
+      rem /= ext[n_ids[j]];
+    }
+    plan.off_n[c] = off;
+  }
+
+  // the padding lanes of the panels are never stored back, so they are not cleared
+  const size_t set = ws.num_plans % 2;
+  if(ws.pack_m[set].size() < plan.size_k * plan.ldm) ws.pack_m[set].resize(plan.size_k * plan.ldm);
+  if(ws.pack_n[set].size() < plan.size_k * plan.ldn) ws.pack_n[set].resize(plan.size_k * plan.ldn);
+  ws.num_plans++;
+}
+
+// the (i2, i3) slices of an operand block, each scattered into a k-major panel
+struct ccsd_t_cpu_slices {
+  int    n[4] = {1, 1, 1, 1};
+  size_t s[4] = {0, 0, 0, 0};
+
+  template<typename F>
+  ccsd_t_cpu_slices(const ccsd_t_cpu_operand<F>& op, const int* ext, const size_t* dst_stride) {
+    for(int d = 0; d < op.ndim; d++) {
+      n[d] = ext[op.idx[d]];
+      s[d] = dst_stride[op.idx[d]];
+    }
+  }
+
+  size_t count() const { return (size_t) n[2] * n[3]; }
+
+  template<typename F>
+  void pack(const ccsd_t_cpu_operand<F>& op, size_t slice, const double scale, F* dst) const {
+    const int i2  = (int) (slice % n[2]), i3 = (int) (slice / n[2]);
+    const F*  src = op.ptr + slice * n[0] * n[1];
+    F*        out = dst + i2 * s[2] + i3 * s[3];
+    for(int i1 = 0; i1 < n[1]; i1++)
+      for(int i0 = 0; i0 < n[0]; i0++)
+        out[i0 * s[0] + i1 * s[1]] = (F) (scale * src[i0 + (size_t) i1 * n[0]]);
+  }
+};
+
+// packs both operands of a planned term; called by every thread of a parallel region, no barrier
+template<typename F>
+inline void ccsd_t_cpu_pack(const ccsd_t_cpu_plan<F>& plan, F* pack_m, F* pack_n) {
+  const ccsd_t_cpu_slices m_slices(plan.mop, plan.ext, plan.m_stride);
+  const ccsd_t_cpu_slices n_slices(plan.nop, plan.ext, plan.n_stride);
+  const int64_t           num_m = (int64_t) m_slices.count();
+  const int64_t           num   = num_m + (int64_t) n_slices.count();
+
+#pragma omp for schedule(dynamic) nowait
+  for(int64_t i = 0; i < num; i++) {
+    if(i < num_m) m_slices.pack(plan.mop, i, plan.m_scale, pack_m);
+    else n_slices.pack(plan.nop, i - num_m, plan.n_scale, pack_n);
+  }
+}
+
+//
+//  t3 += the packed GEMM of a planned term over (MV x width) x NR register tiles; called by every
+//  thread of a parallel region, no barrier. the tiles are handed out dynamically, so a small
+//  edge-tile term finishes as soon as its last tile is done.
+//
+template<typename F>
+inline void ccsd_t_cpu_gemm(const ccsd_t_cpu_plan<F>& plan, const F* pack_m, const F* pack_n,
+                            F* t3) {
+  using V          = ccsd_t_simd<F>;
+  constexpr int W  = V::width;
+  constexpr int NR = V::nr;
+
+  const size_t* off_m      = plan.off_m.data();
+  const size_t* off_n      = plan.off_n.data();
+  const int     nvec       = plan.nvec;
+  const int     nmb_per_r  = (nvec + 1) / 2;
+  const size_t  num_mblock = plan.m_outer * nmb_per_r;
+  const size_t  num_nblock = plan.ldn / NR;
+
+#pragma omp for collapse(2) schedule(dynamic) nowait
+  for(size_t mb = 0; mb < num_mblock; mb++)
+    for(size_t nb = 0; nb < num_nblock; nb++) {
+      const size_t r  = mb / nmb_per_r;
+      const int    v0 = (int) (mb % nmb_per_r) * 2;
+      const int    mv = std::min(2, nvec - v0);
+
+      alignas(64) F c[NR * 2 * W];
+      const F*      ap = pack_m + r * plan.size_h3p + v0 * W;
+      const F*      bp = pack_n + nb * NR;
+      if(mv == 2) ccsd_t_cpu_microkernel<F, 2>(plan.size_k, ap, plan.ldm, bp, plan.ldn, c);
+      else ccsd_t_cpu_microkernel<F, 1>(plan.size_k, ap, plan.ldm, bp, plan.ldn, c);
+
+      const int ncols = (int) std::min((size_t) NR, plan.size_n - nb * NR);
+      const int nrows = std::min(mv * W, plan.size_h3 - v0 * W);
+      F*        t3_r  = t3 + off_m[r] + v0 * W;
+      for(int j = 0; j < ncols; j++) {
+        F*       dst = t3_r + off_n[nb * NR + j];
+        const F* src = c + j * mv * W;
+        for(int i = 0; i < nrows; i++) dst[i] += src[i];
+      }
+    }
+}
+
+//
+//  the s1 terms and the [T]/(T) energies in one pass over the finished t3d. every s1 term is a
+//  rank-1 update, so t3s is evaluated per element while t3d is in registers and never stored:
+//      energy_1 += factor * t3d * t3d / D,  energy_2 += factor * t3d * (t3d + t3s) / D
+//  with D = e_h3 + e_h2 + e_h1 - e_p6 - e_p5 - e_p4; evl[T3_H3..T3_P4] are the tile energies.
+//  called by every thread of a parallel region, no barrier. t3s and the sums are in double.
+//
+template<typename F>
+inline void ccsd_t_cpu_s1_energy(const ccsd_t_cpu_term<F>* terms, const int nterms,
+                                 const int* ext, const F* t3_d, const double* const* evl,
+                                 const double factor, double& energy_1, double& energy_2) {
+  // operand strides of every t3 index (0 where the operand does not carry it)
+  size_t sa[9][6] = {}, sb[9][6] = {};
+  for(int t = 0; t < nterms; t++) {
+    size_t stride = 1;
+    for(int d = 0; d < terms[t].a.ndim; d++) {
+      sa[t][terms[t].a.idx[d]] = stride;
+      stride *= ext[terms[t].a.idx[d]];
+    }
+    stride = 1;
+    for(int d = 0; d < terms[t].b.ndim; d++) {
+      sb[t][terms[t].b.idx[d]] = stride;
+      stride *= ext[terms[t].b.idx[d]];
+    }
+  }
+
+  const int size_h3 = ext[T3_H3], size_h2 = ext[T3_H2], size_h1 = ext[T3_H1];
+  const int size_p6 = ext[T3_P6], size_p5 = ext[T3_P5], size_p4 = ext[T3_P4];
+  double    e1 = 0.0, e2 = 0.0;
+
+#pragma omp for collapse(3) schedule(static) nowait
+  for(int p4 = 0; p4 < size_p4; p4++)
+    for(int p5 = 0; p5 < size_p5; p5++)
+      for(int p6 = 0; p6 < size_p6; p6++)
+        for(int h1 = 0; h1 < size_h1; h1++)
+          for(int h2 = 0; h2 < size_h2; h2++) {
+            const size_t  row = (((((size_t) p4 * size_p5 + p5) * size_p6 + p6) * size_h1 + h1) *
+                                  size_h2 +
+                                h2) *
+                               size_h3;
+            const F*      t3d = t3_d + row;
+            const double  eph = evl[T3_H2][h2] + evl[T3_H1][h1] - evl[T3_P6][p6] -
+                               evl[T3_P5][p5] - evl[T3_P4][p4];
+
+            const F*      a[9];
+            const F*      b[9];
+            for(int t = 0; t < nterms; t++) {
+              const int i[6] = {0, h2, h1, p6, p5, p4};
+              size_t    oa = 0, ob = 0;
+              for(int d = T3_H2; d <= T3_P4; d++) {
+                oa += i[d] * sa[t][d];
+                ob += i[d] * sb[t][d];
+              }
+              a[t] = terms[t].a.ptr + oa;
+              b[t] = terms[t].b.ptr + ob;
+            }
+
+            for(int h3 = 0; h3 < size_h3; h3++) {
+              double t3s = 0.0;
+              for(int t = 0; t < nterms; t++)
+                t3s += terms[t].sign * a[t][h3 * sa[t][T3_H3]] * b[t][h3 * sb[t][T3_H3]];
+              const double w = factor / (evl[T3_H3][h3] + eph);
+              const double d = t3d[h3];
+              e1 += d * d * w;
+              e2 += d * (d + t3s) * w;
+            }
+          }
+
+#pragma omp atomic
+  energy_1 += e1;
+#pragma omp atomic
+  energy_2 += e2;
+}
+
+//
+//  evaluates a task in a single parallel region: t3d is zeroed, the planned d1/d2 terms of ws are
+//  packed and contracted in turn with one barrier each, and the s1 terms and energies follow in
+//  the final pass. packing term i + 1 overlaps with the remaining GEMM tiles of term i.
+//
+template<typename F>
+inline void ccsd_t_cpu_run_task(ccsd_t_cpu_workspace<F>& ws, ccsd_t_cpu_t3_arena<F>& t3_arena,
+                                const int* ext, const ccsd_t_cpu_term<F>* s1_terms,
+                                const int num_s1_terms, const double* const* evl,
+                                const double factor, double& energy_1, double& energy_2) {
+#pragma omp parallel
+  {
+    t3_arena.zero(ext);
+    for(size_t i = 0; i < ws.num_plans; i++) {
+      const ccsd_t_cpu_plan<F>& plan = ws.plans[i];
+      ccsd_t_cpu_pack(plan, ws.pack_m[i % 2].data(), ws.pack_n[i % 2].data());
+#pragma omp barrier
+      ccsd_t_cpu_gemm(plan, ws.pack_m[i % 2].data(), ws.pack_n[i % 2].data(), t3_arena.t3_d);
+    }
+#pragma omp barrier
+    ccsd_t_cpu_s1_energy(s1_terms, num_s1_terms, ext, t3_arena.t3_d, evl, factor, energy_1,
+                         energy_2);
+  }
+  ws.num_plans = 0;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ccsd_t_node_cache.hpp"
+#include "ccsd_t_staging.hpp"
+#include "ccsd_t_transpose.hpp"
 #include "tamm/tamm.hpp"
 // using namespace tamm;
 
@@ -163,6 +166,7 @@ void ccsd_t_data_d1_new(bool is_restricted,
 
   // ia6 -- get for t2
   //  d1b = 0;
+  ccsd_t_stager<T> stager;
   idx_offset = 0;
   // printf ("[%s] ------------------------------------------------------\n", __func__);
   for(auto ia6 = 0; ia6 < 9; ia6++) {
@@ -176,56 +180,30 @@ void ccsd_t_data_d1_new(bool is_restricted,
       size_t dima_sort  = k_range[p4b] * k_range[p5b] * k_range[h1b];
       size_t dima       = dim_common * dima_sort;
 
-      std::vector<T> k_a(dima);
-      std::vector<T> k_a_sort(dima);
-
-      IndexVector a_bids_minus_sidx = {p4b - noab, p5b - noab, h7b, h1b};
-      auto [hit, value]             = cache_d1t.log_access(a_bids_minus_sidx);
-
-      if(hit) {
-        // if (false) {
-        // std::copy(value.begin(), value.end(), k_abuf1.begin() + d1b * max_dima);
-        // d1b += value.size() / max_dima;
-        k_a_sort = value;
-      }
-      else {
-        if(h7b < h1b) {
-          {
-            TimerGuard tg_total{&ccsdt_d1_t2_GetTime};
-            ccsd_t_data_per_rank += dima;
-            d_t2.get({p4b - noab, p5b - noab, h7b, h1b},
-                     k_a); // h1b,h7b,p5b-noab,p4b-noab
+      // to get a unique t2 according to ia6 and noab, sorted straight into the kernel buffer
+      T* k_a_sort = df_T_d1_t2 + (idx_offset * max_dima);
+
+      stager.add(
+        CCSDT_CACHE_D1T, cache_d1t, {p4b - noab, p5b - noab, h7b, h1b}, k_a_sort, dima,
+        [&, p4b = p4b, p5b = p5b, h1b = h1b, h7b, dima](std::vector<T>& k_a, T* k_a_sort) {
+          k_a.resize(dima);
+          if(h7b < h1b) {
+            ccsd_t_stage_get<T>(&ccsdt_d1_t2_GetTime, dima, [&] {
+              d_t2.get({p4b - noab, p5b - noab, h7b, h1b}, k_a); // h1b,h7b,p5b-noab,p4b-noab
+            });
+            int size[4] = {(int) k_range[p4b], (int) k_range[p5b], (int) k_range[h7b],
+                           (int) k_range[h1b]};
+            ccsd_t_transpose<3, 1, 0, 2, T>(-1.0, k_a.data(), size, k_a_sort);
           }
-          int perm[4] = {3, 1, 0, 2}; // 3,1,0,2
-          int size[4] = {(int) k_range[p4b], (int) k_range[p5b], (int) k_range[h7b],
-                         (int) k_range[h1b]};
-
-          auto plan = hptt::create_plan(perm, 4, -1.0, &k_a[0], size, NULL, 0, &k_a_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        if(h1b <= h7b) {
-          {
-            TimerGuard tg_total{&ccsdt_d1_t2_GetTime};
-            ccsd_t_data_per_rank += dima;
-            d_t2.get({p4b - noab, p5b - noab, h1b, h7b},
-                     k_a); // h7b,h1b,p5b-noab,p4b-noab
+          else {
+            ccsd_t_stage_get<T>(&ccsdt_d1_t2_GetTime, dima, [&] {
+              d_t2.get({p4b - noab, p5b - noab, h1b, h7b}, k_a); // h7b,h1b,p5b-noab,p4b-noab
+            });
+            int size[4] = {(int) k_range[p4b], (int) k_range[p5b], (int) k_range[h1b],
+                           (int) k_range[h7b]};
+            ccsd_t_transpose<2, 1, 0, 3, T>(1.0, k_a.data(), size, k_a_sort);
           }
-          int perm[4] = {2, 1, 0, 3}; // 2,1,0,3
-          int size[4] = {(int) k_range[p4b], (int) k_range[p5b], (int) k_range[h1b],
-                         (int) k_range[h7b]};
-
-          auto plan = hptt::create_plan(perm, 4, 1.0, &k_a[0], size, NULL, 0, &k_a_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        value = k_a_sort;
-      }
-
-      {
-        // to get a unique t2 according to ia6 and noab.
-        std::copy(k_a_sort.begin(), k_a_sort.end(), df_T_d1_t2 + (idx_offset * max_dima));
-      }
+        });
 
       idx_offset++;
     } // h7b
@@ -242,41 +220,31 @@ void ccsd_t_data_d1_new(bool is_restricted,
       size_t dimb_sort  = k_range[p6b] * k_range[h2b] * k_range[h3b];
       size_t dimb       = dim_common * dimb_sort;
 
-      std::vector<T> k_b_sort(dimb);
-
-      IndexVector b_bids_minus_sidx = {h2b, h3b, h7b, p6b - noab};
-      auto [hit, value]             = cache_d1v.log_access(b_bids_minus_sidx);
+      // to get a unique v2 according to ia6 and noab
+      T* k_b_sort = df_T_d1_v2 + (idx_offset * max_dimb);
 
-      if(hit) { k_b_sort = value; }
-      else {
-        std::vector<T> k_b(dimb);
-        {
-          TimerGuard tg_total{&ccsdt_d1_v2_GetTime};
-          ccsd_t_data_per_rank += dimb;
-          d_v2.v2ijka.get({h2b, h3b, h7b, p6b - noab}, k_b); // h7b,p6b,h2b,h3b
-
-          int perm[4] = {2, 3, 0, 1};
+      stager.add(
+        CCSDT_CACHE_D1V, cache_d1v, {h2b, h3b, h7b, p6b - noab}, k_b_sort, dimb,
+        [&, p6b = p6b, h2b = h2b, h3b = h3b, h7b, dimb](std::vector<T>& k_b, T* k_b_sort) {
+          k_b.resize(dimb);
+          ccsd_t_stage_get<T>(&ccsdt_d1_v2_GetTime, dimb, [&] {
+            d_v2.v2ijka.get({h2b, h3b, h7b, p6b - noab}, k_b); // h7b,p6b,h2b,h3b
+          });
           int size[4] = {(int) k_range[h2b], (int) k_range[h3b], (int) k_range[h7b],
                          (int) k_range[p6b]};
-
-          auto plan = hptt::create_plan(perm, 4, 1.0, &k_b[0], size, NULL, 0, &k_b_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        value = k_b_sort;
-      }
-
-      {
-        // to get a unique v2 according to ia6 and noab
-        // printf ("[%s] to get d1_v2 based on ia=%2lu, noab=%2lu >> linearized: %d (%d)\n",
-        // __func__, ia6, h7b, idx_offset, idx_offset * max_dimb);
-        std::copy(k_b_sort.begin(), k_b_sort.end(), df_T_d1_v2 + (idx_offset * max_dimb));
-      }
+          ccsd_t_transpose<2, 3, 0, 1, T>(1.0, k_b.data(), size, k_b_sort);
+        });
+                   int size[4] = {(int) k_range[h2b], (int) k_range[h3b], (int) k_range[h7b],
+                                  (int) k_range[p6b]};
+                   ccsd_t_transpose<2, 3, 0, 1, T>(1.0, k_b.data(), size, k_b_sort);
+                 });
 
       idx_offset++;
     } // h7b
   }   // end ia6
 
+  stager.run();
+
   *df_num_d1_enabled = idx_offset;
 } // ccsd_t_data_d1
 
@@ -287,7 +255,9 @@ void ccsd_t_data_d1_info_only(bool is_restricted, const Index noab, const Index
                               size_t t_h3b, size_t t_p4b, size_t t_p5b, size_t t_p6b,
                               //
                               int* df_simple_d1_size, int* df_simple_d1_exec,
-                              int* num_enabled_kernels, size_t& comm_data_elems) {
+                              int* num_enabled_kernels, size_t& comm_data_elems,
+                              std::vector<IndexVector>* t_keys = nullptr,
+                              std::vector<IndexVector>* v_keys = nullptr) {
   std::tuple<Index, Index, Index, Index, Index, Index> a3_d1[] = {
     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b),
     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h2b, t_h1b, t_h3b),
@@ -392,6 +362,8 @@ void ccsd_t_data_d1_info_only(bool is_restricted, const Index noab, const Index
       size_t dima_sort  = k_range[p4b] * k_range[p5b] * k_range[h1b];
       size_t dimb_sort  = k_range[p6b] * k_range[h2b] * k_range[h3b];
       comm_data_elems += dim_common * (dima_sort + dimb_sort);
+      if(t_keys) t_keys->push_back({p4b - noab, p5b - noab, h7b, h1b});
+      if(v_keys) v_keys->push_back({h2b, h3b, h7b, p6b - noab});
 
       if(ref_p456_h123 == cur_p456_h123) {
         df_simple_d1_exec[0 + h7b * 9] = idx_offset;
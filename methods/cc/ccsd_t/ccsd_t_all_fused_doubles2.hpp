@@ -1,5 +1,9 @@
 #pragma once
 
+#include "ccsd_t_chol_iabc.hpp"
+#include "ccsd_t_node_cache.hpp"
+#include "ccsd_t_staging.hpp"
+#include "ccsd_t_transpose.hpp"
 #include "tamm/tamm.hpp"
 // using namespace tamm;
 
@@ -164,6 +168,7 @@ void ccsd_t_data_d2_new(bool is_restricted,
     } // p7b
   }   // end ia6
 
+  ccsd_t_stager<T> stager;
   idx_offset = 0;
   for(auto ia6 = 0; ia6 < 9; ia6++) {
     auto [p4b, p5b, p6b, h1b, h2b, h3b] = a3_d2[ia6];
@@ -175,44 +180,30 @@ void ccsd_t_data_d2_new(bool is_restricted,
       size_t dima_sort  = k_range[p4b] * k_range[h1b] * k_range[h2b];
       size_t dima       = dim_common * dima_sort;
 
-      std::vector<T> k_a(dima);
-      std::vector<T> k_a_sort(dima);
-
-      IndexVector a_bids_minus_sidx = {p7b - noab, p4b - noab, h1b, h2b};
-      auto [hit, value]             = cache_d2t.log_access(a_bids_minus_sidx);
-      if(hit) { k_a_sort = value; }
-      else {
-        if(p7b < p4b) {
-          {
-            TimerGuard tg_total{&ccsdt_d2_t2_GetTime};
-            ccsd_t_data_per_rank += dima;
-            d_t2.get({p7b - noab, p4b - noab, h1b, h2b}, k_a); // h2b,h1b,p4b-noab,p7b-noab
+      // to get a unique t2 according to ia6 and nvab, sorted straight into the kernel buffer
+      T* k_a_sort = df_T_d2_t2 + (idx_offset * max_dima2);
+
+      stager.add(
+        CCSDT_CACHE_D2T, cache_d2t, {p7b - noab, p4b - noab, h1b, h2b}, k_a_sort, dima,
+        [&, p4b = p4b, h1b = h1b, h2b = h2b, p7b, dima](std::vector<T>& k_a, T* k_a_sort) {
+          k_a.resize(dima);
+          if(p7b < p4b) {
+            ccsd_t_stage_get<T>(&ccsdt_d2_t2_GetTime, dima, [&] {
+              d_t2.get({p7b - noab, p4b - noab, h1b, h2b}, k_a); // h2b,h1b,p4b-noab,p7b-noab
+            });
+            int size[4] = {(int) k_range[p7b], (int) k_range[p4b], (int) k_range[h1b],
+                           (int) k_range[h2b]};
+            ccsd_t_transpose<3, 2, 1, 0, T>(-1.0, k_a.data(), size, k_a_sort);
           }
-          // for (auto x=0;x<dima;x++) k_a_sort[x] = -1 * k_a[x];
-          int perm[4] = {3, 2, 1, 0};
-          int size[4] = {(int) k_range[p7b], (int) k_range[p4b], (int) k_range[h1b],
-                         (int) k_range[h2b]};
-
-          auto plan = hptt::create_plan(perm, 4, -1.0, &k_a[0], size, NULL, 0, &k_a_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        if(p4b <= p7b) {
-          {
-            TimerGuard tg_total{&ccsdt_d2_t2_GetTime};
-            ccsd_t_data_per_rank += dima;
-            d_t2.get({p4b - noab, p7b - noab, h1b, h2b}, k_a); // h2b,h1b,p7b-noab,p4b-noab
+          else {
+            ccsd_t_stage_get<T>(&ccsdt_d2_t2_GetTime, dima, [&] {
+              d_t2.get({p4b - noab, p7b - noab, h1b, h2b}, k_a); // h2b,h1b,p7b-noab,p4b-noab
+            });
+            int size[4] = {(int) k_range[p4b], (int) k_range[p7b], (int) k_range[h1b],
+                           (int) k_range[h2b]};
+            ccsd_t_transpose<3, 2, 0, 1, T>(1.0, k_a.data(), size, k_a_sort);
           }
-          int perm[4] = {3, 2, 0, 1}; // 0,1,3,2
-          int size[4] = {(int) k_range[p4b], (int) k_range[p7b], (int) k_range[h1b],
-                         (int) k_range[h2b]};
-
-          auto plan = hptt::create_plan(perm, 4, 1.0, &k_a[0], size, NULL, 0, &k_a_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        value = k_a_sort;
-      }
+        });
 
       // auto ref_p456_h123 =
       //     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b);
@@ -226,12 +217,6 @@ void ccsd_t_data_d2_new(bool is_restricted,
       // auto cur_p564_h312 = std::make_tuple(p5b, p6b, p4b, h3b, h1b, h2b);
       // auto cur_p564_h132 = std::make_tuple(p5b, p6b, p4b, h1b, h3b, h2b);
 
-      {
-        // to get a unique t2 according to ia6 and nvab
-        // printf ("[%s] copy d2_t2 based on idx_offset: %d\n", __func__, idx_offset);
-        std::copy(k_a_sort.begin(), k_a_sort.end(), df_T_d2_t2 + (idx_offset * max_dima2));
-      }
-
       // if (ref_p456_h123 == cur_p456_h123) {
       //   std::copy(k_a_sort.begin(), k_a_sort.end(),
       //             T_d2_t2 + d2b * max_dima2);
@@ -294,41 +279,35 @@ void ccsd_t_data_d2_new(bool is_restricted,
       size_t dimb_sort  = k_range[p5b] * k_range[p6b] * k_range[h3b];
       size_t dimb       = dim_common * dimb_sort;
 
-      std::vector<T> k_b_sort(dimb);
-
-      IndexVector b_bids_minus_sidx = {h3b, p7b - noab, p5b - noab, p6b - noab};
-      auto [hit, value]             = cache_d2v.log_access(b_bids_minus_sidx);
-
-      if(hit) { k_b_sort = value; }
-      else {
-        // auto bbuf_start = d2b * max_dimb2;
-        std::vector<T> k_b(dimb);
-        {
-          TimerGuard tg_total{&ccsdt_d2_v2_GetTime};
-          ccsd_t_data_per_rank += dimb;
-          d_v2.v2iabc.get({h3b, p7b - noab, p5b - noab, p6b - noab}, k_b); // p5b,p6b,h3b,p7b
-
-          int perm[4] = {2, 3, 0, 1};
+      // to get a unique v2 according to ia6 and nvab
+      T* k_b_sort = df_T_d2_v2 + idx_offset * max_dimb2;
+
+      stager.add(
+        CCSDT_CACHE_D2V, cache_d2v, {h3b, p7b - noab, p5b - noab, p6b - noab}, k_b_sort, dimb,
+        [&, p5b = p5b, p6b = p6b, h3b = h3b, p7b, dimb](std::vector<T>& k_b, T* k_b_sort) {
+          k_b.resize(dimb);
+          const IndexVector bids{h3b, p7b - noab, p5b - noab, p6b - noab}; // p5b,p6b,h3b,p7b
+          if(ccsdt_chol_iabc.enabled()) {
+            // only the slices L(x,y,:) read on a cache miss are transferred; the GEMMs of the
+            // block run outside the lock
+            thread_local ccsd_t_chol_iabc::scratch chol;
+            ccsd_t_stage_get<T>(&ccsdt_d2_v2_GetTime, 0, [&] {
+              ccsd_t_data_per_rank += ccsdt_chol_iabc.fetch(bids, chol) * sizeof(double);
+            });
+            ccsdt_chol_iabc.build(bids, chol, k_b);
+          }
+          else ccsd_t_stage_get<T>(&ccsdt_d2_v2_GetTime, dimb, [&] { d_v2.v2iabc.get(bids, k_b); });
           int size[4] = {(int) k_range[h3b], (int) k_range[p7b], (int) k_range[p5b],
                          (int) k_range[p6b]};
-
-          auto plan = hptt::create_plan(perm, 4, 1.0, &k_b[0], size, NULL, 0, &k_b_sort[0], NULL,
-                                        hptt::ESTIMATE, 1, NULL, true);
-          plan->execute();
-        }
-        value = k_b_sort;
-      }
-
-      {
-        // to get a unique v2 according to ia6 and nvab
-        // printf ("[%s] copy d2_v2 based on idx_offset: %d\n", __func__, idx_offset);
-        std::copy(k_b_sort.begin(), k_b_sort.end(), df_T_d2_v2 + idx_offset * max_dimb2);
-      }
+          ccsd_t_transpose<2, 3, 0, 1, T>(1.0, k_b.data(), size, k_b_sort);
+        });
 
       idx_offset++;
     } // p7b
   }   // end ia6
 
+  stager.run();
+
   //
   *df_num_d2_enabled = idx_offset;
 } // ccsd_t_data_d2
@@ -339,7 +318,9 @@ void ccsd_t_data_d2_info_only(bool is_restricted, const Index noab, const Index
                               std::vector<size_t>& k_range, size_t t_h1b, size_t t_h2b,
                               size_t t_h3b, size_t t_p4b, size_t t_p5b, size_t t_p6b,
                               int* df_simple_d2_size, int* df_simple_d2_exec,
-                              int* num_enabled_kernels, size_t& comm_data_elems) {
+                              int* num_enabled_kernels, size_t& comm_data_elems,
+                              std::vector<IndexVector>* t_keys = nullptr,
+                              std::vector<IndexVector>* v_keys = nullptr) {
   //
   std::tuple<Index, Index, Index, Index, Index, Index> a3_d2[] = {
     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b),
@@ -445,6 +426,8 @@ void ccsd_t_data_d2_info_only(bool is_restricted, const Index noab, const Index
       size_t dima_sort  = k_range[p4b] * k_range[h1b] * k_range[h2b];
       size_t dimb_sort  = k_range[p5b] * k_range[p6b] * k_range[h3b];
       comm_data_elems += dim_common * (dima_sort + dimb_sort);
+      if(t_keys) t_keys->push_back({p7b - noab, p4b - noab, h1b, h2b});
+      if(v_keys) v_keys->push_back({h3b, p7b - noab, p5b - noab, p6b - noab});
 
       if(ref_p456_h123 == cur_p456_h123) {
         df_simple_d2_exec[0 + (p7b - noab) * 9] = idx_offset;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ccsd_t_node_cache.hpp"
+#include "ccsd_t_staging.hpp"
+#include "ccsd_t_transpose.hpp"
 #include "tamm/tamm.hpp"
 // using namespace tamm;
 
@@ -154,6 +157,7 @@ void ccsd_t_data_s1_new(bool is_restricted,
 
   // ia6 -- get for t1
   //  s1b = 0;
+  ccsd_t_stager<T> stager;
   idx_offset = 0;
   for(auto ia6 = 0; ia6 < 9; ia6++) {
     if(!ia6_enabled[ia6]) { continue; }
@@ -163,29 +167,19 @@ void ccsd_t_data_s1_new(bool is_restricted,
     size_t dima_sort  = k_range[p4b] * k_range[h1b];
     size_t dima       = dim_common * dima_sort;
 
-    std::vector<T> k_a(dima);
-    std::vector<T> k_a_sort(dima);
-
-    auto [hit, value] = cache_s1t.log_access({p4b - noab, h1b});
-    if(hit) { k_a_sort = value; }
-    else {
-      {
-        // IndexVector bids = {p4b - noab, h1b};
-        TimerGuard tg_total{&ccsdt_s1_t1_GetTime};
-        ccsd_t_data_per_rank += dima;
-        d_t1.get({p4b - noab, h1b}, k_a);
-      }
-      const int ndim       = 2;
-      int       perm[ndim] = {1, 0};
-      int       size[ndim] = {(int) k_range[p4b], (int) k_range[h1b]};
-      // create a plan (shared_ptr)
-
-      // To-Do (JK): Do we need to transpose this?
-      auto plan = hptt::create_plan(perm, ndim, 1, &k_a[0], size, NULL, 0, &k_a_sort[0], NULL,
-                                    hptt::ESTIMATE, 1, NULL, true);
-      plan->execute();
-      value = k_a_sort;
-    }
+    // the block is written straight into its slot of the kernel's buffer
+    T* k_a_sort = df_T_s1_t1 + idx_offset * s1_max_dima;
+
+    stager.add(CCSDT_CACHE_S1T, cache_s1t, {p4b - noab, h1b}, k_a_sort, dima,
+               [&, p4b = p4b, h1b = h1b, dima](std::vector<T>& k_a, T* k_a_sort) {
+                 k_a.resize(dima);
+                 ccsd_t_stage_get<T>(&ccsdt_s1_t1_GetTime, dima,
+                                     [&] { d_t1.get({p4b - noab, h1b}, k_a); });
+                 int size[2] = {(int) k_range[p4b], (int) k_range[h1b]};
+
+                 // To-Do (JK): Do we need to transpose this?
+                 ccsd_t_transpose_2d<T>(1.0, k_a.data(), size, k_a_sort);
+               });
 
     // auto ref_p456_h123 =
     //     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b);
@@ -199,14 +193,6 @@ void ccsd_t_data_s1_new(bool is_restricted,
     // auto cur_p564_h213 = std::make_tuple(p5b, p6b, p4b, h2b, h1b, h3b);
     // auto cur_p564_h231 = std::make_tuple(p5b, p6b, p4b, h2b, h3b, h1b);
 
-    //
-    //  already pruned by "ia6_enabled[ia6]"
-    //
-    {
-      // printf ("[%s] to get s1's t1 // ia6=%lu // on %d (offset: %lu)\n", __func__, ia6,
-      // idx_offset, idx_offset * s1_max_dima);
-      std::copy(k_a_sort.begin(), k_a_sort.end(), df_T_s1_t1 + idx_offset * s1_max_dima);
-    }
 
     // if (ref_p456_h123 == cur_p456_h123) {
     //   std::copy(k_a_sort.begin(), k_a_sort.end(),
@@ -269,26 +255,18 @@ void ccsd_t_data_s1_new(bool is_restricted,
     size_t dimb_sort  = k_range[p5b] * k_range[p6b] * k_range[h2b] * k_range[h3b];
     size_t dimb       = dim_common * dimb_sort;
 
-    std::vector<T> k_b_sort(dimb);
-    auto [hit, value] = cache_s1v.log_access({h3b, h2b, p6b - noab, p5b - noab});
-    if(hit) { k_b_sort = value; }
-    else {
-      {
-        std::vector<T> k_b(dimb);
-        TimerGuard     tg_total{&ccsdt_s1_v2_GetTime};
-        ccsd_t_data_per_rank += dimb;
-        d_v2.v2ijab.get({h3b, h2b, p6b - noab, p5b - noab}, k_b); // p5b,p6b,h2b,h3b
-
-        int perm[4] = {3, 2, 1, 0};
-        int size[4] = {(int) k_range[h3b], (int) k_range[h2b], (int) k_range[p6b],
-                       (int) k_range[p5b]};
-
-        auto plan = hptt::create_plan(perm, 4, 1.0, &k_b[0], size, NULL, 0, &k_b_sort[0], NULL,
-                                      hptt::ESTIMATE, 1, NULL, true);
-        plan->execute();
-      }
-      value = k_b_sort;
-    }
+    T* k_b_sort = df_T_s1_v2 + idx_offset * s1_max_dimb;
+    stager.add(CCSDT_CACHE_S1V, cache_s1v, {h3b, h2b, p6b - noab, p5b - noab}, k_b_sort, dimb,
+               [&, p5b = p5b, p6b = p6b, h2b = h2b, h3b = h3b, dimb](std::vector<T>& k_b,
+                                                                     T* k_b_sort) {
+                 k_b.resize(dimb);
+                 ccsd_t_stage_get<T>(&ccsdt_s1_v2_GetTime, dimb, [&] {
+                   d_v2.v2ijab.get({h3b, h2b, p6b - noab, p5b - noab}, k_b); // p5b,p6b,h2b,h3b
+                 });
+                 int size[4] = {(int) k_range[h3b], (int) k_range[h2b], (int) k_range[p6b],
+                                (int) k_range[p5b]};
+                 ccsd_t_transpose<3, 2, 1, 0, T>(1.0, k_b.data(), size, k_b_sort);
+               });
 
     // auto ref_p456_h123 =
     //     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b);
@@ -302,14 +280,6 @@ void ccsd_t_data_s1_new(bool is_restricted,
     // auto cur_p564_h213 = std::make_tuple(p5b, p6b, p4b, h2b, h1b, h3b);
     // auto cur_p564_h231 = std::make_tuple(p5b, p6b, p4b, h2b, h3b, h1b);
 
-    //
-    //  already pruned by "ia6_enabled[ia6]"
-    //
-    {
-      // printf ("[%s] to get s1's v2 // ia6=%lu // on %d (offset: %lu)\n", __func__, ia6,
-      // idx_offset, idx_offset * s1_max_dimb);
-      std::copy(k_b_sort.begin(), k_b_sort.end(), df_T_s1_v2 + idx_offset * s1_max_dimb);
-    }
 
     // if (ref_p456_h123 == cur_p456_h123) {
     //   std::copy(k_b_sort.begin(), k_b_sort.end(),
@@ -361,6 +331,8 @@ void ccsd_t_data_s1_new(bool is_restricted,
     idx_offset++;
   } // end ia6
 
+  stager.run();
+
   *df_num_s1_enabled = idx_offset;
   // printf ("[%s] ------------------------------------------------ df_num_s1_enabled: %d\n",
   // __func__, *df_num_s1_enabled);
@@ -374,7 +346,9 @@ void ccsd_t_data_s1_info_only(bool is_restricted, const Index noab, const Index
                               size_t t_h3b, size_t t_p4b, size_t t_p5b, size_t t_p6b,
                               //
                               int* df_simple_s1_size, int* df_simple_s1_exec,
-                              int* num_enabled_kernels, size_t& comm_data_elems) {
+                              int* num_enabled_kernels, size_t& comm_data_elems,
+                              std::vector<IndexVector>* t_keys = nullptr,
+                              std::vector<IndexVector>* v_keys = nullptr) {
   std::tuple<Index, Index, Index, Index, Index, Index> a3_s1[] = {
     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h1b, t_h2b, t_h3b),
     std::make_tuple(t_p4b, t_p5b, t_p6b, t_h2b, t_h1b, t_h3b),
@@ -461,6 +435,8 @@ void ccsd_t_data_s1_info_only(bool is_restricted, const Index noab, const Index
     size_t dimb_sort  = k_range[p5b] * k_range[p6b] * k_range[h2b] * k_range[h3b];
 
     comm_data_elems += dim_common * (dima_sort + dimb_sort);
+    if(t_keys) t_keys->push_back({p4b - noab, h1b});
+    if(v_keys) v_keys->push_back({h3b, h2b, p6b - noab, p5b - noab});
 
     if(ref_p456_h123 == cur_p456_h123) {
       df_simple_s1_exec[0] = idx_offset;
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "ccsd_t_common.hpp"
+#include "tamm/tamm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <mpi.h>
+#include <vector>
+
+//
+//  per-rank memory (GiB) of the tiled engine: the staging buffers of a task (and its t3 on the
+//  CPU), and the LRU block caches of cache_size tasks (and the Cholesky slices of the v2iabc
+//  generator, for nchol vectors)
+//
+struct ccsd_t_tiled_mem {
+  double buffers = 0;
+  double cache   = 0;
+};
+
+inline ccsd_t_tiled_mem ccsd_t_tiled_mem_per_rank(const std::vector<size_t>& k_range, size_t noa,
+                                                  size_t nva, size_t noab, size_t nvab,
+                                                  size_t tilesize, size_t cache_size,
+                                                  double nchol = 0) {
+  const double gib      = 1024 * 1024 * 1024.0;
+  size_t       max_pdim = 0;
+  size_t       max_hdim = 0;
+  for(size_t t_p4b = noab; t_p4b < noab + nvab; t_p4b++)
+    max_pdim = std::max(max_pdim, k_range[t_p4b]);
+  for(size_t t_h1b = 0; t_h1b < noab; t_h1b++) max_hdim = std::max(max_hdim, k_range[t_h1b]);
+
+  size_t max_d1_kernels_pertask = 9 * noa;
+  size_t max_d2_kernels_pertask = 9 * nva;
+  size_t size_T_s1_t1           = 9 * (max_pdim) * (max_hdim);
+  size_t size_T_s1_v2           = 9 * (max_pdim * max_pdim) * (max_hdim * max_hdim);
+  size_t size_T_d1_t2 = max_d1_kernels_pertask * (max_pdim * max_pdim) * (max_hdim * max_hdim);
+  size_t size_T_d1_v2 = max_d1_kernels_pertask * (max_pdim) * (max_hdim * max_hdim * max_hdim);
+  size_t size_T_d2_t2 = max_d2_kernels_pertask * (max_pdim * max_pdim) * (max_hdim * max_hdim);
+  size_t size_T_d2_v2 = max_d2_kernels_pertask * (max_pdim * max_pdim * max_pdim) * (max_hdim);
+
+  ccsd_t_tiled_mem mem;
+  mem.buffers =
+    size_T_s1_t1 + size_T_s1_v2 + size_T_d1_t2 + size_T_d1_v2 + size_T_d2_t2 + size_T_d2_v2;
+#if !defined(USE_CUDA) && !defined(USE_HIP) && !defined(USE_DPCPP)
+  mem.buffers += std::pow(max_hdim, 3) * std::pow(max_pdim, 3); // t3 of a task
+#endif
+  mem.buffers = mem.buffers * 8 / gib;
+
+  size_t cache_buf_size = tilesize * tilesize * tilesize * tilesize * 8;  // bytes
+  mem.cache = (tilesize * tilesize * 8 + cache_buf_size) * cache_size;    // s1 t1+v2
+  mem.cache += (noab + nvab) * 2 * cache_size * cache_buf_size;           // d1,d2 t2+v2
+  mem.cache += cache_size * nvab * max_pdim * max_pdim * nchol * 8;       // L(x,y,:)
+  mem.cache = mem.cache / gib;
+  return mem;
+}
+
+//
+//  tile sizes of the (T) MO space for a tile size, as setupMOIS(sys_data, true) makes them:
+//  occ_alpha, occ_beta, virt_alpha, virt_beta, each cut into tilesize tiles and a remainder
+//
+inline std::array<std::vector<size_t>, 4> ccsd_t_autotune_tiles(const SystemData& sys_data,
+                                                               size_t             tilesize) {
+  const size_t n[4] = {(size_t) sys_data.n_occ_alpha, (size_t) sys_data.n_occ_beta,
+                       (size_t) sys_data.n_vir_alpha, (size_t) sys_data.n_vir_beta};
+
+  std::array<std::vector<size_t>, 4> tiles;
+  for(int s = 0; s < 4; s++) {
+    tiles[s].assign(n[s] / tilesize, tilesize);
+    if(n[s] % tilesize > 0) tiles[s].push_back(n[s] % tilesize);
+  }
+  return tiles;
+}
+
+//
+//  model of a tiled (T) run for a tile size t and a cache size c. over the tasks (sorted tile
+//  triples h1<=h2<=h3, p4<=p5<=p6 of equal spin) with N tasks and X t3 elements in all,
+//
+//    flops  F = 18 X (O + V)             (9 d1 and 9 d2 GEMMs over h7 and p7 of one spin)
+//    words  D = 18 sqrt(X N) (O + V)     (a t2 and a v2 block of t^3 per contraction tile)
+//    gets   G = 18 N (o + v)
+//
+//  where O, V (o, v) are the orbitals (tiles) per spin. the GEMMs over one tile read and write t3
+//  once, so they run at most at t/8 flops per byte of memory bandwidth. with the h3 loop
+//  innermost, half of a task's blocks do not depend on h3 and are refetched only when they have
+//  left the caches; the d1 caches hold the blocks of about 2c/9 tasks. the time per rank is
+//
+//    F / (P min(R, B t / 8)) + m(c) (G latency + 8 D / bandwidth) / P
+//
+//  with R and B the dgemm rate and memory bandwidth measured on the ranks, and m(c) the fraction
+//  of the blocks that is fetched.
+//
+struct ccsd_t_tuning {
+  int    tilesize   = 0;
+  int    cache_size = 0;
+  double mem        = 0; // GiB in all, as check_memory_requirements counts it
+  double compute    = 0; // predicted seconds
+  double comm       = 0;
+  bool   fits       = false;
+
+  double time() const { return compute + comm; }
+};
+
+// one-sided get latency (s) and bandwidth per node (bytes/s) of the model
+constexpr double ccsd_t_net_latency   = 3e-6;
+constexpr double ccsd_t_net_bandwidth = 10e9;
+
+class ccsd_t_autotuner {
+public:
+  // input_mem (the input tensors) and node_cache_mem are in GiB; nchol is 0 without the v2iabc
+  // generator
+  ccsd_t_autotuner(const SystemData& sys_data, bool is_restricted, int nranks, int ranks_per_node,
+                   double input_mem, double node_cache_mem, double nchol):
+    sys_data_(sys_data),
+    is_restricted_(is_restricted),
+    nranks_(nranks),
+    ppn_(ranks_per_node),
+    input_mem_(input_mem),
+    node_cache_mem_(node_cache_mem),
+    nchol_(nchol) {}
+
+  // collective. the slowest rank's dgemm rate and memory bandwidth
+  void calibrate(ExecutionContext& ec) {
+    using clock = std::chrono::high_resolution_clock;
+    auto best   = [](auto&& fn) {
+      double t = 1e30;
+      for(int i = 0; i < 3; i++) {
+        auto t0 = clock::now();
+        fn();
+        t = std::min(t, std::chrono::duration<double>(clock::now() - t0).count());
+      }
+      return t;
+    };
+
+    const size_t        n = 256;
+    std::vector<double> a(n * n, 1.0), b(n * n, 1.0), c(n * n, 0.0);
+    rate_ = 2.0 * n * n * n / best([&] {
+              blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::NoTrans, n, n, n,
+                         1.0, a.data(), n, b.data(), n, 0.0, c.data(), n);
+            });
+
+    std::vector<double> src(1 << 22, 1.0), dst(1 << 22);
+    bandwidth_ =
+      2.0 * 8 * src.size() / best([&] { std::copy(src.begin(), src.end(), dst.begin()); });
+
+    double r[2] = {rate_, bandwidth_};
+    MPI_Allreduce(MPI_IN_PLACE, r, 2, MPI_DOUBLE, MPI_MIN, ec.pg().comm());
+    rate_      = r[0];
+    bandwidth_ = r[1];
+  }
+
+  ccsd_t_tuning predict(int tilesize, int cache_size, double mem_limit) const {
+    auto tiles = ccsd_t_autotune_tiles(sys_data_, tilesize);
+
+    std::vector<size_t> k_range;
+    for(auto& s: tiles) k_range.insert(k_range.end(), s.begin(), s.end());
+    const size_t noa = tiles[0].size(), nva = tiles[2].size();
+    const size_t noab = noa + tiles[1].size(), nvab = nva + tiles[3].size();
+
+    ccsd_t_tuning tn;
+    tn.tilesize   = tilesize;
+    tn.cache_size = cache_size;
+    auto mem =
+      ccsd_t_tiled_mem_per_rank(k_range, noa, nva, noab, nvab, tilesize, cache_size, nchol_);
+    tn.mem  = input_mem_ + node_cache_mem_ + (mem.buffers + mem.cache) * nranks_;
+    tn.fits = tn.mem <= mem_limit;
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+    tn.fits = tn.fits && check_memory_req(tilesize, sys_data_.nbf).empty();
+#endif
+
+    // N and X, summed over the number j of beta tiles in h1,h2,h3 (and p4,p5,p6)
+    double num_tasks = 0, num_t3 = 0;
+    for(int j = 0; j <= (is_restricted_ ? 1 : 3); j++) {
+      num_tasks += tuples(tiles[0], 3 - j, true) * tuples(tiles[1], j, true) *
+                   tuples(tiles[2], 3 - j, true) * tuples(tiles[3], j, true);
+      num_t3 += tuples(tiles[0], 3 - j, false) * tuples(tiles[1], j, false) *
+                tuples(tiles[2], 3 - j, false) * tuples(tiles[3], j, false);
+    }
+
+    const double O = sys_data_.nocc / 2.0, V = sys_data_.nvir / 2.0;
+    const double flops = 18 * num_t3 * (O + V);
+    const double words = 18 * std::sqrt(num_t3 * num_tasks) * (O + V);
+    const double gets  = 18 * num_tasks * (noab + nvab) / 2.0;
+
+    const double kept    = std::max(1.0, 2.0 * cache_size / 9.0);
+    const double fetched = 0.5 + 0.5 / std::min(kept, (double) noab);
+
+    tn.compute = flops / (nranks_ * std::min(rate_, bandwidth_ * tilesize / 8));
+    tn.comm    = fetched * (gets * ccsd_t_net_latency + 8 * words * ppn_ / ccsd_t_net_bandwidth) /
+              nranks_;
+    return tn;
+  }
+
+  //
+  //  the candidate with the smallest predicted time among those within mem_limit (GiB in all),
+  //  or the one needing the least memory if none is. every candidate goes into tried.
+  //
+  ccsd_t_tuning tune(double mem_limit, std::vector<ccsd_t_tuning>& tried) const {
+    tried.clear();
+    for(int tilesize: {16, 20, 24, 28, 32, 40, 48, 56, 64})
+      for(int cache_size: {1, 2, 4, 8, 16, 32})
+        tried.push_back(predict(tilesize, cache_size, mem_limit));
+
+    auto better = [](const ccsd_t_tuning& a, const ccsd_t_tuning& b) {
+      if(a.fits != b.fits) return a.fits;
+      return a.fits ? a.time() < b.time() : a.mem < b.mem;
+    };
+    return *std::min_element(tried.begin(), tried.end(), better);
+  }
+
+  double rate() const { return rate_; }
+  double bandwidth() const { return bandwidth_; }
+
+private:
+  // sum over the sorted k-tuples of tiles of the products of their sizes (or their number)
+  static double tuples(const std::vector<size_t>& tiles, int k, bool count) {
+    double h[4] = {1, 0, 0, 0};
+    for(auto x: tiles)
+      for(int i = 1; i <= k; i++) h[i] += (count ? 1.0 : (double) x) * h[i - 1];
+    return h[k];
+  }
+
+  const SystemData& sys_data_;
+  bool              is_restricted_;
+  int               nranks_, ppn_;
+  double            input_mem_, node_cache_mem_, nchol_;
+  double            rate_ = 1e10, bandwidth_ = 1e10;
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//
+//  resumable (T). every rank periodically writes the tasks it has finished (screened tasks
+//  included), its partial [T]/(T) energies and its screening counts to <prefix>.<rank>; a
+//  restarted run skips those tasks, adds their energies and counts once (on rank 0) and starts
+//  the task counter at the lowest value still claimed by any rank.
+//
+//  tasks are identified by their (h1,h2,h3,p4,p5,p6) tiles, so a checkpoint can be resumed with
+//  a different number of ranks or loop variant. the keys and energies only carry over to a run
+//  of the same engine on the same tiling (see tiling()); otherwise the checkpoint is dropped and
+//  every task is run again. the counter position is only reused when the signature (loop variant
+//  and task order) matches as well. every restart bumps an epoch: rank 0 folds the previous files
+//  into its own, and files of older epochs are ignored and removed.
+//
+class ccsd_t_checkpoint {
+public:
+  bool enabled() const { return interval_ > 0; }
+
+  // collective over comm. interval is in seconds, zero disables checkpointing
+  void init(MPI_Comm comm, const std::string& prefix, int interval) {
+    comm_     = comm;
+    prefix_   = prefix;
+    interval_ = interval;
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &nranks_);
+  }
+
+  //
+  //  collective. reads the files of a previous run of the engine on the tiling, returns the
+  //  energies they hold (non-zero on rank 0 only), sets screened() and sets counter_start() for
+  //  a run with the given signature.
+  //
+  std::pair<double, double> restore(const std::string& engine, const std::string& tiling,
+                                    const std::string& signature) {
+    engine_    = engine;
+    tiling_    = tiling;
+    signature_ = signature;
+    if(!enabled()) return {0, 0};
+
+    double                e1 = 0, e2 = 0;
+    std::vector<uint64_t> done;
+    int64_t               header[2] = {0, 0}; // epoch, counter start
+    screened_                       = {0, 0};
+    if(rank_ == 0) {
+      std::vector<record> records;
+      for(auto& name: files()) {
+        record rec;
+        if(read(name, rec)) records.push_back(rec);
+      }
+      int64_t epoch = -1;
+      for(auto& rec: records) epoch = std::max(epoch, rec.epoch);
+
+      int     nfiles = 0, nranks_old = 0, nforeign = 0;
+      bool    same   = true;
+      int64_t start  = std::numeric_limits<int64_t>::max();
+      for(auto& rec: records) {
+        if(rec.epoch != epoch) continue;
+        if(rec.engine != engine_ || rec.tiling != tiling_) {
+          nforeign++;
+          continue;
+        }
+        nfiles++;
+        nranks_old = rec.nranks;
+        same       = same && rec.signature == signature_;
+        start      = std::min(start, rec.frontier);
+        e1 += rec.energy1;
+        e2 += rec.energy2;
+        screened_.first += rec.skipped;
+        screened_.second += rec.error;
+        done.insert(done.end(), rec.tasks.begin(), rec.tasks.end());
+      }
+      header[0] = epoch + 1;
+      header[1] = (nfiles > 0 && nfiles == nranks_old && same) ? start : 0;
+      if(nforeign > 0)
+        std::cout << "Ignoring " << nforeign << " (T) checkpoint files of a different engine or "
+                  << "tiling" << std::endl;
+      if(nfiles > 0)
+        std::cout << "Restarting (T) from checkpoint: " << done.size() << " tasks done, "
+                  << "task counter at " << header[1] << std::endl;
+    }
+
+    MPI_Bcast(header, 2, MPI_INT64_T, 0, comm_);
+    int64_t ndone = done.size();
+    MPI_Bcast(&ndone, 1, MPI_INT64_T, 0, comm_);
+    done.resize(ndone);
+    MPI_Bcast(done.data(), ndone, MPI_UINT64_T, 0, comm_);
+
+    epoch_    = header[0];
+    start_    = header[1];
+    frontier_ = start_;
+    done_     = std::unordered_set<uint64_t>(done.begin(), done.end());
+    if(rank_ == 0) completed_ = done;
+    last_ = std::chrono::steady_clock::now();
+
+    // rank 0 holds everything restored; write it before older files are dropped
+    if(rank_ == 0) {
+      write(e1, e2, screened_.first, screened_.second);
+      for(auto& name: files())
+        if(name != file(0)) std::filesystem::remove(name);
+    }
+    MPI_Barrier(comm_);
+    return {e1, e2};
+  }
+
+  //
+  //  names the tiling of the MO space: the number of occupied tiles and a hash of all the tile
+  //  sizes, which also changes with ccsdt_tilesize.
+  //
+  static std::string tiling(size_t noab, const std::vector<size_t>& tile_sizes) {
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for(auto size: tile_sizes) hash = (hash ^ size) * 1099511628211ull;
+    std::ostringstream name;
+    name << noab << "/" << tile_sizes.size() << "-" << std::hex << hash;
+    return name.str();
+  }
+
+  static uint64_t task_key(size_t t_h1b, size_t t_h2b, size_t t_h3b, size_t t_p4b, size_t t_p5b,
+                           size_t t_p6b, size_t ntiles) {
+    return (((((t_h1b * ntiles + t_h2b) * ntiles + t_h3b) * ntiles + t_p4b) * ntiles + t_p5b) *
+              ntiles +
+            t_p6b);
+  }
+
+  bool done(uint64_t key) const { return done_.count(key) > 0; }
+
+  // the tasks skipped by screening before the restart and the sum of their bounds (rank 0 only)
+  std::pair<double, double> screened() const { return screened_; }
+
+  // the task is finished or screened; its energy is in energy_l once the pipeline is drained
+  void complete(uint64_t key) {
+    if(enabled()) completed_.push_back(key);
+  }
+
+  // this rank claimed the task counter value; everything it claimed before is finished
+  void claimed(int64_t counter) { frontier_ = counter; }
+
+  int64_t counter_start() const { return start_; }
+
+  bool due() const {
+    return enabled() && std::chrono::steady_clock::now() - last_ >= std::chrono::seconds(interval_);
+  }
+
+  // energies and screening counts must include every task passed to complete()
+  void write(double energy1, double energy2, double skipped = 0, double error = 0) {
+    record rec{epoch_,  nranks_, engine_, tiling_, signature_, frontier_, energy1,
+               energy2, skipped, error,   completed_};
+    const std::string tmp = file(rank_) + ".tmp";
+    {
+      std::ofstream out(tmp);
+      out << std::setprecision(17) << "ccsd_t_checkpoint " << rec.epoch << " " << rec.nranks << " "
+          << rec.engine << " " << rec.tiling << " " << rec.signature << " " << rec.frontier << "\n"
+          << rec.energy1 << " " << rec.energy2 << " " << rec.skipped << " " << rec.error << "\n"
+          << rec.tasks.size() << "\n";
+      for(auto t: rec.tasks) out << t << "\n";
+    }
+    std::filesystem::rename(tmp, file(rank_));
+    last_ = std::chrono::steady_clock::now();
+  }
+
+  // collective. the (T) energies are final, the checkpoint files are no longer needed
+  void finalize() {
+    if(!enabled()) return;
+    MPI_Barrier(comm_);
+    std::filesystem::remove(file(rank_));
+    done_.clear();
+    completed_.clear();
+  }
+
+private:
+  struct record {
+    int64_t               epoch;
+    int                   nranks;
+    std::string           engine, tiling;
+    std::string           signature;
+    int64_t               frontier;
+    double                energy1, energy2;
+    double                skipped, error; // screened tasks and the sum of their bounds
+    std::vector<uint64_t> tasks;
+  };
+
+  std::string file(int rank) const { return prefix_ + "." + std::to_string(rank); }
+
+  // the checkpoint files of any rank, <prefix>.<rank>
+  std::vector<std::string> files() const {
+    namespace fs = std::filesystem;
+    std::vector<std::string> names;
+    const fs::path           dir  = fs::path(prefix_).parent_path();
+    const std::string        base = fs::path(prefix_).filename().string() + ".";
+    if(!fs::is_directory(dir.empty() ? "." : dir)) return names;
+    for(auto& entry: fs::directory_iterator(dir.empty() ? "." : dir)) {
+      const std::string name = entry.path().filename().string();
+      if(name.size() > base.size() && name.compare(0, base.size(), base) == 0 &&
+         name.find_first_not_of("0123456789", base.size()) == std::string::npos)
+        names.push_back(entry.path().string());
+    }
+    return names;
+  }
+
+  static bool read(const std::string& name, record& rec) {
+    std::ifstream in(name);
+    std::string   magic;
+    size_t        ntasks = 0;
+    if(!(in >> magic >> rec.epoch >> rec.nranks >> rec.engine >> rec.tiling >> rec.signature >>
+         rec.frontier >> rec.energy1 >> rec.energy2 >> rec.skipped >> rec.error >> ntasks) ||
+       magic != "ccsd_t_checkpoint")
+      return false;
+    rec.tasks.resize(ntasks);
+    for(auto& t: rec.tasks) in >> t;
+    return bool(in);
+  }
+
+  MPI_Comm                              comm_     = MPI_COMM_NULL;
+  std::string                           prefix_;
+  std::string                           engine_;
+  std::string                           tiling_;
+  std::string                           signature_;
+  int                                   interval_ = 0;
+  int                                   rank_     = 0;
+  int                                   nranks_   = 1;
+  int64_t                               epoch_    = 0;
+  int64_t                               start_    = 0;
+  int64_t                               frontier_ = 0;
+  std::pair<double, double>             screened_;
+  std::unordered_set<uint64_t>          done_;
+  std::vector<uint64_t>                 completed_;
+  std::chrono::steady_clock::time_point last_;
+};
+
+extern ccsd_t_checkpoint ccsdt_checkpoint;
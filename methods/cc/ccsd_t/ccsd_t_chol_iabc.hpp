@@ -0,0 +1,183 @@
+#pragma once
+
+#include "tamm/tamm.hpp"
+
+#include <cmath>
+#include <memory>
+#include <mpi.h>
+#include <vector>
+
+//
+//  v2iabc blocks built on demand from the Cholesky vectors L (retiled to the (T) MO space), so
+//  the O*V^3 iabc tensor is never allocated:
+//
+//    v2iabc(h,p1,p2,p3) = sum_Q L(h,p2,Q) L(p1,p3,Q) - L(h,p3,Q) L(p1,p2,Q)
+//
+//  each term is one GEMM over Q of two tile-pair slices L(x,y,:), which are kept in an LRU cache.
+//  fetch() reads the slices and build() does the GEMMs, so that threads can build blocks at the
+//  same time with their own scratch. the finished blocks go through the (T) block caches like
+//  any fetched block.
+//
+class ccsd_t_chol_iabc {
+public:
+  bool enabled() const { return (bool) slices_; }
+
+  // chol has to stay allocated while enabled; k_range are the (T) MO tile sizes
+  void init(Tensor<double> chol, size_t noab, const std::vector<size_t>& k_range,
+            size_t cache_size) {
+    chol_  = chol;
+    noab_  = noab;
+    range_ = k_range;
+    nchol_ = 0;
+    c_offset_.clear();
+    for(auto x: chol.tiled_index_spaces()[2].input_tile_sizes()) {
+      c_offset_.push_back(nchol_);
+      nchol_ += x;
+    }
+    slices_   = std::make_unique<LRUCache<Index, std::vector<double>>>(cache_size);
+    generated = 0;
+  }
+
+  void finalize() { slices_.reset(); }
+
+  // the L slices of a block, one set per thread
+  struct scratch {
+    std::vector<double> l[4]; // L(h,p2,:), L(p1,p3,:), L(h,p3,:), L(p1,p2,:)
+    std::vector<double> prod;
+    bool                term[2] = {false, false};
+  };
+
+  //
+  //  copies the slices of the v2iabc block bids (virtual tiles counted from the first virtual
+  //  tile) into s, reading the ones missing from the cache; returns the number of elements read.
+  //  not thread-safe, unlike build().
+  //
+  size_t fetch(const IndexVector& bids, scratch& s) {
+    const size_t h = bids[0], p1 = bids[1] + noab_, p2 = bids[2] + noab_, p3 = bids[3] + noab_;
+    const size_t pairs[4][2] = {{h, p2}, {p1, p3}, {h, p3}, {p1, p2}};
+    size_t       read        = 0;
+    generated++;
+    for(int t = 0; t < 2; t++) {
+      s.term[t] = true;
+      for(int k = 2 * t; k < 2 * t + 2 && s.term[t]; k++) {
+        const auto [x, y] = pairs[k];
+        const double* l   = slice(x, y, read);
+        if(l == nullptr) s.term[t] = false;
+        else s.l[k].assign(l, l + range_[x] * range_[y] * nchol_);
+      }
+    }
+    return read;
+  }
+
+  // the v2iabc block bids into buf, from the slices fetch() copied into s
+  template<typename T>
+  void build(const IndexVector& bids, scratch& s, std::vector<T>& buf) const {
+    const size_t h = bids[0], p1 = bids[1] + noab_, p2 = bids[2] + noab_, p3 = bids[3] + noab_;
+    const size_t nh = range_[h], n1 = range_[p1], n2 = range_[p2], n3 = range_[p3];
+    buf.assign(nh * n1 * n2 * n3, 0);
+
+    // (h p2|p1 p3) as [h][p2][p1][p3]
+    if(s.term[0]) {
+      product(s.l[0], s.l[1], nh * n2, n1 * n3, s.prod);
+      const double* c = s.prod.data();
+      for(size_t x = 0; x < nh; x++)
+        for(size_t b = 0; b < n2; b++)
+          for(size_t a = 0; a < n1; a++)
+            for(size_t d = 0; d < n3; d++) buf[((x * n1 + a) * n2 + b) * n3 + d] += *c++;
+    }
+    // (h p3|p1 p2) as [h][p3][p1][p2]
+    if(s.term[1]) {
+      product(s.l[2], s.l[3], nh * n3, n1 * n2, s.prod);
+      const double* c = s.prod.data();
+      for(size_t x = 0; x < nh; x++)
+        for(size_t d = 0; d < n3; d++)
+          for(size_t a = 0; a < n1; a++)
+            for(size_t b = 0; b < n2; b++) buf[((x * n1 + a) * n2 + b) * n3 + d] -= *c++;
+    }
+  }
+
+  // the v2iabc block bids into buf
+  template<typename T>
+  void get(const IndexVector& bids, std::vector<T>& buf) {
+    fetch(bids, scratch_);
+    build(bids, scratch_, buf);
+  }
+
+  //
+  //  collective. max-norm bounds of every v2iabc tile (occupied, then virtual tiles counted from
+  //  the first virtual tile), from |L(x,y,:) . L(z,w,:)| <= |L(x,y,:)| |L(z,w,:)|.
+  //
+  std::vector<double> tile_norms(ExecutionContext& ec, size_t nvab) {
+    const size_t        ntiles = range_.size();
+    std::vector<double> pair(ntiles * ntiles, 0);
+
+    // sum over the Cholesky tiles of the largest |L(x,y,:)|^2 of each block
+    auto block_norm = [&](const IndexVector& blockid) {
+      if(!chol_.is_non_zero(blockid)) return;
+      std::vector<double> buf(chol_.block_size(blockid));
+      chol_.get(blockid, buf);
+      const size_t nq = buf.size() / (range_[blockid[0]] * range_[blockid[1]]);
+      double       mx = 0;
+      for(size_t xy = 0; xy < buf.size() / nq; xy++) {
+        double s = 0;
+        for(size_t q = 0; q < nq; q++) s += buf[xy * nq + q] * buf[xy * nq + q];
+        mx = std::max(mx, s);
+      }
+      pair[blockid[0] * ntiles + blockid[1]] += mx;
+    };
+    block_for(ec, chol_(), block_norm);
+    MPI_Allreduce(MPI_IN_PLACE, pair.data(), pair.size(), MPI_DOUBLE, MPI_SUM, ec.pg().comm());
+    for(auto& x: pair) x = std::sqrt(x);
+
+    const size_t        o = noab_, v = nvab;
+    std::vector<double> norms(o * v * v * v);
+    for(size_t h = 0; h < o; h++)
+      for(size_t a = o; a < o + v; a++)
+        for(size_t b = o; b < o + v; b++)
+          for(size_t c = o; c < o + v; c++)
+            norms[((h * v + a - o) * v + b - o) * v + c - o] =
+              pair[h * ntiles + b] * pair[a * ntiles + c] +
+              pair[h * ntiles + c] * pair[a * ntiles + b];
+    return norms;
+  }
+
+  double generated = 0; // blocks built by this rank
+
+private:
+  // L(x,y,:) as [x][y][Q], or nullptr if the spins of x and y differ; adds what it reads to read
+  const double* slice(size_t x, size_t y, size_t& read) {
+    if(!chol_.is_non_zero({x, y, 0})) return nullptr;
+    auto [hit, value] = slices_->log_access({x, y});
+    if(!hit) {
+      const size_t nxy = range_[x] * range_[y];
+      value.assign(nxy * nchol_, 0);
+      std::vector<double> block;
+      for(size_t c = 0; c < c_offset_.size(); c++) {
+        block.resize(chol_.block_size({x, y, c}));
+        chol_.get({x, y, c}, block);
+        const size_t nq = block.size() / nxy;
+        for(size_t xy = 0; xy < nxy; xy++)
+          std::copy(&block[xy * nq], &block[xy * nq] + nq, &value[xy * nchol_ + c_offset_[c]]);
+      }
+      read += value.size();
+    }
+    return value.data();
+  }
+
+  // c = a b^T as [m][n], for slices a of m and b of n rows
+  void product(const std::vector<double>& a, const std::vector<double>& b, size_t m, size_t n,
+               std::vector<double>& c) const {
+    c.resize(m * n);
+    blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::Trans, m, n, nchol_, 1.0,
+               a.data(), nchol_, b.data(), nchol_, 0.0, c.data(), n);
+  }
+
+  Tensor<double>                                        chol_;
+  size_t                                                noab_  = 0;
+  size_t                                                nchol_ = 0;
+  std::vector<size_t>                                   range_, c_offset_;
+  std::unique_ptr<LRUCache<Index, std::vector<double>>> slices_;
+  scratch                                               scratch_;
+};
+
+extern ccsd_t_chol_iabc ccsdt_chol_iabc;
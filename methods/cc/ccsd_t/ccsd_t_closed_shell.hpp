@@ -0,0 +1,379 @@
+#pragma once
+
+#include "ccsd_t_checkpoint.hpp"
+#include "ccsd_t_common.hpp"
+#include "tamm/tamm.hpp"
+
+#include <array>
+#include <chrono>
+#include <tuple>
+#include <vector>
+
+//
+//  spin-adapted (T) for closed-shell references. everything is in spatial orbitals: the
+//  amplitudes are the t1(a,i) and t2(a,b,i,j) = t_ij^ab of the closed-shell CCSD and the
+//  integrals (ia|jb), (ia|jk) and (ia|bc) are built from the Cholesky vectors, so the spin-orbital
+//  t1/t2 and V2Tensors are never formed. with
+//
+//    W_ijk^abc = P [ sum_f (ia|bf) t_kj^cf - sum_m (ia|mj) t_mk^bc ]
+//    V_ijk^abc = (ia|jb) t_k^c + (ia|kc) t_j^b + (jb|kc) t_i^a
+//    Z_ijk^abc = 4 W^abc + W^bca + W^cab - 2 W^cba - 2 W^acb - 2 W^bac   (all at ijk)
+//
+//  where P sums the six simultaneous permutations of the pairs (ia),(jb),(kc), the energies are
+//  [T] = 1/3 sum W Z / D and (T) = 1/3 sum (W + V) Z / D, D = e_i + e_j + e_k - e_a - e_b - e_c.
+//
+//  a task is a triple of occupied tiles I >= J >= K and of virtual tiles A >= B >= C. the sum over
+//  abc of a triple of orbitals i,j,k is invariant under permutations of ijk, so only the sorted
+//  occupied tiles are visited, weighted by their multiplicity. W is built for every distinct
+//  ordering of (A,B,C), which keeps the abc permutations of Z within the task.
+//
+
+extern double ccsdt_cs_GetTime;
+extern double ccsd_t_data_per_rank;
+
+enum ccsd_t_cs_block { CCSDT_CS_T1, CCSDT_CS_T2, CCSDT_CS_OVOV, CCSDT_CS_OVOO, CCSDT_CS_OVVV };
+
+// closed-shell (T) inputs on the alpha tiles of the (T) MO space
+template<typename T>
+class ccsd_t_cs_inputs {
+public:
+  ccsd_t_cs_inputs(const TiledIndexSpace& MO) {
+    const int noab = MO("occ").num_tiles();
+    const int nvab = MO("virt").num_tiles();
+    const int noa  = MO("occ_alpha").num_tiles();
+    const int nva  = MO("virt_alpha").num_tiles();
+
+    o_alpha = {MO("occ"), range(noa)};
+    v_alpha = {MO("virt"), range(nva)};
+    o_beta  = {MO("occ"), range(noa, noab)};
+    v_beta  = {MO("virt"), range(nva, nvab)};
+
+    t1   = Tensor<T>{{v_alpha, o_alpha}, {1, 1}};
+    t2   = Tensor<T>{{v_alpha, v_beta, o_alpha, o_beta}, {2, 2}};
+    ovov = Tensor<T>{{o_alpha, v_alpha, o_alpha, v_alpha}, {2, 2}};
+    ovoo = Tensor<T>{{o_alpha, v_alpha, o_alpha, o_alpha}, {2, 2}};
+    ovvv = Tensor<T>{{o_alpha, v_alpha, v_alpha, v_alpha}, {2, 2}};
+  }
+
+  Tensor<T>& operator[](ccsd_t_cs_block id) {
+    switch(id) {
+      case CCSDT_CS_T1: return t1;
+      case CCSDT_CS_T2: return t2;
+      case CCSDT_CS_OVOV: return ovov;
+      case CCSDT_CS_OVOO: return ovoo;
+      default: return ovvv;
+    }
+  }
+
+  void   allocate(ExecutionContext& ec) { Tensor<T>::allocate(&ec, t1, t2, ovov, ovoo, ovvv); }
+  void   deallocate() { Tensor<T>::deallocate(t1, t2, ovov, ovoo, ovvv); }
+  double tensor_sizes() { return sum_tensor_sizes(t1, t2, ovov, ovoo, ovvv); }
+
+  TiledIndexSpace o_alpha, v_alpha, o_beta, v_beta;
+  Tensor<T>       t1, t2, ovov, ovoo, ovvv;
+};
+
+//
+//  fills the inputs from the closed-shell CCSD amplitudes (in the CCSD tiling) and the Cholesky
+//  vectors retiled to the (T) MO space.
+//
+template<typename T>
+void ccsd_t_cs_setup(ExecutionContext& ec, ccsd_t_cs_inputs<T>& inputs, Tensor<T> cholVpr,
+                     Tensor<T> t1_aa, Tensor<T> t2_abab, ExecutionHW ex_hw = ExecutionHW::CPU) {
+  TiledIndexSpace CI = cholVpr.tiled_index_spaces()[2];
+  auto [cind]        = CI.labels<1>("all");
+  auto [h1, h2, h3]  = inputs.o_alpha.labels<3>("all");
+  auto [p1, p2, p3]  = inputs.v_alpha.labels<3>("all");
+  Tensor<T>& ovov    = inputs.ovov;
+  Tensor<T>& ovoo    = inputs.ovoo;
+  Tensor<T>& ovvv    = inputs.ovvv;
+
+  // clang-format off
+  Scheduler{ec}
+    ( ovov(h1,p1,h2,p2)  =  cholVpr(h1,p1,cind) * cholVpr(h2,p2,cind) )
+    ( ovoo(h1,p1,h2,h3)  =  cholVpr(h1,p1,cind) * cholVpr(h2,h3,cind) )
+    ( ovvv(h1,p1,p2,p3)  =  cholVpr(h1,p1,cind) * cholVpr(p2,p3,cind) )
+    .execute(ex_hw);
+  // clang-format on
+
+  retile_tamm_tensor(t1_aa, inputs.t1);
+  retile_tamm_tensor(t2_abab, inputs.t2);
+}
+
+// per-rank buffers of the closed-shell tasks, sized by the largest tile
+template<typename T>
+struct ccsd_t_cs_workspace {
+  std::array<std::vector<T>, 6> w;    // W of each ordering of the virtual tiles
+  std::vector<T>                r;    // product of one term, before it is permuted into W
+  std::vector<T>                a, b; // operand blocks
+  std::array<std::vector<T>, 6> v;    // ovov and t1 blocks of V
+};
+
+//
+//  runs one task, adding factor * [T] and factor * (T) to energy1 and energy2. fetch(id, bids,
+//  buf) reads a block of the given input into buf. o_evl/v_evl are the alpha orbital energies,
+//  o_offset/v_offset the offset of each tile in them. returns the flops of the contractions.
+//
+template<typename T, typename Fetch>
+long double ccsd_t_cs_task(const std::array<size_t, 3>& occ, const std::array<size_t, 3>& vir,
+                           T factor, const std::vector<size_t>& o_range,
+                           const std::vector<size_t>& v_range, const std::vector<size_t>& o_offset,
+                           const std::vector<size_t>& v_offset, const std::vector<T>& o_evl,
+                           const std::vector<T>& v_evl, Fetch&& fetch, ccsd_t_cs_workspace<T>& ws,
+                           T& energy1, T& energy2) {
+  // the six permutations of three positions; Z has the coefficients zcoef
+  static constexpr int perms[6][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1},
+                                      {2, 1, 0}, {0, 2, 1}, {1, 0, 2}};
+  static constexpr T   zcoef[6]    = {4, 1, 1, -2, -2, -2};
+
+  const size_t noa = o_range.size();
+  const size_t nva = v_range.size();
+
+  auto bids = [](auto... tiles) { return IndexVector{static_cast<Index>(tiles)...}; };
+
+  std::vector<std::array<size_t, 3>> orders;
+  auto find_order = [&](const std::array<size_t, 3>& o) {
+    return std::find(orders.begin(), orders.end(), o) - orders.begin();
+  };
+  for(auto& p: perms) {
+    std::array<size_t, 3> o = {vir[p[0]], vir[p[1]], vir[p[2]]};
+    if(find_order(o) == (long) orders.size()) orders.push_back(o);
+  }
+
+  const size_t n_o[3] = {o_range[occ[0]], o_range[occ[1]], o_range[occ[2]]};
+  const size_t nv3    = v_range[vir[0]] * v_range[vir[1]] * v_range[vir[2]];
+  const size_t so[3]  = {n_o[1] * n_o[2] * nv3, n_o[2] * nv3, nv3};
+  const size_t size_w = n_o[0] * n_o[1] * n_o[2] * nv3;
+
+  long double flops = 0;
+
+  // W of the ordering q, as W[i][j][k][a][b][c]
+  for(size_t q = 0; q < orders.size(); q++) {
+    const auto&  ord    = orders[q];
+    const size_t n_v[3] = {v_range[ord[0]], v_range[ord[1]], v_range[ord[2]]};
+    const size_t sv[3]  = {n_v[1] * n_v[2], n_v[2], 1};
+    std::vector<T>& W   = ws.w[q];
+    W.assign(size_w, 0);
+
+    for(auto& p: perms) {
+      const int    x = p[0], y = p[1], z = p[2];
+      const size_t nxo = n_o[x], nxv = n_v[x], nyo = n_o[y], nyv = n_v[y], nzo = n_o[z],
+                   nzv = n_v[z];
+
+      // sum_f (ia|bf) t_kj^cf, as r[xo,xv,yv][zv,yo,zo]
+      size_t m = nxo * nxv * nyv, n = nzv * nyo * nzo;
+      ws.r.assign(m * n, 0);
+      for(size_t tf = 0; tf < nva; tf++) {
+        const size_t nf = v_range[tf];
+        fetch(CCSDT_CS_OVVV, bids(occ[x], ord[x], ord[y], tf), ws.a);
+        fetch(CCSDT_CS_T2, bids(tf, ord[z], occ[y], occ[z]), ws.b);
+        blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::NoTrans, m, n, nf, 1.0,
+                   ws.a.data(), nf, ws.b.data(), n, 1.0, ws.r.data(), n);
+        flops += 2.0L * m * n * nf;
+      }
+      const T* r = ws.r.data();
+      for(size_t xo = 0; xo < nxo; xo++)
+        for(size_t xv = 0; xv < nxv; xv++)
+          for(size_t yv = 0; yv < nyv; yv++)
+            for(size_t zv = 0; zv < nzv; zv++)
+              for(size_t yo = 0; yo < nyo; yo++) {
+                T* w = &W[xo * so[x] + yo * so[y] + xv * sv[x] + yv * sv[y] + zv * sv[z]];
+                for(size_t zo = 0; zo < nzo; zo++) w[zo * so[z]] += *r++;
+              }
+
+      // - sum_m (ia|jm) t_km^cb, as r[xo,xv,yo][zv,yv,zo]
+      m = nxo * nxv * nyo;
+      n = nzv * nyv * nzo;
+      ws.r.assign(m * n, 0);
+      for(size_t tm = 0; tm < noa; tm++) {
+        const size_t nm = o_range[tm];
+        fetch(CCSDT_CS_OVOO, bids(occ[x], ord[x], occ[y], tm), ws.a);
+        fetch(CCSDT_CS_T2, bids(ord[z], ord[y], occ[z], tm), ws.b);
+        blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::Trans, m, n, nm, 1.0,
+                   ws.a.data(), nm, ws.b.data(), nm, 1.0, ws.r.data(), n);
+        flops += 2.0L * m * n * nm;
+      }
+      r = ws.r.data();
+      for(size_t xo = 0; xo < nxo; xo++)
+        for(size_t xv = 0; xv < nxv; xv++)
+          for(size_t yo = 0; yo < nyo; yo++)
+            for(size_t zv = 0; zv < nzv; zv++)
+              for(size_t yv = 0; yv < nyv; yv++) {
+                T* w = &W[xo * so[x] + yo * so[y] + xv * sv[x] + yv * sv[y] + zv * sv[z]];
+                for(size_t zo = 0; zo < nzo; zo++) w[zo * so[z]] -= *r++;
+              }
+    }
+  }
+
+  // energies; Z of the ordering q reads W of the orderings its virtual tiles are permuted into
+  T e4 = 0, e5 = 0;
+  for(size_t q = 0; q < orders.size(); q++) {
+    const auto&  ord    = orders[q];
+    const size_t n_v[3] = {v_range[ord[0]], v_range[ord[1]], v_range[ord[2]]};
+
+    const T* zw[6];
+    size_t   zs[6][3];
+    for(int p = 0; p < 6; p++) {
+      const int* pp = perms[p];
+      zw[p]         = ws.w[find_order({ord[pp[0]], ord[pp[1]], ord[pp[2]]})].data();
+      const size_t stride[3] = {n_v[pp[1]] * n_v[pp[2]], n_v[pp[2]], 1};
+      for(int d = 0; d < 3; d++) zs[p][pp[d]] = stride[d];
+    }
+
+    fetch(CCSDT_CS_OVOV, bids(occ[0], ord[0], occ[1], ord[1]), ws.v[0]);
+    fetch(CCSDT_CS_T1, bids(ord[2], occ[2]), ws.v[1]);
+    fetch(CCSDT_CS_OVOV, bids(occ[0], ord[0], occ[2], ord[2]), ws.v[2]);
+    fetch(CCSDT_CS_T1, bids(ord[1], occ[1]), ws.v[3]);
+    fetch(CCSDT_CS_OVOV, bids(occ[1], ord[1], occ[2], ord[2]), ws.v[4]);
+    fetch(CCSDT_CS_T1, bids(ord[0], occ[0]), ws.v[5]);
+    const T *ovov_ij = ws.v[0].data(), *t1_k = ws.v[1].data(), *ovov_ik = ws.v[2].data(),
+            *t1_j = ws.v[3].data(), *ovov_jk = ws.v[4].data(), *t1_i = ws.v[5].data();
+
+    for(size_t i = 0; i < n_o[0]; i++)
+      for(size_t j = 0; j < n_o[1]; j++)
+        for(size_t k = 0; k < n_o[2]; k++) {
+          const size_t base  = i * so[0] + j * so[1] + k * so[2];
+          const T      e_ijk = o_evl[o_offset[occ[0]] + i] + o_evl[o_offset[occ[1]] + j] +
+                          o_evl[o_offset[occ[2]] + k];
+          const T* w = &ws.w[q][base];
+          for(size_t a = 0; a < n_v[0]; a++)
+            for(size_t b = 0; b < n_v[1]; b++)
+              for(size_t c = 0; c < n_v[2]; c++, w++) {
+                T zabc = 0;
+                for(int p = 0; p < 6; p++)
+                  zabc += zcoef[p] * zw[p][base + a * zs[p][0] + b * zs[p][1] + c * zs[p][2]];
+                const T vabc =
+                  ovov_ij[((i * n_v[0] + a) * n_o[1] + j) * n_v[1] + b] * t1_k[c * n_o[2] + k] +
+                  ovov_ik[((i * n_v[0] + a) * n_o[2] + k) * n_v[2] + c] * t1_j[b * n_o[1] + j] +
+                  ovov_jk[((j * n_v[1] + b) * n_o[2] + k) * n_v[2] + c] * t1_i[a * n_o[0] + i];
+                const T d = e_ijk - v_evl[v_offset[ord[0]] + a] - v_evl[v_offset[ord[1]] + b] -
+                            v_evl[v_offset[ord[2]] + c];
+                e4 += (*w) * zabc / d;
+                e5 += ((*w) + vabc) * zabc / d;
+              }
+        }
+  }
+
+  energy1 += factor * e4;
+  energy2 += factor * e5;
+  return flops;
+}
+
+//
+//  closed-shell (T) over all tasks, handed out with an atomic counter. returns the [T] and (T)
+//  energies of this rank and the (T) times; num_ops is set to the flops of this rank.
+//
+template<typename T>
+std::tuple<T, T, double, double>
+ccsd_t_cs_driver(SystemData& sys_data, ExecutionContext& ec, const TiledIndexSpace& MO,
+                 ccsd_t_cs_inputs<T>& inputs, std::vector<T>& k_evl_sorted, double& num_ops) {
+  auto rank     = ec.pg().rank().value();
+  bool nodezero = rank == 0;
+
+  const size_t noab = MO("occ").num_tiles();
+  const size_t noa  = MO("occ_alpha").num_tiles();
+  const size_t nva  = MO("virt_alpha").num_tiles();
+
+  // tile sizes and alpha orbital energies
+  auto                mo_tiles = MO.input_tile_sizes();
+  std::vector<size_t> o_range, v_range, o_offset, v_offset;
+  std::vector<T>      o_evl, v_evl;
+  size_t              sum = 0;
+  for(size_t t = 0; t < mo_tiles.size(); t++) {
+    if(t < noa || (t >= noab && t < noab + nva)) {
+      auto& range  = t < noa ? o_range : v_range;
+      auto& offset = t < noa ? o_offset : v_offset;
+      auto& evl    = t < noa ? o_evl : v_evl;
+      range.push_back(mo_tiles[t]);
+      offset.push_back(evl.size());
+      evl.insert(evl.end(), k_evl_sorted.begin() + sum, k_evl_sorted.begin() + sum + mo_tiles[t]);
+    }
+    sum += mo_tiles[t];
+  }
+
+  // occupied tiles I >= J >= K, each visited with the number of its distinct orderings
+  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>> list_tasks;
+  for(size_t t_i = 0; t_i < noa; t_i++)
+    for(size_t t_j = 0; t_j <= t_i; t_j++)
+      for(size_t t_k = 0; t_k <= t_j; t_k++)
+        for(size_t t_a = 0; t_a < nva; t_a++)
+          for(size_t t_b = 0; t_b <= t_a; t_b++)
+            for(size_t t_c = 0; t_c <= t_b; t_c++) {
+              T factor = 6.0;
+              if(t_i == t_j && t_j == t_k) factor = 1.0;
+              else if(t_i == t_j || t_j == t_k) factor = 3.0;
+              list_tasks.push_back(std::make_tuple(t_i, t_j, t_k, t_a, t_b, t_c, factor / 3.0));
+            }
+  const int64_t ntasks = list_tasks.size();
+
+  if(nodezero)
+    std::cout << "closed-shell (T) over spatial orbitals: noa,nva = " << noa << ", " << nva
+              << " (" << ntasks << " tasks)" << std::endl
+              << std::endl;
+
+  std::vector<T> energy_l(2, 0.0);
+  auto [restart_energy1, restart_energy2] = ccsdt_checkpoint.restore(
+    "closed-shell",
+    ccsd_t_checkpoint::tiling(noab, std::vector<size_t>(mo_tiles.begin(), mo_tiles.end())),
+    "loop");
+  energy_l[0] += restart_energy1;
+  energy_l[1] += restart_energy2;
+
+  LRUCache<Index, std::vector<T>> cache{
+    (size_t) sys_data.options_map.ccsd_options.cache_size * (noa + nva)};
+  auto fetch = [&](ccsd_t_cs_block id, const IndexVector& bids, std::vector<T>& buf) {
+    IndexVector key{(Index) id};
+    key.insert(key.end(), bids.begin(), bids.end());
+    auto [hit, value] = cache.log_access(key);
+    if(hit) {
+      buf = value;
+      return;
+    }
+    Tensor<T>& tensor = inputs[id];
+    buf.resize(tensor.block_size(bids));
+    {
+      TimerGuard tg_total{&ccsdt_cs_GetTime};
+      ccsd_t_data_per_rank += buf.size() * sizeof(T);
+      tensor.get(bids, buf);
+    }
+    value = buf;
+  };
+
+  ccsd_t_cs_workspace<T> ws;
+  long double            flops = 0;
+
+  AtomicCounter* ac = new AtomicCounterGA(ec.pg(), 1);
+  ac->allocate(ccsdt_checkpoint.counter_start());
+
+  auto cc_t1 = std::chrono::high_resolution_clock::now();
+
+  for(int64_t next = ac->fetch_add(0, 1); next < ntasks; next = ac->fetch_add(0, 1)) {
+    ccsdt_checkpoint.claimed(next);
+    auto [t_i, t_j, t_k, t_a, t_b, t_c, factor] = list_tasks[next];
+    const uint64_t task_key =
+      ccsd_t_checkpoint::task_key(t_i, t_j, t_k, t_a, t_b, t_c, noa + nva);
+    if(ccsdt_checkpoint.done(task_key)) continue;
+
+    flops += ccsd_t_cs_task<T>({t_i, t_j, t_k}, {t_a, t_b, t_c}, factor, o_range, v_range,
+                               o_offset, v_offset, o_evl, v_evl, fetch, ws, energy_l[0],
+                               energy_l[1]);
+
+    ccsdt_checkpoint.complete(task_key);
+    if(ccsdt_checkpoint.due()) ccsdt_checkpoint.write(energy_l[0], energy_l[1]);
+  }
+
+  auto cc_t2 = std::chrono::high_resolution_clock::now();
+  auto ccsd_t_time =
+    std::chrono::duration_cast<std::chrono::duration<double>>((cc_t2 - cc_t1)).count();
+
+  ec.pg().barrier();
+  cc_t2 = std::chrono::high_resolution_clock::now();
+  auto total_t_time =
+    std::chrono::duration_cast<std::chrono::duration<double>>((cc_t2 - cc_t1)).count();
+
+  ac->deallocate();
+  delete ac;
+
+  num_ops = flops;
+  return std::make_tuple(energy_l[0], energy_l[1], ccsd_t_time, total_t_time);
+}
@@ -52,7 +52,8 @@ typedef long Integer;
 #define DIV_UB(x, y) ((x) / (y) + ((x) % (y) ? 1 : 0))
 #define TG_MIN(x, y) ((x) < (y) ? (x) : (y))
 
-void        initMemModule();
+// use_huge_pages backs the host blocks of 2 MB and more with transparent huge pages (CPU builds)
+void        initMemModule(bool use_huge_pages = false);
 std::string check_memory_req(const int cc_t_ts, const int nbf);
 
 void* getGpuMem(size_t bytes);
@@ -60,6 +61,15 @@ void* getHostMem(size_t bytes);
 void  freeHostMem(void* p);
 void  freeGpuMem(void* p);
 
+// host pool counters of this rank since the start, in calls and bytes
+struct hostMemStats_t {
+  double allocations;
+  double resurrections; // served from the free lists
+  double peak_live;
+  double peak_reserved;
+};
+hostMemStats_t getHostMemStats();
+
 void finalizeMemModule();
 
 struct hostEnergyReduceData_t {
@@ -5,10 +5,22 @@
 #else
 #include "ccsd_t_all_fused_cpu.hpp"
 #endif
+#include "ccsd_t_checkpoint.hpp"
 #include "ccsd_t_common.hpp"
+#include "ccsd_t_screening.hpp"
+#include "ccsd_t_staging.hpp"
+#include "ccsd_t_task_order.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <numeric>
+#include <omp.h>
+#include <sstream>
 
 void finalizememmodule();
 
+extern double ccsdt_task_fetches;
+
 /**
  *  to check if target NVIDIA GPUs can support the fully-fused kernel
  *  based on 3rd gen. tensor cores or not.
@@ -47,6 +59,45 @@ int checkCudaKernelCompatible(bool r0) {
 }
 #endif
 
+//
+//  "list of tasks": (t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor) in p4,p5,p6,h1,h2,h3 order
+//
+template<typename T>
+std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>>
+ccsd_t_fused_task_list(const Index noab, const Index nvab, std::vector<int>& k_spin,
+                       bool is_restricted) {
+  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>> list_tasks;
+  for(size_t t_p4b = noab; t_p4b < noab + nvab; t_p4b++) {
+    for(size_t t_p5b = t_p4b; t_p5b < noab + nvab; t_p5b++) {
+      for(size_t t_p6b = t_p5b; t_p6b < noab + nvab; t_p6b++) {
+        for(size_t t_h1b = 0; t_h1b < noab; t_h1b++) {
+          for(size_t t_h2b = t_h1b; t_h2b < noab; t_h2b++) {
+            for(size_t t_h3b = t_h2b; t_h3b < noab; t_h3b++) {
+              if((k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b]) ==
+                 (k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b])) {
+                if((!is_restricted) || (k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b] +
+                                        k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b]) <= 8) {
+                  T factor = 1.0;
+                  if(is_restricted) factor = 2.0;
+                  if((t_p4b == t_p5b) && (t_p5b == t_p6b)) { factor /= 6.0; }
+                  else if((t_p4b == t_p5b) || (t_p5b == t_p6b)) { factor /= 2.0; }
+
+                  if((t_h1b == t_h2b) && (t_h2b == t_h3b)) { factor /= 6.0; }
+                  else if((t_h1b == t_h2b) || (t_h2b == t_h3b)) { factor /= 2.0; }
+
+                  list_tasks.push_back(
+                    std::make_tuple(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor));
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return list_tasks;
+}
+
 //
 template<typename T>
 std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
@@ -68,6 +119,10 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
 #else
   if(nodezero) cout << "Enabled the fully-fused kernel based on FP64" << endl;
 #endif
+#elif !defined(USE_HIP) && !defined(USE_DPCPP)
+  if(nodezero)
+    cout << "Enabled the register-blocked CPU kernels (" << ccsd_t_simd<double>::name << ")"
+         << endl;
 #endif
 
   Index noab = MO("occ").num_tiles();
@@ -127,10 +182,84 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
   std::shared_ptr<hostEnergyReduceData_t> reduceData = std::make_shared<hostEnergyReduceData_t>();
 #endif
 
+  const std::string task_schedule = sys_data.options_map.ccsd_options.ccsdt_task_schedule;
+  const std::string task_order    = sys_data.options_map.ccsd_options.ccsdt_task_order;
+  const bool        task_list     = task_schedule == "guided" || task_order != "loop";
+  const int64_t     nranks        = ec.pg().size().value();
+
+  //
+  //  with a task list, the tasks are sorted by decreasing number of operations or put in a
+  //  locality-aware order, and handed out in chunks that each cover about 1/(2 nranks) of the
+  //  remaining operations (guided self-scheduling). a locality-aware order replaces the cost
+  //  sort: consecutive tasks of a chunk share most of their blocks.
+  //
+  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>> list_tasks;
+  std::vector<size_t>                                                         order;
+  std::vector<long double>                                                    remaining_ops;
+
+  // names the task counter's index space, see ccsd_t_checkpoint
+  std::string order_name = seq_h3b ? "loop-h14256" : "loop-p456123";
+  if(task_list) {
+    list_tasks    = ccsd_t_fused_task_list<T>(noab, nvab, k_spin, is_restricted);
+    auto task_ops = ccsd_t_fully_fused_task_ops(ec, is_restricted, list_tasks, noab, nvab,
+                                                k_spin, k_range, k_evl_sorted);
+
+    order.resize(list_tasks.size());
+    if(task_order == "loop") {
+      order_name = "list-cost";
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [&](size_t a, size_t b) { return task_ops[a] > task_ops[b]; });
+    }
+    else {
+      order_name = ccsd_t_locality_order(ec, task_order, is_restricted, list_tasks, task_ops,
+                                         noab, nvab, k_spin, k_range, k_evl_sorted,
+                                         sys_data.options_map.ccsd_options.cache_size);
+      order      = ccsd_t_task_order(order_name, noab, list_tasks);
+      order_name = "list-" + order_name;
+    }
+    remaining_ops.resize(order.size() + 1, 0);
+    for(int64_t i = order.size() - 1; i >= 0; i--)
+      remaining_ops[i] = remaining_ops[i + 1] + task_ops[order[i]];
+  }
+  const int64_t ntasks = list_tasks.size();
+
+  // tasks finished or screened by an earlier, interrupted run are skipped, their energies and
+  // screening counts added once; a run screened at another threshold starts over
+  std::ostringstream engine;
+  engine << "tiled";
+  if(ccsdt_screening.enabled())
+    engine << "-screened-" << std::setprecision(17) << ccsdt_screening.threshold();
+  auto [restart_energy1, restart_energy2] =
+    ccsdt_checkpoint.restore(engine.str(), ccsd_t_checkpoint::tiling(noab, k_range), order_name);
+  energy_l[0] += restart_energy1;
+  energy_l[1] += restart_energy2;
+  auto [restart_skipped, restart_error] = ccsdt_checkpoint.screened();
+  ccsdt_screening.skipped += restart_skipped;
+  ccsdt_screening.error += restart_error;
+
+  //
+  //  the guided chunks are fixed before the run, each sized from the operations left at its own
+  //  first task, and the counter hands out chunk numbers. a rank could not size its chunk from
+  //  the counter value it is about to claim. checkpoints keep task indices; a restart resumes at
+  //  the chunk holding the restored one.
+  //
+  std::vector<int64_t> chunk_first;
+  int64_t              counter_start = ccsdt_checkpoint.counter_start();
+  if(task_list) {
+    for(int64_t first = 0; first < ntasks;
+        first += ccsd_t_guided_chunk(remaining_ops, first, nranks))
+      chunk_first.push_back(first);
+    chunk_first.push_back(ntasks);
+    counter_start = std::upper_bound(chunk_first.begin(), chunk_first.end(), counter_start) -
+                    chunk_first.begin() - 1;
+  }
+
   AtomicCounter* ac = new AtomicCounterGA(ec.pg(), 1);
-  ac->allocate(0);
+  ac->allocate(counter_start);
   int64_t taskcount = 0;
-  int64_t next      = ac->fetch_add(0, 1);
+  int64_t next      = task_list ? 0 : ac->fetch_add(0, 1);
+  if(!task_list) ccsdt_checkpoint.claimed(next);
 
   auto cc_t1 = std::chrono::high_resolution_clock::now();
 
@@ -155,12 +284,17 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
   size_t size_T_d2_t2 = max_d2_kernels_pertask * (max_pdim * max_pdim) * (max_hdim * max_hdim);
   size_t size_T_d2_v2 = max_d2_kernels_pertask * (max_pdim * max_pdim * max_pdim) * (max_hdim);
 
-  T* df_host_pinned_s1_t1 = (T*) getHostMem(sizeof(T) * size_T_s1_t1);
-  T* df_host_pinned_s1_v2 = (T*) getHostMem(sizeof(T) * size_T_s1_v2);
-  T* df_host_pinned_d1_t2 = (T*) getHostMem(sizeof(T) * size_T_d1_t2);
-  T* df_host_pinned_d1_v2 = (T*) getHostMem(sizeof(T) * size_T_d1_v2);
-  T* df_host_pinned_d2_t2 = (T*) getHostMem(sizeof(T) * size_T_d2_t2);
-  T* df_host_pinned_d2_v2 = (T*) getHostMem(sizeof(T) * size_T_d2_v2);
+  // in mixed precision (CPU only), these FP64 buffers just hold the tasks re-run in FP64
+  const double fp32_sample = sys_data.options_map.ccsd_options.ccsdt_fp32_sample;
+  const bool   ccsdt_mixed = sys_data.options_map.ccsd_options.ccsdt_precision == "mixed";
+  const size_t fp64_bufs   = !ccsdt_mixed || fp32_sample > 0 ? 1 : 0;
+
+  T* df_host_pinned_s1_t1 = (T*) getHostMem(sizeof(T) * size_T_s1_t1 * fp64_bufs);
+  T* df_host_pinned_s1_v2 = (T*) getHostMem(sizeof(T) * size_T_s1_v2 * fp64_bufs);
+  T* df_host_pinned_d1_t2 = (T*) getHostMem(sizeof(T) * size_T_d1_t2 * fp64_bufs);
+  T* df_host_pinned_d1_v2 = (T*) getHostMem(sizeof(T) * size_T_d1_v2 * fp64_bufs);
+  T* df_host_pinned_d2_t2 = (T*) getHostMem(sizeof(T) * size_T_d2_t2 * fp64_bufs);
+  T* df_host_pinned_d2_v2 = (T*) getHostMem(sizeof(T) * size_T_d2_v2 * fp64_bufs);
 
   //
   int* df_simple_s1_size = (int*) getHostMem(sizeof(int) * (6));
@@ -173,6 +307,145 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
   int* host_d2_size      = (int*) getHostMem(sizeof(int) * (nvab));
   int* df_simple_d2_size = (int*) getHostMem(sizeof(int) * (7 * nvab));
   int* df_simple_d2_exec = (int*) getHostMem(sizeof(int) * (9 * nvab));
+
+  // staging runs on the idle cores between kernels, unless it overlaps them through prefetch
+  ccsdt_stage_threads =
+    sys_data.options_map.ccsd_options.ccsdt_prefetch ? 1 : omp_get_max_threads();
+
+#if !defined(USE_CUDA) && !defined(USE_HIP) && !defined(USE_DPCPP)
+  //
+  //  t3 buffers and packing panels reused by every task of this rank. in mixed precision, the
+  //  tasks run in FP32 and only the sampled ones also need the FP64 t3.
+  //
+  const size_t                 fp32_bufs = ccsdt_mixed ? 1 : 0;
+  ccsd_t_cpu_workspace<double> cpu_ws;
+  ccsd_t_cpu_workspace<float>  cpu_ws_fp32;
+  ccsd_t_cpu_t3_arena<double>  t3_arena(max_hdim * fp64_bufs, max_pdim * fp64_bufs);
+  ccsd_t_cpu_t3_arena<float>   t3_arena_fp32(max_hdim * fp32_bufs, max_pdim * fp32_bufs);
+  if(nodezero && ccsdt_mixed)
+    cout << "Enabled the mixed-precision (T) kernels, " << fp32_sample * 100
+         << "% of the tasks re-run in FP64" << endl;
+
+  ccsd_t_cpu_buffers<T> cpu_bufs = {
+    df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2, df_host_pinned_d1_v2,
+    df_host_pinned_d2_t2, df_host_pinned_d2_v2, host_d1_size,         host_d2_size,
+    df_simple_s1_size,    df_simple_d1_size,    df_simple_d2_size,    df_simple_s1_exec,
+    df_simple_d1_exec,    df_simple_d2_exec};
+
+  // second buffer set, filled for the next task while the current one is computed
+  const bool            ccsdt_prefetch = sys_data.options_map.ccsd_options.ccsdt_prefetch;
+  ccsd_t_cpu_buffers<T> cpu_bufs_next  = cpu_bufs;
+  if(ccsdt_prefetch && !ccsdt_mixed)
+    cpu_bufs_next = ccsd_t_cpu_alloc_buffers<T>(noab, nvab, size_T_s1_t1, size_T_s1_v2,
+                                                size_T_d1_t2, size_T_d1_v2, size_T_d2_t2,
+                                                size_T_d2_v2);
+  if(nodezero && ccsdt_prefetch) cout << "Enabled the (T) input block prefetch" << endl;
+
+  //
+  //  in mixed precision, t1, t2 and v2 are copied to FP32 once, and the tasks are staged from the
+  //  copies through FP32 caches and buffers, so every get, cache and copy moves half the bytes.
+  //  the blocks of a sampled task are staged again from the FP64 tensors into cpu_bufs, through
+  //  the FP64 caches.
+  //
+  Tensor<float>             d_t1_fp32, d_t2_fp32;
+  V2Tensors<float>          d_v2_fp32(d_v2.get_blocks());
+  std::vector<float>        k_evl_sorted_fp32(k_evl_sorted.begin(), k_evl_sorted.end());
+  ccsd_t_cpu_buffers<float> cpu_bufs_fp32[2] = {};
+  if(ccsdt_mixed) {
+    d_t1_fp32 = Tensor<float>{{MO("virt"), MO("occ")}, {1, 1}};
+    d_t2_fp32 = Tensor<float>{{MO("virt"), MO("virt"), MO("occ"), MO("occ")}, {2, 2}};
+    Tensor<float>::allocate(&ec, d_t1_fp32, d_t2_fp32);
+    d_v2_fp32.allocate(ec, MO);
+    ccsd_t_cpu_convert(ec, d_t1, d_t1_fp32);
+    ccsd_t_cpu_convert(ec, d_t2, d_t2_fp32);
+    for(auto x: d_v2.get_blocks()) {
+      if(x == "ijab") ccsd_t_cpu_convert(ec, d_v2.v2ijab, d_v2_fp32.v2ijab);
+      if(x == "ijka") ccsd_t_cpu_convert(ec, d_v2.v2ijka, d_v2_fp32.v2ijka);
+      if(x == "iabc") ccsd_t_cpu_convert(ec, d_v2.v2iabc, d_v2_fp32.v2iabc);
+    }
+    for(int i = 0; i < (ccsdt_prefetch ? 2 : 1); i++)
+      cpu_bufs_fp32[i] = ccsd_t_cpu_alloc_buffers<float>(noab, nvab, size_T_s1_t1, size_T_s1_v2,
+                                                         size_T_d1_t2, size_T_d1_v2,
+                                                         size_T_d2_t2, size_T_d2_v2);
+    if(!ccsdt_prefetch) cpu_bufs_fp32[1] = cpu_bufs_fp32[0];
+  }
+  const size_t                        cache_size = sys_data.options_map.ccsd_options.cache_size;
+  LRUCache<Index, std::vector<float>> cache_s1t_fp32{cache_size};
+  LRUCache<Index, std::vector<float>> cache_s1v_fp32{cache_size};
+  LRUCache<Index, std::vector<float>> cache_d1t_fp32{cache_size * noab};
+  LRUCache<Index, std::vector<float>> cache_d1v_fp32{cache_size * noab};
+  LRUCache<Index, std::vector<float>> cache_d2t_fp32{cache_size * nvab};
+  LRUCache<Index, std::vector<float>> cache_d2v_fp32{cache_size * nvab};
+
+  auto data = [&](const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<T>& bufs) {
+    ccsd_t_data_cpu_task<T>(is_restricted, noab, nvab, k_spin, k_range, d_t1, d_t2, d_v2,
+                            k_evl_sorted, task, bufs, max_d1_kernels_pertask,
+                            max_d2_kernels_pertask,
+                            //
+                            size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2,
+                            size_T_d2_v2,
+                            //
+                            cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v);
+  };
+  auto compute = [&](const ccsd_t_cpu_task& task, auto& bufs, std::vector<double>& energies,
+                     auto& ws, auto& arena) {
+    ccsd_t_compute_cpu_task<T>(noab, nvab, k_range, k_offset, k_evl_sorted, task, bufs,
+                               max_d1_kernels_pertask, max_d2_kernels_pertask,
+                               //
+                               size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2,
+                               size_T_d2_t2, size_T_d2_v2,
+                               //
+                               energies, ws, arena);
+  };
+  auto count = [&](auto& bufs) {
+    ccsd_t_count_task_ops(noab, nvab, bufs.df_simple_s1_size, bufs.df_simple_d1_size,
+                          bufs.df_simple_d2_size, bufs.df_simple_s1_exec, bufs.df_simple_d1_exec,
+                          bufs.df_simple_d2_exec);
+  };
+
+  ccsd_t_cpu_prefetcher<T> cpu_tasks(
+    cpu_bufs, cpu_bufs_next, data,
+    [&](const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<T>& bufs) {
+      compute(task, bufs, energy_l, cpu_ws, t3_arena);
+      count(bufs);
+    },
+    ccsdt_prefetch);
+
+  ccsd_t_cpu_prefetcher<float> cpu_tasks_fp32(
+    cpu_bufs_fp32[0], cpu_bufs_fp32[1],
+    [&](const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<float>& bufs) {
+      ccsd_t_data_cpu_task<float>(is_restricted, noab, nvab, k_spin, k_range, d_t1_fp32,
+                                  d_t2_fp32, d_v2_fp32, k_evl_sorted_fp32, task, bufs,
+                                  max_d1_kernels_pertask, max_d2_kernels_pertask,
+                                  //
+                                  size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2,
+                                  size_T_d2_t2, size_T_d2_v2,
+                                  //
+                                  cache_s1t_fp32, cache_s1v_fp32, cache_d1t_fp32,
+                                  cache_d1v_fp32, cache_d2t_fp32, cache_d2v_fp32);
+    },
+    [&](const ccsd_t_cpu_task& task, ccsd_t_cpu_buffers<float>& bufs) {
+      std::vector<double> e_fp32(2, 0.0);
+      compute(task, bufs, e_fp32, cpu_ws_fp32, t3_arena_fp32);
+      energy_l[0] += e_fp32[0];
+      energy_l[1] += e_fp32[1];
+      count(bufs);
+      if(ccsd_t_cpu_fp64_sample(task, fp32_sample)) {
+        std::vector<double> e_fp64(2, 0.0);
+        // on the compute thread, while the prefetch thread may be staging the next task
+        data(task, cpu_bufs);
+        compute(task, cpu_bufs, e_fp64, cpu_ws, t3_arena);
+        ccsdt_fp32_samples += 1;
+        ccsdt_fp32_error[0] += e_fp32[0] - e_fp64[0];
+        ccsdt_fp32_error[1] += e_fp32[1] - e_fp64[1];
+      }
+    },
+    ccsdt_prefetch);
+  auto cpu_flush = [&]() {
+    if(ccsdt_mixed) cpu_tasks_fp32.flush();
+    else cpu_tasks.flush();
+  };
+#endif
 #if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
   // get GPU memory handle from pool
   auto& memPool = tamm::GPUPooledStorageManager::getInstance();
@@ -195,9 +468,91 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
     static_cast<T*>(memPool.allocate(sizeof(T) * std::pow(max_num_blocks, 6) * 2));
 #endif
 
+  // runs one (h1,h2,h3,p4,p5,p6) task on this rank
+  auto run_task = [&](size_t t_h1b, size_t t_h2b, size_t t_h3b, size_t t_p4b, size_t t_p5b,
+                      size_t t_p6b, T factor, int64_t taskid) {
+    const uint64_t task_key =
+      ccsd_t_checkpoint::task_key(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, noab + nvab);
+    if(ccsdt_checkpoint.done(task_key)) return;
+    if(ccsdt_screening.skip(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor)) {
+      ccsdt_checkpoint.complete(task_key);
+      return;
+    }
+
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+    ccsd_t_fully_fused_none_df_none_task<T>(
+      is_restricted, noab, nvab, rank, k_spin, k_range, k_offset, d_t1, d_t2, d_v2, k_evl_sorted,
+      //
+      df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2, df_host_pinned_d1_v2,
+      df_host_pinned_d2_t2, df_host_pinned_d2_v2, df_host_energies,
+      //
+      //
+      //
+      host_d1_size, host_d2_size,
+      //
+      df_simple_s1_size, df_simple_d1_size, df_simple_d2_size, df_simple_s1_exec, df_simple_d1_exec,
+      df_simple_d2_exec,
+      //
+      df_dev_s1_t1_all, df_dev_s1_v2_all, df_dev_d1_t2_all, df_dev_d1_v2_all, df_dev_d2_t2_all,
+      df_dev_d2_v2_all, df_dev_energies,
+      //
+      t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskid, max_d1_kernels_pertask,
+      max_d2_kernels_pertask,
+      //
+      size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2, size_T_d2_v2,
+      //
+      energy_l,
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+      reduceData.get(),
+#endif
+      cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v,
+      //
+      done_compute.get(), done_copy.get());
+#else
+    if(ccsdt_mixed) cpu_tasks_fp32.run({t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor});
+    else cpu_tasks.run({t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor});
+#endif
+
+    ccsdt_checkpoint.complete(task_key);
+    if(ccsdt_checkpoint.due()) {
+      // the energies of every completed task have to be in energy_l
+#if defined(USE_CUDA)
+      CUDA_SAFE(cudaEventSynchronize(*done_compute));
+#elif defined(USE_HIP)
+      HIP_SAFE(hipEventSynchronize(*done_compute));
+#elif defined(USE_DPCPP)
+      done_compute->wait();
+#else
+      cpu_flush();
+#endif
+      ccsdt_checkpoint.write(energy_l[0], energy_l[1], ccsdt_screening.skipped,
+                             ccsdt_screening.error);
+    }
+  };
+
   //
   int num_task = 0;
-  if(!seq_h3b) {
+  if(task_list) {
+    if(rank == 0)
+      std::cout << (task_order == "loop" ? "cost-sorted" : "locality-ordered")
+                << " guided task scheduling (" << ntasks << " tasks)" << std::endl
+                << std::endl;
+
+    const int64_t nchunks = (int64_t) chunk_first.size() - 1;
+    while(true) {
+      const int64_t chunk = ccsd_t_ga_call([&] { return ac->fetch_add(0, 1); });
+      ccsdt_task_fetches++;
+      ccsdt_checkpoint.claimed(chunk_first[std::min(chunk, nchunks)]);
+      if(chunk >= nchunks) break;
+
+      for(int64_t i = chunk_first[chunk]; i < chunk_first[chunk + 1]; i++) {
+        auto [t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor] = list_tasks[order[i]];
+        num_task++;
+        run_task(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, i);
+      }
+    }
+  }
+  else if(!seq_h3b) {
     if(rank == 0) {
       std::cout << "456123 parallel 6d loop variant" << std::endl << std::endl;
       // std::cout << "tile142563,kernel,memcpy,data,total" << std::endl;
@@ -224,60 +579,10 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
 
                       num_task++;
 
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-                      ccsd_t_fully_fused_none_df_none_task<T>(
-                        is_restricted, noab, nvab, rank, k_spin, k_range, k_offset, d_t1, d_t2,
-                        d_v2, k_evl_sorted,
-                        //
-                        df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2,
-                        df_host_pinned_d1_v2, df_host_pinned_d2_t2, df_host_pinned_d2_v2,
-                        df_host_energies,
-                        //
-                        //
-                        //
-                        host_d1_size, host_d2_size,
-                        //
-                        df_simple_s1_size, df_simple_d1_size, df_simple_d2_size, df_simple_s1_exec,
-                        df_simple_d1_exec, df_simple_d2_exec,
-                        //
-                        df_dev_s1_t1_all, df_dev_s1_v2_all, df_dev_d1_t2_all, df_dev_d1_v2_all,
-                        df_dev_d2_t2_all, df_dev_d2_v2_all, df_dev_energies,
-                        //
-                        t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount,
-                        max_d1_kernels_pertask, max_d2_kernels_pertask,
-                        //
-                        size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2,
-                        size_T_d2_v2,
-                        //
-                        energy_l,
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-                        reduceData.get(),
-#endif
-                        cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v,
-                        //
-                        done_compute.get(), done_copy.get());
-#else
-                      total_fused_ccsd_t_cpu<T>(
-                        is_restricted, noab, nvab, rank, k_spin, k_range, k_offset, d_t1, d_t2,
-                        d_v2, k_evl_sorted,
-                        //
-                        df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2,
-                        df_host_pinned_d1_v2, df_host_pinned_d2_t2, df_host_pinned_d2_v2,
-                        df_host_energies, host_d1_size, host_d2_size,
-                        //
-                        df_simple_s1_size, df_simple_d1_size, df_simple_d2_size, df_simple_s1_exec,
-                        df_simple_d1_exec, df_simple_d2_exec,
-                        //
-                        t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount,
-                        max_d1_kernels_pertask, max_d2_kernels_pertask,
-                        //
-                        size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2,
-                        size_T_d2_v2,
-                        //
-                        energy_l, cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v);
-#endif
+                      run_task(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount);
 
-                      next = ac->fetch_add(0, 1);
+                      next = ccsd_t_ga_call([&] { return ac->fetch_add(0, 1); });
+                      ccsdt_checkpoint.claimed(next);
                     }
                     taskcount++;
                   }
@@ -327,62 +632,13 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
                       //
                       num_task++;
 
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-                      ccsd_t_fully_fused_none_df_none_task<T>(
-                        is_restricted, noab, nvab, rank, k_spin, k_range, k_offset, d_t1, d_t2,
-                        d_v2, k_evl_sorted,
-                        //
-                        df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2,
-                        df_host_pinned_d1_v2, df_host_pinned_d2_t2, df_host_pinned_d2_v2,
-                        df_host_energies,
-                        //
-                        //
-                        //
-                        host_d1_size, host_d2_size,
-                        //
-                        df_simple_s1_size, df_simple_d1_size, df_simple_d2_size, df_simple_s1_exec,
-                        df_simple_d1_exec, df_simple_d2_exec,
-                        //
-                        df_dev_s1_t1_all, df_dev_s1_v2_all, df_dev_d1_t2_all, df_dev_d1_v2_all,
-                        df_dev_d2_t2_all, df_dev_d2_v2_all, df_dev_energies,
-                        //
-                        t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount,
-                        max_d1_kernels_pertask, max_d2_kernels_pertask,
-                        //
-                        size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2,
-                        size_T_d2_v2,
-                        //
-                        energy_l,
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-                        reduceData.get(),
-#endif
-                        cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v,
-                        //
-                        done_compute.get(), done_copy.get());
-#else
-            total_fused_ccsd_t_cpu<T>(
-              is_restricted, noab, nvab, rank, k_spin, k_range, k_offset, d_t1, d_t2, d_v2,
-              k_evl_sorted,
-              //
-              df_host_pinned_s1_t1, df_host_pinned_s1_v2, df_host_pinned_d1_t2,
-              df_host_pinned_d1_v2, df_host_pinned_d2_t2, df_host_pinned_d2_v2, df_host_energies,
-              host_d1_size, host_d2_size,
-              //
-              df_simple_s1_size, df_simple_d1_size, df_simple_d2_size, df_simple_s1_exec,
-              df_simple_d1_exec, df_simple_d2_exec,
-              //
-              t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount, max_d1_kernels_pertask,
-              max_d2_kernels_pertask,
-              //
-              size_T_s1_t1, size_T_s1_v2, size_T_d1_t2, size_T_d1_v2, size_T_d2_t2, size_T_d2_v2,
-              //
-              energy_l, cache_s1t, cache_s1v, cache_d1t, cache_d1v, cache_d2t, cache_d2v);
-#endif
+                      run_task(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor, taskcount);
                     }
                   }
                 } // h3b
 
-                next = ac->fetch_add(0, 1);
+                next = ccsd_t_ga_call([&] { return ac->fetch_add(0, 1); });
+                ccsdt_checkpoint.claimed(next);
               }
               taskcount++;
             }
@@ -392,6 +648,12 @@ std::tuple<T, T, double, double> ccsd_t_fused_driver_new(
     }
   } // end seq h3b
 
+#if !defined(USE_CUDA) && !defined(USE_HIP) && !defined(USE_DPCPP)
+  cpu_flush();
+  ccsdt_prefetch_DataTime = cpu_tasks.data_time + cpu_tasks_fp32.data_time;
+  ccsdt_prefetch_WaitTime = cpu_tasks.wait_time + cpu_tasks_fp32.wait_time;
+#endif
+
 #if defined(USE_CUDA)
   CUDA_SAFE(cudaDeviceSynchronize());
 #elif defined(USE_HIP)
@@ -422,6 +684,16 @@ HIP_SAFE(hipDeviceSynchronize());
 
   freeHostMem(df_host_energies);
 
+#if !defined(USE_CUDA) && !defined(USE_HIP) && !defined(USE_DPCPP)
+  if(ccsdt_prefetch && !ccsdt_mixed) ccsd_t_cpu_free_buffers(cpu_bufs_next);
+  if(ccsdt_mixed) {
+    ccsd_t_cpu_free_buffers(cpu_bufs_fp32[0]);
+    if(ccsdt_prefetch) ccsd_t_cpu_free_buffers(cpu_bufs_fp32[1]);
+    free_tensors(d_t1_fp32, d_t2_fp32);
+    d_v2_fp32.deallocate();
+  }
+#endif
+
 #if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
   memPool.deallocate(static_cast<void*>(df_dev_s1_t1_all), sizeof(T) * size_T_s1_t1);
   memPool.deallocate(static_cast<void*>(df_dev_s1_v2_all), sizeof(T) * size_T_s1_v2);
@@ -447,107 +719,9 @@ HIP_SAFE(hipDeviceSynchronize());
     std::chrono::duration_cast<std::chrono::duration<double>>((cc_t2 - cc_t1)).count();
 
   //
-  next = ac->fetch_add(0, 1);
+  next = ccsd_t_ga_call([&] { return ac->fetch_add(0, 1); });
   ac->deallocate();
   delete ac;
 
   return std::make_tuple(energy1, energy2, ccsd_t_time, total_t_time);
 }
-
-template<typename T>
-void ccsd_t_fused_driver_calculator_ops(SystemData& sys_data, ExecutionContext& ec,
-                                        std::vector<int>& k_spin, const TiledIndexSpace& MO,
-                                        std::vector<T>& k_evl_sorted, double hf_ccsd_energy,
-                                        bool is_restricted, long double& total_num_ops,
-                                        //
-                                        bool seq_h3b = false) {
-  //
-  auto rank = ec.pg().rank().value();
-
-  Index noab = MO("occ").num_tiles();
-  Index nvab = MO("virt").num_tiles();
-
-  auto                mo_tiles = MO.input_tile_sizes();
-  std::vector<size_t> k_range;
-  std::vector<size_t> k_offset;
-  size_t              sum = 0;
-  for(auto x: mo_tiles) {
-    k_range.push_back(x);
-    k_offset.push_back(sum);
-    sum += x;
-  }
-
-  //
-  //  "list of tasks": size (t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b), factor,
-  //
-  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>> list_tasks;
-  if(!seq_h3b) {
-    for(size_t t_p4b = noab; t_p4b < noab + nvab; t_p4b++) {
-      for(size_t t_p5b = t_p4b; t_p5b < noab + nvab; t_p5b++) {
-        for(size_t t_p6b = t_p5b; t_p6b < noab + nvab; t_p6b++) {
-          for(size_t t_h1b = 0; t_h1b < noab; t_h1b++) { //
-            for(size_t t_h2b = t_h1b; t_h2b < noab; t_h2b++) {
-              for(size_t t_h3b = t_h2b; t_h3b < noab; t_h3b++) {
-                //
-                if((k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b]) ==
-                   (k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b])) {
-                  if((!is_restricted) || (k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b] +
-                                          k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b]) <= 8) {
-                    //
-                    double factor = 1.0;
-                    if(is_restricted) factor = 2.0;
-                    if((t_p4b == t_p5b) && (t_p5b == t_p6b)) { factor /= 6.0; }
-                    else if((t_p4b == t_p5b) || (t_p5b == t_p6b)) { factor /= 2.0; }
-
-                    if((t_h1b == t_h2b) && (t_h2b == t_h3b)) { factor /= 6.0; }
-                    else if((t_h1b == t_h2b) || (t_h2b == t_h3b)) { factor /= 2.0; }
-
-                    //
-                    list_tasks.push_back(
-                      std::make_tuple(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor));
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    }    // nested for loops
-  }      // parallel h3b loop
-  else { // seq h3b loop
-    for(size_t t_p4b = noab; t_p4b < noab + nvab; t_p4b++) {
-      for(size_t t_p5b = t_p4b; t_p5b < noab + nvab; t_p5b++) {
-        for(size_t t_p6b = t_p5b; t_p6b < noab + nvab; t_p6b++) {
-          for(size_t t_h1b = 0; t_h1b < noab; t_h1b++) {
-            for(size_t t_h2b = t_h1b; t_h2b < noab; t_h2b++) {
-              //
-              for(size_t t_h3b = t_h2b; t_h3b < noab; t_h3b++) {
-                if((k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b]) ==
-                   (k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b])) {
-                  if((!is_restricted) || (k_spin[t_p4b] + k_spin[t_p5b] + k_spin[t_p6b] +
-                                          k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b]) <= 8) {
-                    double factor = 1.0;
-                    if(is_restricted) factor = 2.0;
-                    //
-                    if((t_p4b == t_p5b) && (t_p5b == t_p6b)) { factor /= 6.0; }
-                    else if((t_p4b == t_p5b) || (t_p5b == t_p6b)) { factor /= 2.0; }
-
-                    if((t_h1b == t_h2b) && (t_h2b == t_h3b)) { factor /= 6.0; }
-                    else if((t_h1b == t_h2b) || (t_h2b == t_h3b)) { factor /= 2.0; }
-
-                    //
-                    list_tasks.push_back(
-                      std::make_tuple(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor));
-                  }
-                }
-              } // h3b
-            }
-          }
-        }
-      }
-    } // nested for loops
-  }   // end seq h3b
-
-  total_num_ops = (long double) ccsd_t_fully_fused_performance(
-    is_restricted, list_tasks, rank, 1, noab, nvab, k_spin, k_range, k_offset, k_evl_sorted);
-}
@@ -0,0 +1,511 @@
+#pragma once
+
+#include "ccsd_t_checkpoint.hpp"
+#include "ccsd_t_chol_iabc.hpp"
+#include "ccsd_t_common.hpp"
+#include "tamm/tamm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <list>
+#include <map>
+#include <omp.h>
+#include <tuple>
+#include <vector>
+
+//
+//  occupied-triplet (ijk) driven (T) for CPUs. for a triple of occupied spin orbitals i < j < k
+//  the triples are built over the virtuals with DGEMMs,
+//
+//    X(p;q,r)^abc = - sum_e t_qr^ae <pe||bc> - sum_m <qr||ma> t_pm^bc
+//    W^abc        = X(i;j,k) - X(j;i,k) + X(k;i,j)
+//    Y^abc        = t_i^a <jk||bc> - t_j^a <ik||bc> + t_k^a <ij||bc>
+//
+//  with <pe||bc> = v2iabc, <qr||ma> = v2ijka and <jk||bc> = v2ijab. W and Y are antisymmetric in
+//  bc, so the connected and disconnected triples are the cyclic sums t3c = W^abc + W^bca + W^cab
+//  and t3d = Y^abc + Y^bca + Y^cab, and with D = e_i + e_j + e_k - e_a - e_b - e_c
+//
+//    [T] = sum_{i<j<k} sum_{a<b<c} t3c t3c / D,   (T) = sum_{i<j<k} sum_{a<b<c} (t3c + t3d) t3c / D
+//
+//  a task is a triple of occupied tiles. its pair operands (t_qr^ae, <qr||ma>, <qr||bc>) are
+//  staged densely over all virtuals; <pe||xc> and t_pm^xc are staged for one virtual tile x at a
+//  time, into slabs of which a rank keeps the cache_size used last. the triples are built for a
+//  pair of virtual tiles B <= C at a time, b in B and c in C, with a over the virtuals of its
+//  spin below b: a thread holds W^abc, W^bca and W^cba = -W^cab for these, O(V^2) per pair of
+//  tiles. the pairs are run for a group of cache_size - 1 tiles B at a time, with C streamed
+//  past them, so the slab of a tile C is staged once per group rather than once per pair.
+//
+
+extern double ccsdt_ijk_GetTime;
+extern double ccsd_t_data_per_rank;
+
+enum ccsd_t_ijk_input {
+  CCSDT_IJK_T1,
+  CCSDT_IJK_T2,
+  CCSDT_IJK_IJAB,
+  CCSDT_IJK_IJKA,
+  CCSDT_IJK_IABC
+};
+
+// spin-orbital layout of the (T) MO space: the offset of each tile among the occupied or the
+// virtual orbitals, and where the orbitals of each spin start
+struct ccsd_t_ijk_dims {
+  ccsd_t_ijk_dims(size_t noab_, size_t nvab_, const std::vector<size_t>& k_range,
+                  const std::vector<int>& k_spin):
+    noab{noab_}, nvab{nvab_}, range{k_range} {
+    for(size_t t = 0; t < noab + nvab; t++) {
+      size_t& n = t < noab ? nocc : nvir;
+      size_t* c = t < noab ? no : nv;
+      offset.push_back(n);
+      spin.push_back(k_spin[t] - 1);
+      n += range[t];
+      c[spin[t]] += range[t];
+    }
+    o0[0] = v0[0] = 0;
+    o0[1]         = no[0];
+    v0[1]         = nv[0];
+  }
+
+  size_t              noab, nvab;
+  size_t              nocc = 0, nvir = 0;
+  std::vector<size_t> range, offset;
+  std::vector<int>    spin;                   // 0 alpha, 1 beta
+  size_t              o0[2], no[2] = {0, 0};  // first occupied orbital and count of each spin
+  size_t              v0[2], nv[2] = {0, 0};  // first virtual orbital and count of each spin
+};
+
+// <pe||xc> as [p][e][x][c] and t_pm^xc as [p][m][x][c] for one virtual tile x, by occupied tile
+template<typename T>
+struct ccsd_t_ijk_slab {
+  size_t                           tile = 0;
+  std::map<size_t, std::vector<T>> iabc;
+  std::map<size_t, std::vector<T>> t2;
+};
+
+// dense operands of the current occupied tile triplet, by occupied tile or pair of tiles
+template<typename T>
+struct ccsd_t_ijk_operands {
+  using tile_pair = std::pair<size_t, size_t>;
+
+  std::map<tile_pair, std::vector<T>> t2_oo; // t_qr^ae as [q][r][a][e]
+  std::map<tile_pair, std::vector<T>> ijka;  // <qr||ma> as [q][r][m][a]
+  std::map<tile_pair, std::vector<T>> ijab;  // <qr||bc> as [q][r][b][c]
+  std::vector<T>                      t1;    // t_i^a as [a][i]
+
+  std::list<ccsd_t_ijk_slab<T>> slabs;         // least recently used first
+  size_t                        max_slabs = 2; // at least 2
+  std::vector<std::vector<T>>   w;             // W^abc, W^bca, W^cba of each thread
+};
+
+// writes a block of extents n into dst, with the strides of dst for each index of the block
+template<typename T>
+void ccsd_t_ijk_place(const T* block, const std::array<size_t, 4>& n, T* dst,
+                      const std::array<size_t, 4>& stride) {
+  for(size_t x = 0; x < n[0]; x++)
+    for(size_t y = 0; y < n[1]; y++)
+      for(size_t z = 0; z < n[2]; z++) {
+        T* d = dst + x * stride[0] + y * stride[1] + z * stride[2];
+        for(size_t w = 0; w < n[3]; w++) d[w * stride[3]] = *block++;
+      }
+}
+
+template<typename Map, typename Keep>
+void ccsd_t_ijk_prune(Map& m, Keep&& keep) {
+  for(auto it = m.begin(); it != m.end();) it = keep(it->first) ? std::next(it) : m.erase(it);
+}
+
+//
+//  stages the pair operands and t1 of the occupied tile triplet occ (tile indices,
+//  occ[0] <= occ[1] <= occ[2]), keeping what the previous triplet staged and is still needed.
+//  fetch(id, bids, buf) reads a block of the given input (virtual tiles counted from the first
+//  virtual tile, as the tensors index them), and is only called for spin-allowed blocks.
+//
+template<typename T, typename Fetch>
+void ccsd_t_ijk_stage(const std::array<size_t, 3>& occ, const ccsd_t_ijk_dims& d, Fetch&& fetch,
+                      ccsd_t_ijk_operands<T>& ops) {
+  using tile_pair = typename ccsd_t_ijk_operands<T>::tile_pair;
+
+  const size_t O = d.nocc, V = d.nvir, VV = V * V;
+  const auto&  s = d.spin;
+  const auto&  r = d.range;
+  const auto&  f = d.offset;
+
+  const std::array<tile_pair, 3> pairs = {
+    {{occ[0], occ[1]}, {occ[0], occ[2]}, {occ[1], occ[2]}}};
+  auto in_pairs = [&](const tile_pair& p) {
+    return std::find(pairs.begin(), pairs.end(), p) != pairs.end();
+  };
+  ccsd_t_ijk_prune(ops.t2_oo, in_pairs);
+  ccsd_t_ijk_prune(ops.ijka, in_pairs);
+  ccsd_t_ijk_prune(ops.ijab, in_pairs);
+
+  auto           bids = [](auto... tiles) { return IndexVector{static_cast<Index>(tiles)...}; };
+  std::vector<T> block;
+
+  const size_t v_end = d.noab + d.nvab;
+  for(const auto& p: pairs) {
+    if(ops.t2_oo.count(p)) continue;
+    const auto [x, y] = p;
+    const size_t nqr  = r[x] * r[y];
+
+    std::vector<T>& t2_qr = ops.t2_oo[p];
+    t2_qr.assign(nqr * VV, 0);
+    for(size_t a = d.noab; a < v_end; a++)
+      for(size_t e = d.noab; e < v_end; e++) {
+        if(s[a] + s[e] != s[x] + s[y]) continue;
+        fetch(CCSDT_IJK_T2, bids(a - d.noab, e - d.noab, x, y), block);
+        ccsd_t_ijk_place(block.data(), {r[a], r[e], r[x], r[y]}, &t2_qr[f[a] * V + f[e]],
+                         {V, 1, r[y] * VV, VV});
+      }
+
+    std::vector<T>& v_qr = ops.ijka[p];
+    v_qr.assign(nqr * O * V, 0);
+    for(size_t m = 0; m < d.noab; m++)
+      for(size_t a = d.noab; a < v_end; a++) {
+        if(s[x] + s[y] != s[m] + s[a]) continue;
+        fetch(CCSDT_IJK_IJKA, bids(x, y, m, a - d.noab), block);
+        ccsd_t_ijk_place(block.data(), {r[x], r[y], r[m], r[a]}, &v_qr[f[m] * V + f[a]],
+                         {r[y] * O * V, O * V, V, 1});
+      }
+
+    std::vector<T>& w_qr = ops.ijab[p];
+    w_qr.assign(nqr * VV, 0);
+    for(size_t b = d.noab; b < v_end; b++)
+      for(size_t c = d.noab; c < v_end; c++) {
+        if(s[x] + s[y] != s[b] + s[c]) continue;
+        fetch(CCSDT_IJK_IJAB, bids(x, y, b - d.noab, c - d.noab), block);
+        ccsd_t_ijk_place(block.data(), {r[x], r[y], r[b], r[c]}, &w_qr[f[b] * V + f[c]],
+                         {r[y] * VV, VV, V, 1});
+      }
+  }
+
+  if(ops.t1.empty()) {
+    ops.t1.assign(V * O, 0);
+    for(size_t a = d.noab; a < v_end; a++)
+      for(size_t h = 0; h < d.noab; h++) {
+        if(s[a] != s[h]) continue;
+        fetch(CCSDT_IJK_T1, bids(a - d.noab, h), block);
+        ccsd_t_ijk_place(block.data(), {1, 1, r[a], r[h]}, &ops.t1[f[a] * O + f[h]], {0, 0, O, 1});
+      }
+  }
+}
+
+//
+//  stages <pe||xc> and t_pm^xc of the occupied tiles occ for the virtual tile x (a tile index),
+//  keeping the occupied tiles the slab already holds for x
+//
+template<typename T, typename Fetch>
+void ccsd_t_ijk_stage_slab(const std::array<size_t, 3>& occ, size_t x, const ccsd_t_ijk_dims& d,
+                           Fetch&& fetch, ccsd_t_ijk_slab<T>& slab) {
+  const size_t O = d.nocc, V = d.nvir, XV = d.range[x] * V;
+  const auto&  s = d.spin;
+  const auto&  r = d.range;
+  const auto&  f = d.offset;
+
+  auto           bids = [](auto... tiles) { return IndexVector{static_cast<Index>(tiles)...}; };
+  std::vector<T> block;
+
+  if(slab.tile != x) {
+    slab.tile = x;
+    slab.iabc.clear();
+    slab.t2.clear();
+  }
+  auto in_occ = [&](size_t h) { return std::find(occ.begin(), occ.end(), h) != occ.end(); };
+  ccsd_t_ijk_prune(slab.iabc, in_occ);
+  ccsd_t_ijk_prune(slab.t2, in_occ);
+  const size_t v_end = d.noab + d.nvab;
+  for(size_t h: occ) {
+    if(slab.iabc.count(h)) continue;
+    std::vector<T>& v_p = slab.iabc[h];
+    v_p.assign(r[h] * V * XV, 0);
+    for(size_t e = d.noab; e < v_end; e++)
+      for(size_t c = d.noab; c < v_end; c++) {
+        if(s[h] + s[e] != s[x] + s[c]) continue;
+        fetch(CCSDT_IJK_IABC, bids(h, e - d.noab, x - d.noab, c - d.noab), block);
+        ccsd_t_ijk_place(block.data(), {r[h], r[e], r[x], r[c]}, &v_p[f[e] * XV + f[c]],
+                         {V * XV, XV, V, 1});
+      }
+
+    std::vector<T>& t2_p = slab.t2[h];
+    t2_p.assign(r[h] * O * XV, 0);
+    for(size_t c = d.noab; c < v_end; c++)
+      for(size_t m = 0; m < d.noab; m++) {
+        if(s[x] + s[c] != s[h] + s[m]) continue;
+        fetch(CCSDT_IJK_T2, bids(x - d.noab, c - d.noab, h, m), block);
+        ccsd_t_ijk_place(block.data(), {r[x], r[c], r[h], r[m]}, &t2_p[f[m] * XV + f[c]],
+                         {V, 1, O * XV, XV});
+      }
+  }
+}
+
+// the slab of the virtual tile x for the occupied tiles occ, kept in ops.slabs
+template<typename T, typename Fetch>
+const ccsd_t_ijk_slab<T>& ccsd_t_ijk_slab_for(const std::array<size_t, 3>& occ, size_t x,
+                                              const ccsd_t_ijk_dims& d, Fetch&& fetch,
+                                              ccsd_t_ijk_operands<T>& ops) {
+  auto& slabs = ops.slabs;
+  auto  it    = std::find_if(slabs.begin(), slabs.end(), [x](auto& sl) { return sl.tile == x; });
+  if(it == slabs.end())
+    it = slabs.size() < std::max<size_t>(2, ops.max_slabs) ? slabs.emplace(slabs.end())
+                                                           : slabs.begin();
+  slabs.splice(slabs.end(), slabs, it);
+  ccsd_t_ijk_stage_slab<T>(occ, x, d, fetch, *it);
+  return *it;
+}
+
+//
+//  runs the orbital triplets i < j < k of an occupied tile triplet whose pair operands are staged,
+//  adding factor * [T] and factor * (T) to energy1 and energy2. the slabs of the virtual tiles are
+//  staged here, through fetch as in ccsd_t_ijk_stage, unless ops keeps them. o_evl/v_evl are the
+//  occupied and virtual orbital energies. returns the flops of the GEMMs.
+//
+template<typename T, typename Fetch>
+long double ccsd_t_ijk_task(const std::array<size_t, 3>& occ, T factor, const ccsd_t_ijk_dims& d,
+                            const std::vector<T>& o_evl, const std::vector<T>& v_evl,
+                            Fetch&& fetch, ccsd_t_ijk_operands<T>& ops, T& energy1, T& energy2) {
+  // X(p;q,r) of the three orbitals; the pairs (0,1), (0,2), (1,2) of positions are 0, 1, 2
+  static constexpr int terms[3][5] = {{0, 1, 2, 2, 1}, {1, 0, 2, 1, -1}, {2, 0, 1, 0, 1}};
+
+  const size_t O = d.nocc, V = d.nvir, VV = V * V;
+  const size_t n[3] = {d.range[occ[0]], d.range[occ[1]], d.range[occ[2]]};
+  const int    s[3] = {d.spin[occ[0]], d.spin[occ[1]], d.spin[occ[2]]};
+  const size_t pn[3] = {n[1], n[2], n[2]}; // extent of the second orbital of each pair
+
+  const T* t2_qr[3], *v_qr[3], *w_qr[3];
+  const std::pair<size_t, size_t> pairs[3] = {
+    {occ[0], occ[1]}, {occ[0], occ[2]}, {occ[1], occ[2]}};
+  for(int x = 0; x < 3; x++) {
+    t2_qr[x] = ops.t2_oo.at(pairs[x]).data();
+    v_qr[x]  = ops.ijka.at(pairs[x]).data();
+    w_qr[x]  = ops.ijab.at(pairs[x]).data();
+  }
+
+  std::vector<std::array<size_t, 3>> triplets;
+  for(size_t i = 0; i < n[0]; i++)
+    for(size_t j = (occ[1] == occ[0] ? i + 1 : 0); j < n[1]; j++)
+      for(size_t k = (occ[2] == occ[1] ? j + 1 : 0); k < n[2]; k++) triplets.push_back({i, j, k});
+
+  const T* t1 = ops.t1.data();
+  const int S = s[0] + s[1] + s[2];
+
+  T           e4 = 0, e5 = 0;
+  long double flops = 0;
+
+  // W^abc, W^bca and W^cba of a pair of tiles, for each thread
+  const size_t max_x = *std::max_element(d.range.begin() + d.noab, d.range.end());
+  const size_t max_a = std::max(d.nv[0], d.nv[1]);
+  ops.w.resize(omp_get_max_threads());
+  for(auto& w: ops.w) w.resize(3 * max_a * max_x * max_x);
+
+  const size_t v_end = d.noab + d.nvab;
+  const size_t group = std::max<size_t>(2, ops.max_slabs) - 1;
+  for(size_t B0 = d.noab; B0 < v_end; B0 += group) {
+    for(size_t C = B0; C < v_end; C++) {
+      // the slab of C is taken before those of the group, so that it is the one evicted next; the
+      // group takes at most max_slabs - 1 slabs, which leaves it in place
+      const ccsd_t_ijk_slab<T>* sl_c = nullptr;
+      for(size_t B = B0; B < std::min(B0 + group, C + 1); B++) {
+        // a has the spin left by b and c, and is below b
+        const int sa = S - d.spin[B] - d.spin[C];
+        if(sa < 0 || sa > 1) continue;
+        const size_t a0 = d.v0[sa], b0 = d.offset[B], c0 = d.offset[C];
+        const size_t nb = d.range[B], nc = d.range[C];
+        const size_t a1 = std::min(a0 + d.nv[sa], b0 + nb - 1);
+        if(a1 <= a0) continue;
+        const size_t na = a1 - a0, nw = na * nb * nc;
+
+        if(sl_c == nullptr) sl_c = &ccsd_t_ijk_slab_for<T>(occ, C, d, fetch, ops);
+        const auto& slab_b = ccsd_t_ijk_slab_for<T>(occ, B, d, fetch, ops);
+        const int   sb = d.spin[B], sc = d.spin[C];
+
+#pragma omp parallel reduction(+ : e4, e5, flops)
+        {
+          // W^abc as [a][b][c], W^bca as [b][c][a] and W^cba as [c][b][a]
+          T* const W1 = ops.w[omp_get_thread_num()].data();
+          T* const W2 = W1 + nw;
+          T* const W3 = W2 + nw;
+
+#pragma omp for schedule(dynamic)
+          for(size_t t = 0; t < triplets.size(); t++) {
+            const auto& l = triplets[t];
+            std::fill(W1, W1 + 3 * nw, 0);
+
+            for(auto& x: terms) {
+              const int    p = x[0], q = x[1], r = x[2], pr = x[3];
+              const T      alpha = -x[4];
+              const size_t qr    = l[q] * pn[pr] + l[r];
+              const T*     tqr   = t2_qr[pr] + qr * VV;
+              const T*     vqr   = v_qr[pr] + qr * O * V;
+              const int    sqr   = s[q] + s[r];
+
+              //
+              //  w[u][y][z] += alpha (sum_e t_qr^ue <pe||yz> + sum_m <qr||mu> t_pm^yz) for u in
+              //  [u0, u0 + nu) of spin su, y over the slab's tile and z in [z0, z0 + nz)
+              //
+              auto add = [&](T* w, size_t u0, size_t nu, int su, const ccsd_t_ijk_slab<T>& sl,
+                             size_t z0, size_t nz) {
+                const size_t ny = d.range[sl.tile], YV = ny * V, ld = ny * nz;
+                const T*     vp = sl.iabc.at(occ[p]).data() + l[p] * V * YV;
+                const T*     tp = sl.t2.at(occ[p]).data() + l[p] * O * YV;
+                const int    se = sqr - su; // also the spin of m
+                if(se < 0 || se > 1) return;
+                for(size_t y = 0; y < ny; y++) {
+                  if(d.nv[se] > 0) {
+                    blas::gemm(blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::NoTrans, nu, nz,
+                               d.nv[se], alpha, tqr + u0 * V + d.v0[se], V,
+                               vp + d.v0[se] * YV + y * V + z0, YV, 1.0, w + y * nz, ld);
+                    flops += 2.0L * nu * nz * d.nv[se];
+                  }
+                  if(d.no[se] > 0) {
+                    blas::gemm(blas::Layout::RowMajor, blas::Op::Trans, blas::Op::NoTrans, nu, nz,
+                               d.no[se], alpha, vqr + d.o0[se] * V + u0, V,
+                               tp + d.o0[se] * YV + y * V + z0, YV, 1.0, w + y * nz, ld);
+                    flops += 2.0L * nu * nz * d.no[se];
+                  }
+                }
+              };
+              add(W1, a0, na, sa, slab_b, c0, nc);
+              add(W2, b0, nb, sb, *sl_c, a0, na);
+              add(W3, c0, nc, sc, slab_b, a0, na);
+            }
+
+            const size_t gi = d.offset[occ[0]] + l[0], gj = d.offset[occ[1]] + l[1],
+                         gk    = d.offset[occ[2]] + l[2];
+            const T      e_ijk = o_evl[gi] + o_evl[gj] + o_evl[gk];
+            const T*     w_jk  = w_qr[2] + (l[1] * pn[2] + l[2]) * VV;
+            const T*     w_ik  = w_qr[1] + (l[0] * pn[1] + l[2]) * VV;
+            const T*     w_ij  = w_qr[0] + (l[0] * pn[0] + l[1]) * VV;
+            auto         y     = [&](size_t a, size_t b, size_t c) {
+              return t1[a * O + gi] * w_jk[b * V + c] - t1[a * O + gj] * w_ik[b * V + c] +
+                     t1[a * O + gk] * w_ij[b * V + c];
+            };
+
+            for(size_t ib = 0; ib < nb; ib++) {
+              const size_t b = b0 + ib;
+              for(size_t ic = (C == B ? ib + 1 : 0); ic < nc; ic++) {
+                const size_t c = c0 + ic;
+                for(size_t ia = 0; ia < na && a0 + ia < b; ia++) {
+                  const size_t a   = a0 + ia;
+                  const T      t3c = W1[(ia * nb + ib) * nc + ic] + W2[(ib * nc + ic) * na + ia] -
+                                W3[(ic * nb + ib) * na + ia];
+                  const T t3d = y(a, b, c) + y(b, c, a) + y(c, a, b);
+                  const T dn  = e_ijk - v_evl[a] - v_evl[b] - v_evl[c];
+                  e4 += t3c * t3c / dn;
+                  e5 += (t3c + t3d) * t3c / dn;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  energy1 += factor * e4;
+  energy2 += factor * e5;
+  return flops;
+}
+
+//
+//  ijk (T) over all occupied tile triplets, handed out with an atomic counter. returns the [T]
+//  and (T) energies of this rank and the (T) times; num_ops is set to the flops of this rank.
+//
+template<typename T>
+std::tuple<T, T, double, double>
+ccsd_t_ijk_driver(SystemData& sys_data, ExecutionContext& ec, std::vector<int>& k_spin,
+                  const TiledIndexSpace& MO, Tensor<T>& d_t1, Tensor<T>& d_t2, V2Tensors<T>& d_v2,
+                  std::vector<T>& k_evl_sorted, bool is_restricted, double& num_ops) {
+  auto rank     = ec.pg().rank().value();
+  bool nodezero = rank == 0;
+
+  const size_t noab = MO("occ").num_tiles();
+  const size_t nvab = MO("virt").num_tiles();
+
+  auto                mo_tiles = MO.input_tile_sizes();
+  std::vector<size_t> k_range(mo_tiles.begin(), mo_tiles.end());
+  ccsd_t_ijk_dims     dims{noab, nvab, k_range, k_spin};
+
+  std::vector<T> o_evl(k_evl_sorted.begin(), k_evl_sorted.begin() + dims.nocc);
+  std::vector<T> v_evl(k_evl_sorted.begin() + dims.nocc,
+                       k_evl_sorted.begin() + dims.nocc + dims.nvir);
+
+  // occupied tiles h1 <= h2 <= h3; a restricted reference only needs the aaa and aab spin cases
+  std::vector<std::tuple<size_t, size_t, size_t, T>> list_tasks;
+  for(size_t t_h1b = 0; t_h1b < noab; t_h1b++)
+    for(size_t t_h2b = t_h1b; t_h2b < noab; t_h2b++)
+      for(size_t t_h3b = t_h2b; t_h3b < noab; t_h3b++) {
+        if(is_restricted && k_spin[t_h1b] + k_spin[t_h2b] + k_spin[t_h3b] > 4) continue;
+        list_tasks.push_back(std::make_tuple(t_h1b, t_h2b, t_h3b, is_restricted ? 2.0 : 1.0));
+      }
+  const int64_t ntasks = list_tasks.size();
+
+  if(nodezero)
+    std::cout << "ijk (T) over occupied spin-orbital triplets: nocc,nvir = " << dims.nocc << ", "
+              << dims.nvir << " (" << ntasks << " tasks, " << omp_get_max_threads()
+              << " threads)" << std::endl
+              << std::endl;
+
+  std::vector<T> energy_l(2, 0.0);
+  auto [restart_energy1, restart_energy2] =
+    ccsdt_checkpoint.restore("ijk", ccsd_t_checkpoint::tiling(noab, k_range), "loop");
+  energy_l[0] += restart_energy1;
+  energy_l[1] += restart_energy2;
+
+  auto fetch = [&](ccsd_t_ijk_input id, const IndexVector& bids, std::vector<T>& buf) {
+    if(id == CCSDT_IJK_IABC && ccsdt_chol_iabc.enabled()) {
+      TimerGuard tg_total{&ccsdt_ijk_GetTime};
+      ccsdt_chol_iabc.get(bids, buf);
+      return;
+    }
+    Tensor<T>& tensor = id == CCSDT_IJK_T1     ? d_t1
+                        : id == CCSDT_IJK_T2   ? d_t2
+                        : id == CCSDT_IJK_IJAB ? d_v2.v2ijab
+                        : id == CCSDT_IJK_IJKA ? d_v2.v2ijka
+                                               : d_v2.v2iabc;
+    buf.resize(tensor.block_size(bids));
+    TimerGuard tg_total{&ccsdt_ijk_GetTime};
+    ccsd_t_data_per_rank += buf.size() * sizeof(T);
+    tensor.get(bids, buf);
+  };
+
+  // the slabs of the last cache_size virtual tiles are kept
+  ccsd_t_ijk_operands<T> ops;
+  long double            flops = 0;
+  ops.max_slabs = std::max(2, sys_data.options_map.ccsd_options.cache_size);
+
+  AtomicCounter* ac = new AtomicCounterGA(ec.pg(), 1);
+  ac->allocate(ccsdt_checkpoint.counter_start());
+
+  auto cc_t1 = std::chrono::high_resolution_clock::now();
+
+  for(int64_t next = ac->fetch_add(0, 1); next < ntasks; next = ac->fetch_add(0, 1)) {
+    ccsdt_checkpoint.claimed(next);
+    auto [t_h1b, t_h2b, t_h3b, factor] = list_tasks[next];
+    const uint64_t task_key =
+      ccsd_t_checkpoint::task_key(t_h1b, t_h2b, t_h3b, 0, 0, 0, noab + nvab);
+    if(ccsdt_checkpoint.done(task_key)) continue;
+
+    ccsd_t_ijk_stage<T>({t_h1b, t_h2b, t_h3b}, dims, fetch, ops);
+    flops += ccsd_t_ijk_task<T>({t_h1b, t_h2b, t_h3b}, factor, dims, o_evl, v_evl, fetch, ops,
+                                energy_l[0], energy_l[1]);
+
+    ccsdt_checkpoint.complete(task_key);
+    if(ccsdt_checkpoint.due()) ccsdt_checkpoint.write(energy_l[0], energy_l[1]);
+  }
+
+  auto cc_t2 = std::chrono::high_resolution_clock::now();
+  auto ccsd_t_time =
+    std::chrono::duration_cast<std::chrono::duration<double>>((cc_t2 - cc_t1)).count();
+
+  ec.pg().barrier();
+  cc_t2 = std::chrono::high_resolution_clock::now();
+  auto total_t_time =
+    std::chrono::duration_cast<std::chrono::duration<double>>((cc_t2 - cc_t1)).count();
+
+  ac->deallocate();
+  delete ac;
+
+  num_ops = flops;
+  return std::make_tuple(energy_l[0], energy_l[1], ccsd_t_time, total_t_time);
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mpi.h>
+#include <new>
+#include <vector>
+
+//
+//  node-level cache of (T) input blocks, shared by all ranks of a node through an MPI-3 shared
+//  memory window. it sits behind the per-rank LRU caches: a rank that misses in its own cache
+//  looks here before fetching the block with a get, and publishes every block it fetches.
+//
+//  the window holds a set-associative table of fixed-size slots (sized for the largest block).
+//  each slot is guarded by a sequence counter: readers copy a block and treat it as a miss if
+//  the counter moved, writers claim a slot with a single CAS and give up if it is taken, so no
+//  rank ever waits on another. victims are chosen per set with a CLOCK reference bit.
+//
+enum ccsd_t_node_cache_id {
+  CCSDT_CACHE_S1T = 1,
+  CCSDT_CACHE_S1V,
+  CCSDT_CACHE_D1T,
+  CCSDT_CACHE_D1V,
+  CCSDT_CACHE_D2T,
+  CCSDT_CACHE_D2V
+};
+
+inline const char* ccsd_t_cache_names[] = {"",      "S1-T1", "S1-V2", "D1-T2",
+                                          "D1-V2", "D2-T2", "D2-V2"};
+
+// lookups and hits of the per-rank LRU caches, indexed by cache id. a mixed-precision run may
+// stage a sampled task while the prefetch thread stages the next one, hence the atomic updates.
+extern double ccsdt_lru_lookups[CCSDT_CACHE_D2V + 1];
+extern double ccsdt_lru_hits[CCSDT_CACHE_D2V + 1];
+
+inline void ccsd_t_lru_count(ccsd_t_node_cache_id id, bool hit) {
+#pragma omp atomic
+  ccsdt_lru_lookups[id]++;
+  if(hit) {
+#pragma omp atomic
+    ccsdt_lru_hits[id]++;
+  }
+}
+
+class ccsd_t_node_cache {
+public:
+  static constexpr int ways = 8;
+
+  bool enabled() const { return slots_ > 0; }
+
+  //
+  //  collective over comm. budget_bytes is the size of the cache on each node, slot_bytes the
+  //  size of the largest block to be cached; a zero budget leaves the cache disabled.
+  //
+  void init(MPI_Comm comm, size_t budget_bytes, size_t slot_bytes) {
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "the node cache needs address-free 64-bit atomics");
+    slot_bytes_ = ((slot_bytes + 63) / 64) * 64;
+    size_t sets = budget_bytes / ((sizeof(slot_header) + slot_bytes_) * ways);
+    if(sets == 0 || slot_bytes_ == 0) return;
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm_);
+    int node_rank;
+    MPI_Comm_rank(node_comm_, &node_rank);
+
+    const size_t bytes = sets * ways * (sizeof(slot_header) + slot_bytes_);
+    char*        base  = nullptr;
+    MPI_Win_allocate_shared(node_rank == 0 ? (MPI_Aint) bytes : 0, 1, MPI_INFO_NULL, node_comm_,
+                            &base, &win_);
+    MPI_Aint size;
+    int      disp;
+    MPI_Win_shared_query(win_, 0, &size, &disp, &base);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+
+    sets_    = sets;
+    slots_   = sets * ways;
+    headers_ = reinterpret_cast<slot_header*>(base);
+    data_    = base + slots_ * sizeof(slot_header);
+    if(node_rank == 0)
+      for(size_t i = 0; i < slots_; i++) new(&headers_[i]) slot_header();
+    MPI_Win_sync(win_);
+    MPI_Barrier(node_comm_);
+  }
+
+  // collective over the communicator passed to init
+  void finalize() {
+    if(!enabled()) return;
+    MPI_Barrier(node_comm_);
+    MPI_Win_unlock_all(win_);
+    MPI_Win_free(&win_);
+    MPI_Comm_free(&node_comm_);
+    slots_   = 0;
+    headers_ = nullptr;
+    data_    = nullptr;
+  }
+
+  // copies a block of n elements into block (e.g. its slot of a kernel buffer)
+  template<typename Index, typename T>
+  bool get(ccsd_t_node_cache_id id, const std::vector<Index>& bids, T* block, size_t n) {
+    if(!enabled()) return false;
+    const uint64_t tag   = make_tag<T>(id, bids);
+    const size_t   first = set_of(tag) * ways;
+    for(size_t s = first; s < first + ways; s++) {
+      slot_header& h  = headers_[s];
+      uint64_t     s1 = h.seq.load(std::memory_order_acquire);
+      if((s1 & 1) || h.tag.load(std::memory_order_relaxed) != tag) continue;
+      if(h.bytes.load(std::memory_order_relaxed) != n * sizeof(T)) continue;
+      std::memcpy(block, data_ + s * slot_bytes_, n * sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if(h.seq.load(std::memory_order_relaxed) != s1) break; // overwritten while copying
+      h.ref.store(1, std::memory_order_relaxed);
+#pragma omp atomic
+      hits++;
+      return true;
+    }
+#pragma omp atomic
+    misses++;
+    return false;
+  }
+
+  template<typename Index, typename T>
+  void put(ccsd_t_node_cache_id id, const std::vector<Index>& bids, const T* block, size_t n) {
+    const size_t bytes = n * sizeof(T);
+    if(!enabled() || bytes > slot_bytes_) return;
+    const uint64_t tag   = make_tag<T>(id, bids);
+    const size_t   first = set_of(tag) * ways;
+
+    // already published by another rank
+    for(size_t s = first; s < first + ways; s++)
+      if(headers_[s].tag.load(std::memory_order_relaxed) == tag) return;
+
+    // CLOCK sweep: an empty slot or the first one without a recent reference
+    for(int i = 0; i < 2 * ways; i++) {
+      slot_header& h   = headers_[first + i % ways];
+      uint64_t     old = h.tag.load(std::memory_order_relaxed);
+      if(old != 0 && h.ref.exchange(0, std::memory_order_relaxed) != 0) continue;
+
+      uint64_t s = h.seq.load(std::memory_order_relaxed);
+      if((s & 1) || !h.seq.compare_exchange_strong(s, s + 1, std::memory_order_acquire)) continue;
+      if(h.tag.load(std::memory_order_relaxed) != 0) {
+#pragma omp atomic
+        evictions++;
+      }
+      h.tag.store(0, std::memory_order_relaxed);
+      std::memcpy(data_ + (first + i % ways) * slot_bytes_, block, bytes);
+      h.bytes.store(bytes, std::memory_order_relaxed);
+      h.tag.store(tag, std::memory_order_relaxed);
+      h.ref.store(1, std::memory_order_relaxed);
+      h.seq.store(s + 2, std::memory_order_release);
+      return;
+    }
+  }
+
+  // per-rank statistics; updated atomically, as the tasks of a mixed-precision run may be staged
+  // by two threads at once
+  double hits      = 0;
+  double misses    = 0;
+  double evictions = 0;
+
+private:
+  struct slot_header {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> tag{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> ref{0};
+  };
+
+  size_t set_of(uint64_t tag) const { return ((tag * 0x9e3779b97f4a7c15ull) >> 17) % sets_; }
+
+  //
+  //  the size of T and the cache id in the top bits, up to four 14-bit tile indices below; never
+  //  zero. the FP32 and FP64 copies of a block of a mixed-precision run have their own tags.
+  //
+  template<typename T, typename Index>
+  static uint64_t make_tag(ccsd_t_node_cache_id id, const std::vector<Index>& bids) {
+    static_assert(CCSDT_CACHE_D2V < 8 && sizeof(T) < 32);
+    uint64_t tag = (uint64_t) sizeof(T) << 59 | (uint64_t) id << 56;
+    for(size_t i = 0; i < bids.size(); i++) tag |= ((uint64_t) bids[i] & 0x3fff) << (14 * i);
+    return tag;
+  }
+
+  MPI_Comm     node_comm_  = MPI_COMM_NULL;
+  MPI_Win      win_        = MPI_WIN_NULL;
+  size_t       sets_       = 0;
+  size_t       slots_      = 0;
+  size_t       slot_bytes_ = 0;
+  slot_header* headers_    = nullptr;
+  char*        data_       = nullptr;
+};
+
+extern ccsd_t_node_cache ccsdt_node_cache;
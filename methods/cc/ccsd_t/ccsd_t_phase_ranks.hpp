@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ccsd_t_autotune.hpp"
+#include "tamm/tamm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+//
+//  the ranks [first, first + nranks) of the world group, as an execution context of their own.
+//  collective over the world group. a group of all the ranks is the world context itself.
+//
+class ccsd_t_phase_group {
+public:
+  ccsd_t_phase_group(ExecutionContext& world_ec, int first, int nranks):
+    world_(world_ec.pg().size().value() == nranks) {
+    const int rank = world_ec.pg().rank().value();
+    member_        = rank >= first && rank < first + nranks;
+    if(world_) {
+      ec_ = &world_ec;
+      return;
+    }
+
+#if defined(USE_UPCXX)
+    team_ = std::make_unique<upcxx::team>(
+      upcxx::world().split(member_ ? 0 : upcxx::team::color_none, 0));
+#else
+    std::vector<int> ranks(nranks);
+    for(int i = 0; i < nranks; i++) ranks[i] = first + i;
+    auto      world_comm = world_ec.pg().comm();
+    MPI_Group world_group;
+    MPI_Comm_group(world_comm, &world_group);
+    MPI_Group group;
+    MPI_Group_incl(world_group, nranks, ranks.data(), &group);
+    MPI_Comm_create(world_comm, group, &comm_);
+    MPI_Group_free(&group);
+    MPI_Group_free(&world_group);
+#endif
+
+    if(member_) {
+#if defined(USE_UPCXX)
+      pg_ = ProcGroup::create_coll(*team_);
+#else
+      pg_ = ProcGroup::create_coll(comm_);
+#endif
+      own_ec_ =
+        std::make_unique<ExecutionContext>(pg_, DistributionKind::nw, MemoryManagerKind::ga);
+      ec_ = own_ec_.get();
+    }
+  }
+
+  ccsd_t_phase_group(const ccsd_t_phase_group&)            = delete;
+  ccsd_t_phase_group& operator=(const ccsd_t_phase_group&) = delete;
+
+  bool member() const { return member_; }
+
+  // on the members only
+  ExecutionContext& ec() { return *ec_; }
+
+  // on the members, once the phase is done
+  void destroy() {
+    if(world_ || !member_) return;
+    ec_->flush_and_sync();
+    own_ec_.reset();
+    ec_ = nullptr;
+#if defined(USE_UPCXX)
+    team_->destroy();
+#else
+    MPI_Comm_free(&comm_);
+#endif
+  }
+
+private:
+  bool              world_;
+  bool              member_ = false;
+  ExecutionContext* ec_     = nullptr;
+  ProcGroup         pg_;
+#if defined(USE_UPCXX)
+  std::unique_ptr<upcxx::team> team_;
+#else
+  MPI_Comm comm_ = MPI_COMM_NULL;
+#endif
+  // the context of a group smaller than the world; declared last so it goes before its group
+  std::unique_ptr<ExecutionContext> own_ec_;
+};
+
+//
+//  nodes of the CCSD and v2 setup phases of the CCSD(T) driver. the v2 setup gets enough nodes to
+//  keep ccsd_t_min_blocks_per_rank blocks of its largest output per rank (with fewer, the ranks
+//  mostly wait on each other and on communication). CCSD runs on all the nodes unless
+//  ccsdt_ccsd_nodes is set or the v2 setup overlaps it; then the same model picks its nodes, or
+//  more if the intermediates it allocates on its ranks need them. ccsdt_ccsd_nodes and
+//  ccsdt_v2_nodes override the model (0 keeps it).
+//
+//  with ccsdt_phase_overlap, the v2 blocks are built on the nodes CCSD leaves idle while CCSD
+//  runs, if the v2 tensors fit in memory next to the CCSD tensors. CD keeps its own throttling
+//  and (T) runs on all the ranks.
+//
+struct ccsd_t_phase_plan {
+  int  nnodes     = 1;
+  int  ppn        = 1;
+  int  ccsd_nodes = 1;
+  int  v2_nodes   = 1;
+  bool overlap    = false;
+
+  int ccsd_ranks() const { return ccsd_nodes * ppn; }
+  int v2_first() const { return overlap ? ccsd_ranks() : 0; }
+  int v2_ranks() const { return v2_nodes * ppn; }
+};
+
+constexpr double ccsd_t_min_blocks_per_rank = 8;
+
+inline int ccsd_t_phase_nodes(double blocks, double mem, double node_mem, int nnodes, int ppn) {
+  const int work_nodes = (int) std::ceil(blocks / (ccsd_t_min_blocks_per_rank * ppn));
+  const int mem_nodes  = (int) std::ceil(mem / node_mem);
+  return std::clamp(std::max(work_nodes, mem_nodes), 1, nnodes);
+}
+
+//
+//  MO is the CCSD space and nchol the number of Cholesky vectors. allocated_mem (GiB in all) is
+//  what is allocated when CCSD starts; overlap is only considered if can_overlap.
+//
+inline ccsd_t_phase_plan ccsd_t_plan_phases(ExecutionContext& ec, const SystemData& sys_data,
+                                            const TiledIndexSpace& MO, double nchol,
+                                            double allocated_mem, bool can_overlap) {
+  const CCSDOptions& ccsd_options = sys_data.options_map.ccsd_options;
+  const double       gib          = 1024 * 1024 * 1024.0;
+
+  ccsd_t_phase_plan plan;
+  plan.nnodes = ec.nnodes();
+  plan.ppn    = ec.ppn();
+
+  const double total_mem = static_cast<double>(ec.mem_info().total_cpu_mem);
+  const double node_mem  = total_mem / plan.nnodes;
+  const double O         = MO("occ").max_num_indices();
+  const double V         = MO("virt").max_num_indices();
+  const double ot        = MO("occ").num_tiles();
+  const double vt        = MO("virt").num_tiles();
+  const double N1        = sys_data.nocc + sys_data.nvir;
+
+  // tiles of the (T) space, before ccsdt_autotune may change the tile size
+  auto         tiles = ccsd_t_autotune_tiles(sys_data, ccsd_options.ccsdt_tilesize);
+  const double ot1   = tiles[0].size() + tiles[1].size();
+  const double vt1   = tiles[2].size() + tiles[3].size();
+
+  // CCSD: blocks of t2; intermediates of a few t2 and Cholesky-transformed ov, vv sizes
+  const double ccsd_mem = (4 * O * O * V * V + (3 * O * V + V * V) * nchol) * 8 / gib;
+  plan.ccsd_nodes = ccsd_options.ccsdt_ccsd_nodes > 0
+                      ? std::min(ccsd_options.ccsdt_ccsd_nodes, plan.nnodes)
+                      : ccsd_t_phase_nodes(ot * ot * vt * vt, ccsd_mem, node_mem, plan.nnodes,
+                                           plan.ppn);
+
+  // v2 setup: blocks of v2iabc; it allocates nothing beyond the v2 tensors on its ranks
+  plan.v2_nodes = ccsd_options.ccsdt_v2_nodes > 0
+                    ? std::min(ccsd_options.ccsdt_v2_nodes, plan.nnodes)
+                    : ccsd_t_phase_nodes(ot1 * vt1 * vt1 * vt1, 0, node_mem, plan.nnodes, plan.ppn);
+
+  const int idle_nodes = plan.nnodes - plan.ccsd_nodes;
+  if(can_overlap && ccsd_options.ccsdt_phase_overlap && idle_nodes > 0) {
+    const double v2_mem  = (O * O * V * V + O * O * O * V + O * V * V * V) * 8 / gib;
+    const double cv2_mem = N1 * N1 * nchol * 8 / gib;
+    if(allocated_mem + ccsd_mem + v2_mem + cv2_mem <= total_mem) {
+      plan.overlap  = true;
+      plan.v2_nodes = std::min(plan.v2_nodes, idle_nodes);
+    }
+  }
+
+  // without overlap, the nodes the model leaves out of CCSD would only wait for it
+  if(!plan.overlap && ccsd_options.ccsdt_ccsd_nodes <= 0) plan.ccsd_nodes = plan.nnodes;
+  return plan;
+}
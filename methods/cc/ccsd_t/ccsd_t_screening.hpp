@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ccsd_t_chol_iabc.hpp"
+#include "tamm/tamm.hpp"
+
+#include <cmath>
+#include <mpi.h>
+#include <vector>
+
+//
+//  integral-screened (T). the max-norms of every tile of t1, t2 and the v2 blocks bound each
+//  element of a task's triples,
+//
+//    |t3c| <= sum [ sum_E n_E |t2(A,E,Q,R)| |v2iabc(P,E,B,C)|
+//                   + sum_M n_M |t2(B,C,P,M)| |v2ijka(Q,R,M,A)| ]
+//    |t3d| <= sum |t1(A,P)| |v2ijab(Q,R,B,C)|
+//
+//  where the outer sums run over the nine (P;Q,R) x (A;B,C) permutations of the task's tiles and
+//  n_E, n_M are tile sizes. with the smallest denominator D of the task's tiles, the (T)
+//  contribution of a task is at most factor * N |t3c| (|t3c| + |t3d|) / D for its N elements,
+//  which also bounds [T]. tasks whose bound is below the threshold are skipped; the sum of their
+//  bounds bounds the error of [T] and (T).
+//
+class ccsd_t_screening {
+public:
+  bool   enabled() const { return threshold_ > 0; }
+  double threshold() const { return threshold_; }
+
+  // collective. tile indices are those of the (T) MO space, occupied tiles first
+  template<typename T>
+  void init(ExecutionContext& ec, double threshold, size_t noab, size_t nvab,
+            const std::vector<size_t>& k_range, const std::vector<T>& k_evl_sorted,
+            Tensor<T>& d_t1, Tensor<T>& d_t2, V2Tensors<T>& d_v2) {
+    threshold_ = threshold;
+    noab_      = noab;
+    nvab_      = nvab;
+    range_     = k_range;
+    skipped    = 0;
+    error      = 0;
+
+    // highest occupied and lowest virtual orbital energy of each tile
+    size_t offset = 0;
+    evl_.clear();
+    for(size_t t = 0; t < noab + nvab; t++) {
+      auto first = k_evl_sorted.begin() + offset, last = first + k_range[t];
+      evl_.push_back(t < noab ? *std::max_element(first, last) : *std::min_element(first, last));
+      offset += k_range[t];
+    }
+
+    const size_t o = noab, v = nvab;
+    t1_   = tile_norms(ec, d_t1, {v, o});
+    t2_   = tile_norms(ec, d_t2, {v, v, o, o});
+    ijab_ = tile_norms(ec, d_v2.v2ijab, {o, o, v, v});
+    ijka_ = tile_norms(ec, d_v2.v2ijka, {o, o, o, v});
+    iabc_ = ccsdt_chol_iabc.enabled() ? ccsdt_chol_iabc.tile_norms(ec, nvab)
+                                      : tile_norms(ec, d_v2.v2iabc, {o, v, v, v});
+  }
+
+  // bound of the (T) contribution of a task; tiles are (T) MO space indices
+  double bound(size_t t_h1b, size_t t_h2b, size_t t_h3b, size_t t_p4b, size_t t_p5b,
+               size_t t_p6b, double factor) const {
+    const size_t o = noab_, v = nvab_;
+    const size_t h[3][3] = {{t_h1b, t_h2b, t_h3b}, {t_h2b, t_h1b, t_h3b}, {t_h3b, t_h2b, t_h1b}};
+    const size_t p[3][3] = {{t_p4b - o, t_p5b - o, t_p6b - o},
+                            {t_p5b - o, t_p4b - o, t_p6b - o},
+                            {t_p6b - o, t_p5b - o, t_p4b - o}};
+
+    double conn = 0, disc = 0;
+    for(auto& hp: h)
+      for(auto& pp: p) {
+        const size_t P = hp[0], Q = hp[1], R = hp[2], A = pp[0], B = pp[1], C = pp[2];
+        for(size_t E = 0; E < v; E++)
+          conn += range_[o + E] * t2_[((A * v + E) * o + Q) * o + R] *
+                  iabc_[((P * v + E) * v + B) * v + C];
+        for(size_t M = 0; M < o; M++)
+          conn += range_[M] * t2_[((B * v + C) * o + P) * o + M] *
+                  ijka_[((Q * o + R) * o + M) * v + A];
+        disc += t1_[A * o + P] * ijab_[((Q * o + R) * v + B) * v + C];
+      }
+
+    const double denom = evl_[t_p4b] + evl_[t_p5b] + evl_[t_p6b] - evl_[t_h1b] - evl_[t_h2b] -
+                         evl_[t_h3b];
+    const double nelem = (double) range_[t_h1b] * range_[t_h2b] * range_[t_h3b] * range_[t_p4b] *
+                         range_[t_p5b] * range_[t_p6b];
+    return std::abs(factor) * nelem * conn * (conn + disc) / denom;
+  }
+
+  // true if the task is screened out, which adds it to skipped and its bound to error
+  bool skip(size_t t_h1b, size_t t_h2b, size_t t_h3b, size_t t_p4b, size_t t_p5b, size_t t_p6b,
+            double factor) {
+    if(!enabled()) return false;
+    const double b = bound(t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor);
+    if(b >= threshold_) return false;
+    skipped++;
+    error += b;
+    return true;
+  }
+
+  double skipped = 0; // tasks skipped by this rank
+  double error   = 0; // sum of their bounds
+
+private:
+  // max-norm of every block of a tensor over the given numbers of tiles, on every rank
+  template<typename T>
+  static std::vector<double> tile_norms(ExecutionContext& ec, Tensor<T>& tensor,
+                                        const std::vector<size_t>& ntiles) {
+    size_t size = 1;
+    for(auto n: ntiles) size *= n;
+    std::vector<double> norms(size, 0);
+
+    auto block_norm = [&](const IndexVector& blockid) {
+      if(!tensor.is_non_zero(blockid)) return;
+      std::vector<T> buf(tensor.block_size(blockid));
+      tensor.get(blockid, buf);
+      size_t idx = 0;
+      for(size_t d = 0; d < ntiles.size(); d++) idx = idx * ntiles[d] + blockid[d];
+      for(auto x: buf) norms[idx] = std::max(norms[idx], (double) std::abs(x));
+    };
+    block_for(ec, tensor(), block_norm);
+
+    MPI_Allreduce(MPI_IN_PLACE, norms.data(), size, MPI_DOUBLE, MPI_MAX, ec.pg().comm());
+    return norms;
+  }
+
+  double              threshold_ = 0;
+  size_t              noab_ = 0, nvab_ = 0;
+  std::vector<size_t> range_;
+  std::vector<double> evl_;
+  std::vector<double> t1_, t2_, ijab_, ijka_, iabc_;
+};
+
+extern ccsd_t_screening ccsdt_screening;
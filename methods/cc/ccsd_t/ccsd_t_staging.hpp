@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ccsd_t_node_cache.hpp"
+#include "tamm/tamm.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+extern int        ccsdt_stage_threads;
+extern double     ccsd_t_data_per_rank;
+extern std::mutex ccsdt_ga_lock;
+
+//
+//  a call into the runtime's one-sided communication (a block get or the task counter). these
+//  are not guaranteed to be thread-safe, and with prefetch the staging thread gets blocks while
+//  the main thread takes tasks, so every such call of the (T) driver is made under one lock.
+//
+template<typename Fn>
+auto ccsd_t_ga_call(Fn&& fn) {
+  std::lock_guard<std::mutex> lock(ccsdt_ga_lock);
+  return fn();
+}
+
+//
+//  a get of a (T) input block of n elements of T from a staging thread, timed into time. the
+//  gets are issued one at a time (see ccsd_t_ga_call) while the other staging threads transpose
+//  and copy.
+//
+template<typename T, typename Fn>
+void ccsd_t_stage_get(double* time, size_t n, Fn&& get) {
+  ccsd_t_ga_call([&] {
+    TimerGuard tg_total{time};
+    ccsd_t_data_per_rank += n * sizeof(T);
+    get();
+  });
+}
+
+//
+//  stages the blocks of one (T) equation into their slots of the kernel buffers. add() looks a
+//  block up in the LRU and node-shared caches in order, as the serial loops did; run() then has
+//  the misses fetched and transposed into their slots by a team of ccsdt_stage_threads threads,
+//  and fills the caches in order again. a block missed twice is fetched once and copied.
+//
+template<typename T>
+class ccsd_t_stager {
+public:
+  // fills the slot (dim elements) from the tensors; scratch is a per-thread buffer
+  using fetch_fn = std::function<void(std::vector<T>& scratch, T* slot)>;
+
+  void add(ccsd_t_node_cache_id id, LRUCache<Index, std::vector<T>>& cache, const IndexVector& key,
+           T* slot, size_t dim, fetch_fn fetch) {
+    auto [hit, value] = cache.log_access(key);
+    ccsd_t_lru_count(id, hit);
+
+    auto pending = pending_.find({id, key});
+    if(pending != pending_.end()) copies_.push_back({misses_[pending->second].slot, slot, dim});
+    else if(hit) std::copy(value.begin(), value.end(), slot);
+    else if(ccsdt_node_cache.get(id, key, slot, dim)) value.assign(slot, slot + dim);
+    else {
+      pending_[{id, key}] = misses_.size();
+      misses_.push_back({id, &cache, key, slot, dim, std::move(fetch)});
+    }
+  }
+
+  void run() {
+    const int64_t num_misses = (int64_t) misses_.size();
+#pragma omp parallel num_threads(ccsdt_stage_threads) if(num_misses > 1)
+    {
+      std::vector<T> scratch;
+#pragma omp for schedule(dynamic)
+      for(int64_t i = 0; i < num_misses; i++) misses_[i].fetch(scratch, misses_[i].slot);
+    }
+
+    for(auto& miss: misses_) {
+      // the entry made by add() may have been evicted since
+      auto [hit, value] = miss.cache->log_access(miss.key);
+      value.assign(miss.slot, miss.slot + miss.dim);
+      ccsdt_node_cache.put(miss.id, miss.key, miss.slot, miss.dim);
+    }
+    for(auto& copy: copies_) std::copy(copy.src, copy.src + copy.dim, copy.dst);
+
+    pending_.clear();
+    misses_.clear();
+    copies_.clear();
+  }
+
+private:
+  struct miss {
+    ccsd_t_node_cache_id             id;
+    LRUCache<Index, std::vector<T>>* cache;
+    IndexVector                      key;
+    T*                               slot;
+    size_t                           dim;
+    fetch_fn                         fetch;
+  };
+  struct copy {
+    const T* src;
+    T*       dst;
+    size_t   dim;
+  };
+
+  std::map<std::pair<int, IndexVector>, size_t> pending_;
+  std::vector<miss>                              misses_;
+  std::vector<copy>                              copies_;
+};
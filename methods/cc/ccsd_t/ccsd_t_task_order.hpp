@@ -0,0 +1,261 @@
+#pragma once
+
+#include "fused_common.hpp"
+
+#include <array>
+#include <list>
+#include <queue>
+#include <unordered_map>
+
+//
+//  locality-aware (T) task orders. whether a block is found in the per-rank LRU caches only
+//  depends on the order in which a rank visits its tasks, so the candidate orders are compared
+//  by replaying the block lookups of one rank through LRU caches of the same capacities before
+//  the run. the candidates are
+//    h14256  - the hand-chosen seq_h3b loop order (h1,p4,h2,p5,p6,h3)
+//    p456123 - the task list order (p4,p5,p6,h1,h2,h3)
+//    morton  - a Z-order curve over (h1,h2,p4,p5), then p6,h3
+//    blocked - tiles of ccsd_t_order_block^4 (h1,h2,p4,p5) blocks, h14256 order in and across
+//
+inline const std::vector<std::string> ccsd_t_task_orders = {"h14256", "p456123", "morton",
+                                                            "blocked"};
+constexpr size_t ccsd_t_order_block = 4;
+
+// tasks of the replayed rank, enough to fill the caches many times over
+constexpr size_t ccsd_t_replay_tasks = 20000;
+
+//
+//  guided self-scheduling over an ordered task list: the chunk starting at first covers about
+//  1/(2 nranks) of the operations left (remaining_ops[i] = ops of tasks i..n-1), at least one task
+//
+inline int64_t ccsd_t_guided_chunk(const std::vector<long double>& remaining_ops, int64_t first,
+                                   int64_t nranks) {
+  const int64_t ntasks = (int64_t) remaining_ops.size() - 1;
+  if(first >= ntasks) return 1;
+  const long double bound = remaining_ops[first] - remaining_ops[first] / (2.0 * nranks);
+  // tasks first..last-1 keep remaining_ops >= bound
+  auto last = std::upper_bound(remaining_ops.begin() + first + 1, remaining_ops.end(), bound,
+                               std::greater<long double>());
+  return std::max<int64_t>(1, (last - remaining_ops.begin()) - 1 - first);
+}
+
+template<typename T>
+std::vector<size_t>
+ccsd_t_task_order(const std::string& name, const Index noab,
+                  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>>&
+                    list_tasks) {
+  const size_t                         ntasks = list_tasks.size();
+  std::vector<std::array<uint64_t, 6>> keys(ntasks);
+
+  auto morton = [](uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+    uint64_t key = 0;
+    for(int bit = 0; bit < 16; bit++)
+      key |= (((a >> bit) & 1) << (4 * bit + 3)) | (((b >> bit) & 1) << (4 * bit + 2)) |
+             (((c >> bit) & 1) << (4 * bit + 1)) | (((d >> bit) & 1) << (4 * bit));
+    return key;
+  };
+
+  for(size_t i = 0; i < ntasks; i++) {
+    auto [h1, h2, h3, p4, p5, p6, factor] = list_tasks[i];
+    p4 -= noab;
+    p5 -= noab;
+    p6 -= noab;
+    if(name == "h14256") keys[i] = {h1, p4, h2, p5, p6, h3};
+    else if(name == "morton") keys[i] = {morton(h1, h2, p4, p5), p6, h3, 0, 0, 0};
+    else if(name == "blocked") {
+      const size_t b = ccsd_t_order_block;
+      keys[i]        = {(h1 / b) * 0x10000 + p4 / b, (h2 / b) * 0x10000 + p5 / b,
+                        h1 * 0x10000 + p4,           h2 * 0x10000 + p5,
+                        p6,                          h3};
+    }
+    else keys[i] = {i, 0, 0, 0, 0, 0};
+  }
+
+  std::vector<size_t> order(ntasks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+  return order;
+}
+
+//
+//  tasks of rank 0 when the ordered list is handed out in guided chunks and every rank takes
+//  the next chunk as soon as it is idle, with the time of a task taken as its operations
+//
+inline std::vector<size_t> ccsd_t_task_order_stream(const std::vector<size_t>&      order,
+                                                    const std::vector<long double>& task_ops,
+                                                    int64_t nranks, size_t max_tasks) {
+  const int64_t            ntasks = order.size();
+  std::vector<long double> remaining_ops(ntasks + 1, 0);
+  for(int64_t i = ntasks - 1; i >= 0; i--)
+    remaining_ops[i] = remaining_ops[i + 1] + task_ops[order[i]];
+
+  using busy_rank = std::pair<long double, int64_t>;
+  std::priority_queue<busy_rank, std::vector<busy_rank>, std::greater<busy_rank>> idle;
+  for(int64_t r = 0; r < nranks; r++) idle.push({0, r});
+
+  std::vector<size_t> stream;
+  for(int64_t first = 0; first < ntasks && stream.size() < max_tasks;) {
+    const int64_t chunk = ccsd_t_guided_chunk(remaining_ops, first, nranks);
+    const int64_t last  = std::min(first + chunk, ntasks);
+    auto [busy, r]      = idle.top();
+    idle.pop();
+    if(r == 0)
+      for(int64_t i = first; i < last; i++) stream.push_back(order[i]);
+    idle.push({busy + remaining_ops[first] - remaining_ops[last], r});
+    first = last;
+  }
+  if(stream.size() > max_tasks) stream.resize(max_tasks);
+  return stream;
+}
+
+class ccsd_t_lru_replay {
+public:
+  explicit ccsd_t_lru_replay(size_t capacity): capacity_(capacity) {}
+
+  bool access(uint64_t key) {
+    auto it = map_.find(key);
+    if(it != map_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return true;
+    }
+    if(capacity_ == 0) return false;
+    if(map_.size() == capacity_) {
+      map_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(key);
+    map_[key] = lru_.begin();
+    return false;
+  }
+
+private:
+  size_t                                                      capacity_;
+  std::list<uint64_t>                                         lru_;
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> map_;
+};
+
+// simulated lookups and hits per cache id, and the elements fetched on a miss
+struct ccsd_t_replay_stats {
+  double lookups[CCSDT_CACHE_D2V + 1] = {};
+  double hits[CCSDT_CACHE_D2V + 1]    = {};
+  double fetched                      = 0;
+  double tasks                        = 0;
+};
+
+template<typename T>
+ccsd_t_replay_stats ccsd_t_task_order_replay(
+  bool                                                                        is_restricted,
+  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>>& list_tasks,
+  const std::vector<size_t>& stream, const Index noab, const Index nvab, std::vector<int>& k_spin,
+  std::vector<size_t>& k_range, std::vector<T>& k_evl_sorted, size_t cache_size) {
+  // the capacities of the caches set up in CCSD_T.cpp, and which key positions are virtuals
+  ccsd_t_lru_replay caches[] = {ccsd_t_lru_replay(0),
+                                ccsd_t_lru_replay(cache_size),
+                                ccsd_t_lru_replay(cache_size),
+                                ccsd_t_lru_replay(cache_size * noab),
+                                ccsd_t_lru_replay(cache_size * noab),
+                                ccsd_t_lru_replay(cache_size * nvab),
+                                ccsd_t_lru_replay(cache_size * nvab)};
+  const bool virt[][4]       = {{0, 0, 0, 0}, {1, 0, 0, 0}, {0, 0, 1, 1}, {1, 1, 0, 0},
+                                {0, 0, 0, 1}, {1, 1, 0, 0}, {0, 1, 1, 1}};
+
+  std::vector<int> df_simple_s1_size(6), df_simple_s1_exec(9);
+  std::vector<int> df_simple_d1_size(7 * noab), df_simple_d1_exec(9 * noab);
+  std::vector<int> df_simple_d2_size(7 * nvab), df_simple_d2_exec(9 * nvab);
+  std::vector<IndexVector> keys[CCSDT_CACHE_D2V + 1];
+
+  ccsd_t_replay_stats stats;
+  stats.tasks = stream.size();
+  for(auto current_id: stream) {
+    auto [t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor] = list_tasks[current_id];
+
+    int    num_enabled_kernels = 0;
+    size_t total_comm_data     = 0;
+    for(auto& k: keys) k.clear();
+
+    ccsd_t_data_s1_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_s1_size.data(),
+                             df_simple_s1_exec.data(), &num_enabled_kernels, total_comm_data,
+                             &keys[CCSDT_CACHE_S1T], &keys[CCSDT_CACHE_S1V]);
+    ccsd_t_data_d1_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d1_size.data(),
+                             df_simple_d1_exec.data(), &num_enabled_kernels, total_comm_data,
+                             &keys[CCSDT_CACHE_D1T], &keys[CCSDT_CACHE_D1V]);
+    ccsd_t_data_d2_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d2_size.data(),
+                             df_simple_d2_exec.data(), &num_enabled_kernels, total_comm_data,
+                             &keys[CCSDT_CACHE_D2T], &keys[CCSDT_CACHE_D2V]);
+
+    for(int id = CCSDT_CACHE_S1T; id <= CCSDT_CACHE_D2V; id++) {
+      for(auto& bids: keys[id]) {
+        uint64_t key   = 0;
+        double   elems = 1;
+        for(size_t i = 0; i < bids.size(); i++) {
+          key = (key << 16) | bids[i];
+          elems *= k_range[bids[i] + (virt[id][i] ? noab : 0)];
+        }
+        stats.lookups[id]++;
+        if(caches[id].access(key)) stats.hits[id]++;
+        else stats.fetched += elems;
+      }
+    }
+  }
+  return stats;
+}
+
+//
+//  the name of the order used by the driver: the given one, or with "auto" the candidate with
+//  the least simulated data transfer. candidates are replayed on different ranks; rank 0 logs
+//  the simulated hit rates of every candidate it was given.
+//
+template<typename T>
+std::string ccsd_t_locality_order(
+  ExecutionContext& ec, const std::string& task_order, bool is_restricted,
+  std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>>& list_tasks,
+  const std::vector<long double>& task_ops, const Index noab, const Index nvab,
+  std::vector<int>& k_spin, std::vector<size_t>& k_range, std::vector<T>& k_evl_sorted,
+  size_t cache_size) {
+  const auto    rank   = ec.pg().rank().value();
+  const int64_t nranks = ec.pg().size().value();
+
+  std::vector<std::string> candidates = ccsd_t_task_orders;
+  if(task_order != "auto") candidates = {task_order};
+
+  // lookups and hits per cache id, fetched elements, replayed tasks
+  constexpr int       nstats = 2 * (CCSDT_CACHE_D2V + 1) + 2;
+  std::vector<double> results(candidates.size() * nstats, 0);
+  for(size_t c = 0; c < candidates.size(); c++) {
+    if((int64_t) c % nranks != rank) continue;
+    auto order  = ccsd_t_task_order(candidates[c], noab, list_tasks);
+    auto stream = ccsd_t_task_order_stream(order, task_ops, nranks, ccsd_t_replay_tasks);
+    auto stats  = ccsd_t_task_order_replay(is_restricted, list_tasks, stream, noab, nvab, k_spin,
+                                           k_range, k_evl_sorted, cache_size);
+    std::copy(stats.lookups, stats.lookups + CCSDT_CACHE_D2V + 1, &results[c * nstats]);
+    std::copy(stats.hits, stats.hits + CCSDT_CACHE_D2V + 1,
+              &results[c * nstats + CCSDT_CACHE_D2V + 1]);
+    results[c * nstats + nstats - 2] = stats.fetched;
+    results[c * nstats + nstats - 1] = stats.tasks;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, results.data(), results.size(), MPI_DOUBLE, MPI_SUM,
+                ec.pg().comm());
+
+  size_t best = 0;
+  for(size_t c = 0; c < candidates.size(); c++) {
+    const double* r = &results[c * nstats];
+    if(r[nstats - 2] < results[best * nstats + nstats - 2]) best = c;
+    if(rank != 0) continue;
+    std::cout << "task order " << candidates[c] << ": simulated LRU hit rates";
+    for(int id = CCSDT_CACHE_S1T; id <= CCSDT_CACHE_D2V; id++) {
+      const double lookups = r[id], hits = r[CCSDT_CACHE_D2V + 1 + id];
+      std::cout << " " << ccsd_t_cache_names[id] << " "
+                << (lookups > 0 ? hits * 100.0 / lookups : 0.0) << "%";
+    }
+    std::cout << ", fetched " << r[nstats - 2] * 8.0 / (1024 * 1024.0 * 1024) << " GB in "
+              << r[nstats - 1] << " tasks of rank 0" << std::endl;
+  }
+  if(rank == 0)
+    std::cout << "locality-aware task order: " << candidates[best] << std::endl << std::endl;
+
+  return candidates[best];
+}
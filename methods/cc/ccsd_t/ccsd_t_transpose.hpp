@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+//
+//  transposes of the (T) input blocks, specialized at compile time for the fixed permutations
+//  of the singles/doubles data drivers. the convention is that of hptt with row-major
+//  storage: B has the extents size[P0..P3] and B(a[P0],a[P1],a[P2],a[P3]) = alpha * A(a0..a3),
+//  with the last index the fastest in both. the output is written straight into the kernel's
+//  buffer, so no plan is created per block and no intermediate copy is needed.
+//
+//  when A and B share their fastest index the rows are scaled and copied; otherwise the two
+//  fastest indices are walked in ccsd_t_transpose_tile^2 tiles, so that both the reads of A and
+//  the writes of B stay within a few cache lines.
+//
+constexpr int ccsd_t_transpose_tile = 16;
+
+template<int P0, int P1, int P2, int P3, typename T>
+void ccsd_t_transpose(T alpha, const T* A, const int size[4], T* B) {
+  constexpr int perm[4] = {P0, P1, P2, P3};
+
+  // strides of A and B, both by index of A
+  size_t stride_a[4], stride_b[4];
+  stride_a[3] = 1;
+  for(int d = 2; d >= 0; d--) stride_a[d] = stride_a[d + 1] * size[d + 1];
+  size_t s = 1;
+  for(int k = 3; k >= 0; k--) {
+    stride_b[perm[k]] = s;
+    s *= size[perm[k]];
+  }
+
+  if constexpr(P3 == 3) {
+    for(int a0 = 0; a0 < size[0]; a0++)
+      for(int a1 = 0; a1 < size[1]; a1++)
+        for(int a2 = 0; a2 < size[2]; a2++) {
+          const T* src = A + a0 * stride_a[0] + a1 * stride_a[1] + a2 * stride_a[2];
+          T*       dst = B + a0 * stride_b[0] + a1 * stride_b[1] + a2 * stride_b[2];
+          for(int a3 = 0; a3 < size[3]; a3++) dst[a3] = alpha * src[a3];
+        }
+  }
+  else {
+    // x: fastest index of B, y: fastest index of A, o1/o2: the remaining two
+    constexpr int x  = P3;
+    constexpr int o1 = (x != 0) ? 0 : 1;
+    constexpr int o2 = 3 - x - o1;
+    static_assert(o1 != o2 && o2 != x && o2 != 3, "invalid permutation");
+
+    constexpr int tile = ccsd_t_transpose_tile;
+    for(int i1 = 0; i1 < size[o1]; i1++)
+      for(int i2 = 0; i2 < size[o2]; i2++) {
+        const T* src = A + i1 * stride_a[o1] + i2 * stride_a[o2];
+        T*       dst = B + i1 * stride_b[o1] + i2 * stride_b[o2];
+        for(int xb = 0; xb < size[x]; xb += tile)
+          for(int yb = 0; yb < size[3]; yb += tile) {
+            const int xe = std::min(xb + tile, size[x]);
+            const int ye = std::min(yb + tile, size[3]);
+            for(int ix = xb; ix < xe; ix++)
+              for(int iy = yb; iy < ye; iy++)
+                dst[ix + iy * stride_b[3]] = alpha * src[ix * stride_a[x] + iy];
+          }
+      }
+  }
+}
+
+// B(a1,a0) = alpha * A(a0,a1)
+template<typename T>
+void ccsd_t_transpose_2d(T alpha, const T* A, const int size[2], T* B) {
+  constexpr int tile = ccsd_t_transpose_tile;
+  for(int xb = 0; xb < size[0]; xb += tile)
+    for(int yb = 0; yb < size[1]; yb += tile) {
+      const int xe = std::min(xb + tile, size[0]);
+      const int ye = std::min(yb + tile, size[1]);
+      for(int iy = yb; iy < ye; iy++)
+        for(int ix = xb; ix < xe; ix++) B[iy * size[0] + ix] = alpha * A[ix * size[1] + iy];
+    }
+}
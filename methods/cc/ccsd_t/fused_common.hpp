@@ -13,95 +13,84 @@ void helper_calculate_num_ops(const Index noab, const Index nvab, int* df_simple
                               long double& total_num_ops_s1, long double& total_num_ops_d1,
                               long double& total_num_ops_d2);
 
+extern double ccsdt_num_ops;
+
+//
+//  adds the number of operations of a task, from the size and exec arrays its blocks were
+//  fetched with, to ccsdt_num_ops. every rank counts the tasks it actually runs (not the ones
+//  screened out or restored from a checkpoint), and the counts are reduced after the run.
+//
+inline void ccsd_t_count_task_ops(const Index noab, const Index nvab, int* df_simple_s1_size,
+                                  int* df_simple_d1_size, int* df_simple_d2_size,
+                                  int* df_simple_s1_exec, int* df_simple_d1_exec,
+                                  int* df_simple_d2_exec) {
+  long double task_num_ops_s1 = 0, task_num_ops_d1 = 0, task_num_ops_d2 = 0;
+  long double total_num_ops_s1 = 0, total_num_ops_d1 = 0, total_num_ops_d2 = 0;
+  helper_calculate_num_ops(noab, nvab, df_simple_s1_size, df_simple_d1_size, df_simple_d2_size,
+                           df_simple_s1_exec, df_simple_d1_exec, df_simple_d2_exec, task_num_ops_s1,
+                           task_num_ops_d1, task_num_ops_d2, total_num_ops_s1, total_num_ops_d1,
+                           total_num_ops_d2);
+  ccsdt_num_ops += (double) (task_num_ops_s1 + task_num_ops_d1 + task_num_ops_d2);
+}
+
+//
+//  number of operations of every task in list_tasks, counted as in ccsd_t_count_task_ops. the
+//  tasks are split over the ranks and the counts summed over them. collective over ec.
+//
 template<typename T>
-long double ccsd_t_fully_fused_performance(
-  bool                                                                        is_restricted,
+std::vector<long double> ccsd_t_fully_fused_task_ops(
+  ExecutionContext& ec, bool is_restricted,
   std::vector<std::tuple<size_t, size_t, size_t, size_t, size_t, size_t, T>>& list_tasks,
-  int64_t rank, int task_stride, const Index noab, const Index nvab, std::vector<int>& k_spin,
-  std::vector<size_t>& k_range, std::vector<size_t>& k_offset, std::vector<T>& k_evl_sorted) {
-  //
+  const Index noab, const Index nvab, std::vector<int>& k_spin, std::vector<size_t>& k_range,
+  std::vector<T>& k_evl_sorted) {
+  std::vector<int> df_simple_s1_size(6), df_simple_s1_exec(9);
+  std::vector<int> df_simple_d1_size(7 * noab), df_simple_d1_exec(9 * noab);
+  std::vector<int> df_simple_d2_size(7 * nvab), df_simple_d2_exec(9 * nvab);
+
   long double total_num_ops_s1 = 0;
   long double total_num_ops_d1 = 0;
   long double total_num_ops_d2 = 0;
-  // long double total_num_ops_total = 0;
 
-  //
-  int* df_simple_s1_size = (int*) malloc(sizeof(int) * (6));
-  int* df_simple_s1_exec = (int*) malloc(sizeof(int) * (9));
-  int* df_simple_d1_size = (int*) malloc(sizeof(int) * (7 * noab));
-  int* df_simple_d1_exec = (int*) malloc(sizeof(int) * (9 * noab));
-  int* df_simple_d2_size = (int*) malloc(sizeof(int) * (7 * nvab));
-  int* df_simple_d2_exec = (int*) malloc(sizeof(int) * (9 * nvab));
+  const size_t rank   = ec.pg().rank().value();
+  const size_t nranks = ec.pg().size().value();
 
-  //
-  unsigned int init_id = rank;
-  // unsigned int offset_current = 0;
-  // unsigned int offset_next    = 1;
+  std::vector<long double> task_ops(list_tasks.size(), 0);
+  for(size_t current_id = rank; current_id < list_tasks.size(); current_id += nranks) {
+    auto [t_h1b, t_h2b, t_h3b, t_p4b, t_p5b, t_p6b, factor] = list_tasks[current_id];
 
-  for(unsigned int current_id = init_id; current_id < list_tasks.size();
-      current_id += task_stride) {
-    //
-    long double task_num_ops_s1 = 0;
-    long double task_num_ops_d1 = 0;
-    long double task_num_ops_d2 = 0;
-    // long double task_num_ops_total = 0;
-    size_t total_comm_data = 0;
-
-    //
-    int num_s1_enabled_kernels = 0;
-    int num_d1_enabled_kernels = 0;
-    int num_d2_enabled_kernels = 0;
-
-    //
-    size_t t_h1b = std::get<0>(list_tasks[(int) current_id]);
-    size_t t_h2b = std::get<1>(list_tasks[(int) current_id]);
-    size_t t_h3b = std::get<2>(list_tasks[(int) current_id]);
-    size_t t_p4b = std::get<3>(list_tasks[(int) current_id]);
-    size_t t_p5b = std::get<4>(list_tasks[(int) current_id]);
-    size_t t_p6b = std::get<5>(list_tasks[(int) current_id]);
-
-    //
-    std::fill(df_simple_s1_exec, df_simple_s1_exec + (9), -1);
-    std::fill(df_simple_d1_exec, df_simple_d1_exec + (9 * noab), -1);
-    std::fill(df_simple_d2_exec, df_simple_d2_exec + (9 * nvab), -1);
+    int    num_s1_enabled_kernels = 0;
+    int    num_d1_enabled_kernels = 0;
+    int    num_d2_enabled_kernels = 0;
+    size_t total_comm_data        = 0;
 
-    ccsd_t_data_s1_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
-                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_s1_size, df_simple_s1_exec,
-                             &num_s1_enabled_kernels, total_comm_data);
+    std::fill(df_simple_s1_exec.begin(), df_simple_s1_exec.end(), -1);
+    std::fill(df_simple_d1_exec.begin(), df_simple_d1_exec.end(), -1);
+    std::fill(df_simple_d2_exec.begin(), df_simple_d2_exec.end(), -1);
 
+    ccsd_t_data_s1_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_s1_size.data(),
+                             df_simple_s1_exec.data(), &num_s1_enabled_kernels, total_comm_data);
     ccsd_t_data_d1_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
-                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d1_size, df_simple_d1_exec,
-                             &num_d1_enabled_kernels, total_comm_data);
-
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d1_size.data(),
+                             df_simple_d1_exec.data(), &num_d1_enabled_kernels, total_comm_data);
     ccsd_t_data_d2_info_only(is_restricted, noab, nvab, k_spin, k_evl_sorted, k_range, t_h1b, t_h2b,
-                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d2_size, df_simple_d2_exec,
-                             &num_d2_enabled_kernels, total_comm_data);
-
-    // printf ("[%s] each_kernel[%4d] >> total: %lu\n", __func__, current_id, total_comm_data);
-
-    // size_t total_enabled_kernels = num_s1_enabled_kernels + num_d1_enabled_kernels +
-    // num_d2_enabled_kernels; printf ("[%s] each_kernel[%4d] s1: %d, d1: %d, d2: %d >> total:
-    // %lu\n", __func__, current_id, num_s1_enabled_kernels, num_d1_enabled_kernels,
-    // num_d2_enabled_kernels, total_enabled_kernels);
-
-    //
-    helper_calculate_num_ops(noab, nvab, df_simple_s1_size, df_simple_d1_size, df_simple_d2_size,
-                             df_simple_s1_exec, df_simple_d1_exec, df_simple_d2_exec,
-                             task_num_ops_s1, task_num_ops_d1, task_num_ops_d2, total_num_ops_s1,
-                             total_num_ops_d1, total_num_ops_d2);
+                             t_h3b, t_p4b, t_p5b, t_p6b, df_simple_d2_size.data(),
+                             df_simple_d2_exec.data(), &num_d2_enabled_kernels, total_comm_data);
 
-    // long double total_each = task_num_ops_s1 + task_num_ops_d1 + task_num_ops_d2;
-    // printf ("[%s] each task >> s1: %lu, d1: %lu, d2: %lu >> total: %lu\n", __func__,
-    // task_num_ops_s1, task_num_ops_d1, task_num_ops_d2, total_each);
+    long double task_num_ops_s1 = 0;
+    long double task_num_ops_d1 = 0;
+    long double task_num_ops_d2 = 0;
+    helper_calculate_num_ops(noab, nvab, df_simple_s1_size.data(), df_simple_d1_size.data(),
+                             df_simple_d2_size.data(), df_simple_s1_exec.data(),
+                             df_simple_d1_exec.data(), df_simple_d2_exec.data(), task_num_ops_s1,
+                             task_num_ops_d1, task_num_ops_d2, total_num_ops_s1, total_num_ops_d1,
+                             total_num_ops_d2);
+    task_ops[current_id] = task_num_ops_s1 + task_num_ops_d1 + task_num_ops_d2;
   }
+  MPI_Allreduce(MPI_IN_PLACE, task_ops.data(), task_ops.size(), MPI_LONG_DOUBLE, MPI_SUM,
+                ec.pg().comm());
 
-  //
-  long double total_overall = total_num_ops_s1 + total_num_ops_d1 + total_num_ops_d2;
-  // printf ("[%s] total task >> s1: %lu, d1: %lu, d2: %lu >> total: %lu\n", __func__,
-  // total_num_ops_s1, total_num_ops_d1, total_num_ops_d2, total_overall);
-
-  //
-  return total_overall;
+  return task_ops;
 }
 
 //
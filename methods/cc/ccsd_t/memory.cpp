@@ -1,7 +1,15 @@
 #include "ccsd_t_common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <mutex>
 #include <set>
+#include <vector>
+#if !defined(USE_CUDA) && !defined(USE_HIP) && !defined(USE_DPCPP)
+#include <sys/mman.h>
+#endif
 using namespace std;
 
 // #define NO_OPT
@@ -10,8 +18,96 @@ using namespace std;
 
 // static int is_init=0;
 
-static map<size_t, set<void*>> free_list_gpu, free_list_host;
-static map<void*, size_t>      live_ptrs_gpu, live_ptrs_host;
+static map<size_t, set<void*>> free_list_gpu;
+static map<void*, size_t>      live_ptrs_gpu;
+static std::mutex              gpu_mem_mutex;
+
+//
+//  host memory pool. requests are rounded up to size classes, four per power of two (at most
+//  25% waste), and every block starts with a header holding its class. a freed block goes to a
+//  small cache of the freeing thread, which serves that thread's next requests without locking,
+//  or else to the free list of its class, shared under a lock. a new block is first touched by
+//  the thread that allocates it, which places it on that thread's NUMA node, and the thread
+//  caches hand it back to the same thread. on CPU builds, blocks of 2 MB and more can be backed
+//  by transparent huge pages (initMemModule).
+//
+static constexpr size_t   host_header         = 64; // keeps the blocks cache-line aligned
+static constexpr size_t   host_huge_page      = 2 * 1024 * 1024;
+static constexpr int      host_num_classes    = 4 * 58 + 1;
+static constexpr int      host_tcache_classes = 65; // up to 4 MB
+static constexpr size_t   host_tcache_blocks  = 4;  // per class and thread
+static constexpr uint32_t host_magic          = 0xcc5d7a11;
+
+struct host_block_header_t {
+  uint32_t magic;
+  uint32_t size_class;
+  size_t   bytes;
+};
+
+// classes 64, 80, 96, 112, 128, 160, ... bytes
+static inline int host_size_class(size_t bytes) {
+  if(bytes <= 64) return 0;
+  const size_t n = bytes - 1;
+  const int    e = 63 - __builtin_clzll(n);
+  return (e - 6) * 4 + (int) (n >> (e - 2)) - 3;
+}
+
+static inline size_t host_class_bytes(int c) {
+  if(c == 0) return 64;
+  const int e = (c - 1) / 4 + 6;
+  return (size_t) (5 + (c - 1) % 4) << (e - 2);
+}
+
+struct host_thread_cache_t;
+
+struct host_pool_t {
+  std::mutex                        mutex;
+  std::vector<void*>                blocks[host_num_classes];
+  std::vector<host_thread_cache_t*> caches;
+};
+
+// never destroyed, so that thread caches can drain into it at any thread exit
+static host_pool_t& host_pool() {
+  static host_pool_t* pool = new host_pool_t;
+  return *pool;
+}
+
+struct host_thread_cache_t {
+  std::vector<void*> blocks[host_tcache_classes];
+
+  host_thread_cache_t() {
+    host_pool_t&                pool = host_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.caches.push_back(this);
+  }
+
+  ~host_thread_cache_t() {
+    host_pool_t&                pool = host_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    drain(pool);
+    pool.caches.erase(std::find(pool.caches.begin(), pool.caches.end(), this));
+  }
+
+  // moves the cached blocks to the shared free lists, with the pool locked
+  void drain(host_pool_t& pool) {
+    for(int c = 0; c < host_tcache_classes; c++) {
+      pool.blocks[c].insert(pool.blocks[c].end(), blocks[c].begin(), blocks[c].end());
+      blocks[c].clear();
+    }
+  }
+};
+
+static thread_local host_thread_cache_t host_tcache;
+
+static bool                host_huge_pages = false;
+static std::atomic<size_t> host_allocations{0}, host_resurrections{0};
+static std::atomic<size_t> host_live{0}, host_peak_live{0};
+static std::atomic<size_t> host_reserved{0}, host_peak_reserved{0};
+
+static inline void host_update_peak(std::atomic<size_t>& peak, size_t value) {
+  size_t old = peak.load();
+  while(old < value && !peak.compare_exchange_weak(old, value)) {}
+}
 
 static void clearGpuFreeList() {
   for(map<size_t, set<void*>>::iterator it = free_list_gpu.begin(); it != free_list_gpu.end();
@@ -31,24 +127,28 @@ static void clearGpuFreeList() {
   free_list_gpu.clear();
 }
 
+// no other thread may use the pool meanwhile
 static void clearHostFreeList() {
-  for(map<size_t, set<void*>>::iterator it = free_list_host.begin(); it != free_list_host.end();
-      ++it) {
-    for(set<void*>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+  host_pool_t&                pool = host_pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for(host_thread_cache_t* cache: pool.caches) cache->drain(pool);
+  for(int c = 0; c < host_num_classes; c++) {
+    for(void* ptr: pool.blocks[c]) {
 #if defined(USE_CUDA)
-      CUDA_SAFE(cudaFreeHost(*it2));
+      CUDA_SAFE(cudaFreeHost(ptr));
 #elif defined(USE_HIP)
-      HIP_SAFE(hipHostFree(*it2));
+      HIP_SAFE(hipHostFree(ptr));
 #elif defined(USE_DPCPP)
-      auto&        pool   = tamm::GPUStreamPool::getInstance();
-      gpuStream_t& stream = pool.getStream();
-      sycl::free(*it2, stream);
+      auto&        gpu_pool = tamm::GPUStreamPool::getInstance();
+      gpuStream_t& stream   = gpu_pool.getStream();
+      sycl::free(ptr, stream);
 #else
-      free(*it2);
+      free(ptr);
 #endif
+      host_reserved -= host_header + host_class_bytes(c);
     }
+    pool.blocks[c].clear();
   }
-  free_list_host.clear();
 }
 
 static size_t num_resurrections = 0; // num_morecore=0;
@@ -81,7 +181,15 @@ static void* moreHostMem(size_t bytes) {
   gpuStream_t& stream = pool.getStream();
   ptr = sycl::malloc_host(bytes, stream);
 #else
-  ptr = (void*) malloc(bytes);
+  const size_t align = host_huge_pages && bytes >= host_huge_page ? host_huge_page : host_header;
+  const size_t size  = (bytes + align - 1) / align * align;
+  ptr                = std::aligned_alloc(align, size);
+#ifdef MADV_HUGEPAGE
+  if(ptr != nullptr && align == host_huge_page) madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  // first touch from this thread
+  if(ptr != nullptr)
+    for(size_t i = 0; i < size; i += 4096) static_cast<char*>(ptr)[i] = 0;
 #endif
 
   assert(ptr != nullptr); /*We hopefully have a pointer*/
@@ -117,6 +225,7 @@ void* getGpuMem(size_t bytes) {
   ptr                 = sycl::malloc_device(bytes, stream);
 #endif
 #else
+  std::lock_guard<std::mutex> lock(gpu_mem_mutex);
   if(free_list_gpu.find(bytes) != free_list_gpu.end()) {
     set<void*>& lst = free_list_gpu.find(bytes)->second;
     if(lst.size() != 0) {
@@ -157,38 +266,38 @@ void* getHostMem(size_t bytes) {
   ptr = (void*) malloc(bytes);
 #endif
 #else  // NO_OPT
-  if(free_list_host.find(bytes) != free_list_host.end()) {
-    set<void*>& lst = free_list_host.find(bytes)->second;
-    if(lst.size() != 0) {
-      ptr = resurrect_from_free_list(free_list_host, bytes, live_ptrs_host);
-      /* ptr = *lst.begin(); */
-      /* lst.erase(lst.begin()); */
-      /* live_ptrs_host[ptr] = bytes; */
-      return ptr;
-    }
+  const int    c          = host_size_class(bytes);
+  const size_t block_size = host_header + host_class_bytes(c);
+  host_allocations++;
+  if(c < host_tcache_classes && !host_tcache.blocks[c].empty()) {
+    ptr = host_tcache.blocks[c].back();
+    host_tcache.blocks[c].pop_back();
   }
   else {
-    for(map<size_t, set<void*>>::iterator it = free_list_host.begin(); it != free_list_host.end();
-        ++it) {
-      if(it->first >= bytes && it->second.size() > 0) {
-        ptr = resurrect_from_free_list(free_list_host, it->first, live_ptrs_host);
-        /* 	set<void*> &lst = it->second; */
-        /* 	ptr = *lst.begin(); */
-        /* 	lst.erase(lst.begin()); */
-        /* 	live_ptrs_gpu[ptr] = bytes; */
-        return ptr;
-      }
+    host_pool_t&                pool = host_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if(!pool.blocks[c].empty()) {
+      ptr = pool.blocks[c].back();
+      pool.blocks[c].pop_back();
     }
   }
+  if(ptr != nullptr) host_resurrections++;
+  else {
+    ptr = moreHostMem(block_size);
+    host_update_peak(host_peak_reserved, host_reserved += block_size);
+  }
 
-  ptr = moreHostMem(bytes);
-  live_ptrs_host[ptr] = bytes;
+  host_block_header_t* header = static_cast<host_block_header_t*>(ptr);
+  header->magic               = host_magic;
+  header->size_class          = c;
+  header->bytes               = bytes;
+  host_update_peak(host_peak_live, host_live += bytes);
+  ptr = static_cast<char*>(ptr) + host_header;
 #endif // NO_OPT
   return ptr;
 }
 
 void freeHostMem(void* p) {
-  size_t bytes;
   // assert(is_init);
 #ifdef NO_OPT
 #if defined(USE_CUDA)
@@ -204,13 +313,31 @@ void freeHostMem(void* p) {
 #endif
 
 #else
-  assert(live_ptrs_host.find(p) != live_ptrs_host.end());
-  bytes = live_ptrs_host[p];
-  live_ptrs_host.erase(p);
-  free_list_host[bytes].insert(p);
+  if(p == nullptr) return;
+  void*                block  = static_cast<char*>(p) - host_header;
+  host_block_header_t* header = static_cast<host_block_header_t*>(block);
+  assert(header->magic == host_magic);
+  const int c = header->size_class;
+  host_live -= header->bytes;
+  if(c < host_tcache_classes && host_tcache.blocks[c].size() < host_tcache_blocks)
+    host_tcache.blocks[c].push_back(block);
+  else {
+    host_pool_t&                pool = host_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.blocks[c].push_back(block);
+  }
 #endif // NO_OPT
 }
 
+hostMemStats_t getHostMemStats() {
+  hostMemStats_t stats;
+  stats.allocations   = host_allocations;
+  stats.resurrections = host_resurrections;
+  stats.peak_live     = host_peak_live;
+  stats.peak_reserved = host_peak_reserved;
+  return stats;
+}
+
 void freeGpuMem(void* p) {
   size_t bytes;
   // assert(is_init);
@@ -227,6 +354,7 @@ void freeGpuMem(void* p) {
 #endif // NO_OPT
 
 #else
+  std::lock_guard<std::mutex> lock(gpu_mem_mutex);
   assert(live_ptrs_gpu.find(p) != live_ptrs_gpu.end());
   bytes = live_ptrs_gpu[p];
   live_ptrs_gpu.erase(p);
@@ -234,10 +362,12 @@ void freeGpuMem(void* p) {
 #endif
 }
 
+void initMemModule(bool use_huge_pages) { host_huge_pages = use_huge_pages; }
+
 void finalizememmodule() {
   /*there should be no live pointers*/
   assert(live_ptrs_gpu.size() == 0);
-  assert(live_ptrs_host.size() == 0);
+  assert(host_live == 0);
 
   /*release all freed pointers*/
   clearGpuFreeList();
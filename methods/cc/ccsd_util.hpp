@@ -576,21 +576,20 @@ setupLambdaTensors(ExecutionContext& ec, TiledIndexSpace& MO, size_t ndiis) {
   return std::make_tuple(d_r1, d_r2, d_y1, d_y2, d_r1s, d_r2s, d_y1s, d_y2s);
 }
 
+// builds the blocks of allocated v2tensors from cholVpr, on the ranks of ec (which may be a
+// subset of the ranks the tensors are allocated on)
 template<typename T>
-V2Tensors<T>
-setupV2Tensors(ExecutionContext& ec, Tensor<T> cholVpr, ExecutionHW ex_hw = ExecutionHW::CPU,
-               std::vector<std::string> blocks = {"ijab", "iajb", "ijka", "ijkl", "iabc", "abcd"}) {
+void computeV2Tensors(ExecutionContext& ec, V2Tensors<T>& v2tensors, Tensor<T> cholVpr,
+                      ExecutionHW ex_hw = ExecutionHW::CPU) {
   TiledIndexSpace MO    = cholVpr.tiled_index_spaces()[0]; // MO
   TiledIndexSpace CI    = cholVpr.tiled_index_spaces()[2]; // CI
   auto [cind]           = CI.labels<1>("all");
   auto [h1, h2, h3, h4] = MO.labels<4>("occ");
   auto [p1, p2, p3, p4] = MO.labels<4>("virt");
 
-  V2Tensors<T> v2tensors(blocks);
-  v2tensors.allocate(ec, MO);
   Scheduler sch{ec};
 
-  for(auto x: blocks) {
+  for(auto x: v2tensors.get_blocks()) {
     // clang-format off
     if      (x == "ijab") {
       sch( v2tensors.v2ijab(h1,h2,p1,p2)      =   1.0 * cholVpr(h1,p1,cind) * cholVpr(h2,p2,cind) )
@@ -621,7 +620,15 @@ setupV2Tensors(ExecutionContext& ec, Tensor<T> cholVpr, ExecutionHW ex_hw = Exec
   }
 
   sch.execute(ex_hw);
+}
 
+template<typename T>
+V2Tensors<T>
+setupV2Tensors(ExecutionContext& ec, Tensor<T> cholVpr, ExecutionHW ex_hw = ExecutionHW::CPU,
+               std::vector<std::string> blocks = {"ijab", "iajb", "ijka", "ijkl", "iabc", "abcd"}) {
+  V2Tensors<T> v2tensors(blocks);
+  v2tensors.allocate(ec, cholVpr.tiled_index_spaces()[0]);
+  computeV2Tensors(ec, v2tensors, cholVpr, ex_hw);
   return v2tensors;
 }
 
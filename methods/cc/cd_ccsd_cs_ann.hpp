@@ -1,6 +1,8 @@
 #pragma once
 
+#include "ccsd_pp_ladder.hpp"
 #include "ccsd_util.hpp"
+#include "chol_product_tensor.hpp"
 #include "diis.hpp"
 
 using namespace tamm;
@@ -162,304 +164,6 @@ void ccsd_t2_cs(Scheduler& sch, const TiledIndexSpace& MO, const TiledIndexSpace
   auto hw        = sch.ec().exhw();
   auto rank      = sch.ec().pg().rank();
 
-  //_a022("abab")(p1_va,p2_vb,p2_va,p1_vb) = _a021("aa")(p1_va,p2_va,cind) *
-  //_a021("bb")(p2_vb,p1_vb,cind)
-  Tensor<T>        a22_abab_tmp{v_alpha, v_beta, v_alpha, v_beta};
-  LabeledTensor<T> lhs_  = a22_abab_tmp(p1_va, p2_vb, p2_va, p1_vb);
-  LabeledTensor<T> rhs1_ = _a021("aa")(p1_va, p2_va, cind);
-  LabeledTensor<T> rhs2_ = _a021("bb")(p2_vb, p1_vb, cind);
-
-  // mult op constructor
-  auto lhs_lbls  = lhs_.labels();
-  auto rhs1_lbls = rhs1_.labels();
-  auto rhs2_lbls = rhs2_.labels();
-
-  IntLabelVec lhs_int_labels_;
-  IntLabelVec rhs1_int_labels_;
-  IntLabelVec rhs2_int_labels_;
-
-  auto labels{lhs_lbls};
-  labels.insert(labels.end(), rhs1_lbls.begin(), rhs1_lbls.end());
-  labels.insert(labels.end(), rhs2_lbls.begin(), rhs2_lbls.end());
-
-  internal::update_labels(labels);
-
-  lhs_lbls  = IndexLabelVec(labels.begin(), labels.begin() + lhs_.labels().size());
-  rhs1_lbls = IndexLabelVec(labels.begin() + lhs_.labels().size(),
-                            labels.begin() + lhs_.labels().size() + rhs1_.labels().size());
-  rhs2_lbls = IndexLabelVec(labels.begin() + lhs_.labels().size() + rhs1_.labels().size(),
-                            labels.begin() + lhs_.labels().size() + rhs1_.labels().size() +
-                              rhs2_.labels().size());
-  lhs_.set_labels(lhs_lbls);
-  rhs1_.set_labels(rhs1_lbls);
-  rhs2_.set_labels(rhs2_lbls);
-
-  // fillin_int_labels
-  std::map<TileLabelElement, int> primary_labels_map;
-  int                             cnt = -1;
-  for(const auto& lbl: lhs_.labels()) { primary_labels_map[lbl.primary_label()] = --cnt; }
-  for(const auto& lbl: rhs1_.labels()) { primary_labels_map[lbl.primary_label()] = --cnt; }
-  for(const auto& lbl: rhs2_.labels()) { primary_labels_map[lbl.primary_label()] = --cnt; }
-  for(const auto& lbl: lhs_.labels()) {
-    lhs_int_labels_.push_back(primary_labels_map[lbl.primary_label()]);
-  }
-  for(const auto& lbl: rhs1_.labels()) {
-    rhs1_int_labels_.push_back(primary_labels_map[lbl.primary_label()]);
-  }
-  for(const auto& lbl: rhs2_.labels()) {
-    rhs2_int_labels_.push_back(primary_labels_map[lbl.primary_label()]);
-  }
-  // todo: validate
-
-  using TensorElType1 = T;
-  using TensorElType2 = T;
-  using TensorElType3 = T;
-
-  // determine set of all labels for do_work
-  IndexLabelVec all_labels{lhs_.labels()};
-  all_labels.insert(all_labels.end(), rhs1_.labels().begin(), rhs1_.labels().end());
-  all_labels.insert(all_labels.end(), rhs2_.labels().begin(), rhs2_.labels().end());
-  // LabelLoopNest loop_nest{all_labels};
-
-  // execute-bufacc
-  IndexLabelVec lhs_labels{lhs_.labels()};
-  IndexLabelVec rhs1_labels{rhs1_.labels()};
-  IndexLabelVec rhs2_labels{rhs2_.labels()};
-  IndexLabelVec all_rhs_labels{rhs1_.labels()};
-  all_rhs_labels.insert(all_rhs_labels.end(), rhs2_.labels().begin(), rhs2_.labels().end());
-
-  // compute the reduction labels
-  std::sort(lhs_labels.begin(), lhs_labels.end());
-  auto unique_labels = internal::unique_entries_by_primary_label(all_rhs_labels);
-  std::sort(unique_labels.begin(), unique_labels.end());
-  IndexLabelVec reduction_labels; //{reduction.begin(), reduction.end()};
-  std::set_difference(unique_labels.begin(), unique_labels.end(), lhs_labels.begin(),
-                      lhs_labels.end(), std::back_inserter(reduction_labels));
-
-  std::vector<int> rhs1_map_output;
-  std::vector<int> rhs2_map_output;
-  std::vector<int> rhs1_map_reduction;
-  std::vector<int> rhs2_map_reduction;
-  // const auto&      lhs_lbls = lhs_.labels();
-  for(auto& lbl: rhs1_labels) {
-    auto it_out = std::find(lhs_lbls.begin(), lhs_lbls.end(), lbl);
-    if(it_out != lhs_lbls.end()) rhs1_map_output.push_back(it_out - lhs_lbls.begin());
-    else rhs1_map_output.push_back(-1);
-
-    // auto it_red = std::find(reduction.begin(), reduction.end(), lbl);
-    auto it_red = std::find(reduction_labels.begin(), reduction_labels.end(), lbl);
-    if(it_red != reduction_labels.end())
-      rhs1_map_reduction.push_back(it_red - reduction_labels.begin());
-    else rhs1_map_reduction.push_back(-1);
-  }
-
-  for(auto& lbl: rhs2_labels) {
-    auto it_out = std::find(lhs_lbls.begin(), lhs_lbls.end(), lbl);
-    if(it_out != lhs_lbls.end()) rhs2_map_output.push_back(it_out - lhs_lbls.begin());
-    else rhs2_map_output.push_back(-1);
-
-    auto it_red = std::find(reduction_labels.begin(), reduction_labels.end(), lbl);
-    if(it_red != reduction_labels.end())
-      rhs2_map_reduction.push_back(it_red - reduction_labels.begin());
-    else rhs2_map_reduction.push_back(-1);
-  }
-
-  auto ctensor = lhs_.tensor();
-  auto atensor = rhs1_.tensor();
-  auto btensor = rhs2_.tensor();
-  // for(auto itval=loop_nest.begin(); itval!=loop_nest.end(); ++itval) {}
-
-  auto compute_v4_term = [=](const IndexVector& cblkid, span<T> cbuf) {
-    std::vector<AddBuf<TensorElType1, TensorElType2, TensorElType3>*> add_bufs;
-
-    // compute blockids from the loop indices. itval is the loop index
-    // execute_bufacc(ec, hw);
-    LabelLoopNest lhs_loop_nest{lhs_.labels()};
-    IndexVector   translated_ablockid, translated_bblockid, translated_cblockid;
-    auto          it    = lhs_loop_nest.begin();
-    auto          itval = *it;
-    for(; it != lhs_loop_nest.end(); ++it) {
-      itval = *it;
-      // auto        it   = ivec.begin();
-      IndexVector c_block_id{itval};
-      translated_cblockid = internal::translate_blockid(c_block_id, lhs_);
-      if(translated_cblockid == cblkid) break;
-    }
-
-    // execute
-    // const auto& ldist = lhs_.tensor().distribution();
-    // for(const auto& lblockid: lhs_loop_nest) {
-    //   const auto translated_lblockid = internal::translate_blockid(lblockid, lhs_);
-    //   if(lhs_.tensor().is_non_zero(translated_lblockid) &&
-    //       std::get<0>(ldist.locate(translated_lblockid)) == rank) {
-    //     lambda(lblockid);
-    //   }
-
-    const size_t csize = ctensor.block_size(translated_cblockid);
-    // std::vector<TensorElType1> cbuf(csize, 0);
-    memset(cbuf.data(), 0x00, csize * sizeof(TensorElType1));
-    const auto& cdims = ctensor.block_dims(translated_cblockid);
-
-    SizeVec cdims_sz;
-    for(const auto v: cdims) { cdims_sz.push_back(v); }
-
-    bool isgpu = false;
-
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-    TensorElType2* th_a{nullptr};
-    TensorElType3* th_b{nullptr};
-    TensorElType1* th_c{nullptr};
-    auto&          thandle = tamm::GPUStreamPool::getInstance().getStream();
-
-    AddBuf<TensorElType1, TensorElType2, TensorElType3>* ab{nullptr};
-    if(hw == ExecutionHW::GPU) {
-      ab = new AddBuf<TensorElType1, TensorElType2, TensorElType3>{
-        isgpu, &thandle, th_a, th_b, th_c, {}, translated_cblockid};
-    }
-    else {
-      ab = new AddBuf<TensorElType1, TensorElType2, TensorElType3>{
-        isgpu, &thandle, th_a, th_b, th_c, {}, translated_cblockid};
-    }
-    add_bufs.push_back(ab);
-#else
-    gpuStream_t                                          thandle{};
-    AddBuf<TensorElType1, TensorElType2, TensorElType3>* ab =
-      new AddBuf<TensorElType1, TensorElType2, TensorElType3>{
-        isgpu, ctensor, {}, translated_cblockid};
-    add_bufs.push_back(ab);
-#endif
-
-    // LabelLoopNest inner_loop{reduction_lbls};
-    LabelLoopNest inner_loop{reduction_labels};
-
-    // int loop_counter = 0;
-
-    TensorElType1* cbuf_dev_ptr{nullptr};
-    TensorElType1* cbuf_tmp_dev_ptr{nullptr};
-#if(defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP))
-    auto& memPool = tamm::GPUPooledStorageManager::getInstance();
-
-    if(hw == ExecutionHW::GPU) {
-      cbuf_dev_ptr = static_cast<TensorElType1*>(memPool.allocate(csize * sizeof(TensorElType1)));
-      cbuf_tmp_dev_ptr =
-        static_cast<TensorElType1*>(memPool.allocate(csize * sizeof(TensorElType1)));
-
-      memPool.gpuMemset(reinterpret_cast<void*&>(cbuf_dev_ptr), csize * sizeof(TensorElType1));
-      memPool.gpuMemset(reinterpret_cast<void*&>(cbuf_tmp_dev_ptr), csize * sizeof(TensorElType1));
-    }
-#endif
-
-    int slc = 0;
-    for(const auto& inner_it_val: inner_loop) { // k
-
-      IndexVector a_block_id(rhs1_.labels().size());
-
-      for(size_t i = 0; i < rhs1_map_output.size(); i++) {
-        if(rhs1_map_output[i] != -1) { a_block_id[i] = itval[rhs1_map_output[i]]; }
-      }
-
-      for(size_t i = 0; i < rhs1_map_reduction.size(); i++) {
-        if(rhs1_map_reduction[i] != -1) { a_block_id[i] = inner_it_val[rhs1_map_reduction[i]]; }
-      }
-
-      const auto translated_ablockid = internal::translate_blockid(a_block_id, rhs1_);
-      if(!atensor.is_non_zero(translated_ablockid)) continue;
-
-      IndexVector b_block_id(rhs2_.labels().size());
-
-      for(size_t i = 0; i < rhs2_map_output.size(); i++) {
-        if(rhs2_map_output[i] != -1) { b_block_id[i] = itval[rhs2_map_output[i]]; }
-      }
-
-      for(size_t i = 0; i < rhs2_map_reduction.size(); i++) {
-        if(rhs2_map_reduction[i] != -1) { b_block_id[i] = inner_it_val[rhs2_map_reduction[i]]; }
-      }
-
-      const auto translated_bblockid = internal::translate_blockid(b_block_id, rhs2_);
-      if(!btensor.is_non_zero(translated_bblockid)) continue;
-
-      // compute block size and allocate buffers for abuf and bbuf
-      const size_t asize = atensor.block_size(translated_ablockid);
-      const size_t bsize = btensor.block_size(translated_bblockid);
-
-      std::vector<TensorElType2> abuf(asize);
-      std::vector<TensorElType3> bbuf(bsize);
-
-      atensor.get(translated_ablockid, abuf);
-      btensor.get(translated_bblockid, bbuf);
-
-      const auto& adims = atensor.block_dims(translated_ablockid);
-      const auto& bdims = btensor.block_dims(translated_bblockid);
-
-      // changed cscale from 0 to 1 to aggregate on cbuf
-      T cscale{1};
-
-      SizeVec adims_sz, bdims_sz;
-      for(const auto v: adims) { adims_sz.push_back(v); }
-      for(const auto v: bdims) { bdims_sz.push_back(v); }
-
-      // A*B
-
-      {
-        AddBuf<TensorElType1, TensorElType2, TensorElType3>* abptr{nullptr};
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-        if(hw == ExecutionHW::GPU) {
-          abptr   = ab;
-          ab->ta_ = static_cast<TensorElType2*>(memPool.allocate(asize * sizeof(TensorElType2)));
-          ab->tb_ = static_cast<TensorElType3*>(memPool.allocate(bsize * sizeof(TensorElType3)));
-        }
-        else abptr = add_bufs[0];
-#else
-        abptr = add_bufs[0];
-#endif
-        abptr->abuf_ = std::move(abuf);
-        abptr->bbuf_ = std::move(bbuf);
-
-        kernels::block_multiply<T, TensorElType1, TensorElType2, TensorElType3>(
-          abptr->isgpu_,
-#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
-          abptr->ta_, abptr->tb_,
-#endif
-          thandle, 1.0, (abptr->abuf_).data(), adims_sz, rhs1_int_labels_, (abptr->bbuf_).data(),
-          bdims_sz, rhs2_int_labels_, cscale, cbuf.data(), cdims_sz, lhs_int_labels_, hw,
-          has_gpu_tmp, false, cbuf_dev_ptr, cbuf_tmp_dev_ptr);
-      }
-#if(defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP))
-      if(hw == ExecutionHW::GPU) {
-        memPool.deallocate(static_cast<void*>(ab->ta_), (ab->abuf_).size() * sizeof(TensorElType2));
-        memPool.deallocate(static_cast<void*>(ab->tb_), (ab->bbuf_).size() * sizeof(TensorElType3));
-      }
-#endif
-      slc++;
-    } // end of reduction loop
-
-    // add the computed update to the tensor
-    {
-#if(defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP))
-      // copy to host
-      if(hw == ExecutionHW::GPU) {
-        std::vector<TensorElType1> cbuf_tmp(csize, 0);
-        kernels::copy_result_to_host(hw, thandle, cbuf_tmp, cbuf_dev_ptr);
-        // cbuf+=cbuf_tmp
-        kernels::stream_synchronize<TensorElType1>(thandle);
-        blas::axpy(csize, TensorElType1{1}, cbuf_tmp.data(), 1, cbuf.data(), 1);
-
-        // free cbuf_dev_ptr
-        auto& memPool = tamm::GPUPooledStorageManager::getInstance();
-        memPool.deallocate(static_cast<void*>(cbuf_dev_ptr), csize * sizeof(TensorElType1));
-        memPool.deallocate(static_cast<void*>(cbuf_tmp_dev_ptr), csize * sizeof(TensorElType1));
-      }
-#endif
-      // ctensor.add(translated_cblockid, cbuf);
-      // for (size_t i=0;i<csize;i++) dbuf[i] = cbuf[i];
-    }
-
-    for(auto& ab: add_bufs) delete ab;
-    add_bufs.clear();
-  };
-
-  a22_abab = Tensor<T>{{v_alpha, v_beta, v_alpha, v_beta}, compute_v4_term};
-
   // clang-format off
   sch
     (_a017("aa")(p1_va, h2_oa, cind)         = -1.0  * t2_aaaa_temp(p1_va, p2_va, h2_oa, h1_oa) * chol3d_ov("aa")(h1_oa, p2_va, cind), 
@@ -531,11 +235,18 @@ void ccsd_t2_cs(Scheduler& sch, const TiledIndexSpace& MO, const TiledIndexSpace
     (i0_abab(p1_va, p1_vb, h1_oa, h2_ob)         +=  1.0  * _a017("aa")(p1_va, h1_oa, cind) * _a017("bb")(p1_vb, h2_ob, cind), 
     "i0_abab(p1_va, p1_vb, h1_oa, h2_ob)         +=  1.0  * _a017( aa )(p1_va, h1_oa, cind) * _a017( bb )(p1_vb, h2_ob, cind)");
 
-    sch
     // (_a022("abab")(p1_va,p2_vb,p2_va,p1_vb)       =  1.0  * _a021("aa")(p1_va,p2_va,cind) * _a021("bb")(p2_vb,p1_vb,cind), 
     // "_a022( abab )(p1_va,p2_vb,p2_va,p1_vb)       =  1.0  * _a021( aa )(p1_va,p2_va,cind) * _a021( bb )(p2_vb,p1_vb,cind)")
-    (i0_abab(p1_va, p2_vb, h1_oa, h2_ob)         +=  4.0  * a22_abab(p1_va, p2_vb, p2_va, p1_vb) * t2_abab(p2_va,p1_vb,h1_oa,h2_ob), 
-    "i0_abab(p1_va, p2_vb, h1_oa, h2_ob)         +=  4.0  * a22_abab(p1_va, p2_vb, p2_va, p1_vb) * t2_abab(p2_va,p1_vb,h1_oa,h2_ob)");
+    // on the CPU, the ladder builds each _a022 tile once instead of once per occupied tile pair
+    if(hw == ExecutionHW::GPU) {
+      a22_abab = CholProductTensor<T>(_a021("aa"), _a021("bb"), hw, has_gpu_tmp).tensor();
+      sch(i0_abab(p1_va, p2_vb, h1_oa, h2_ob)    +=  4.0  * a22_abab(p1_va, p2_vb, p2_va, p1_vb) * t2_abab(p2_va,p1_vb,h1_oa,h2_ob), 
+         "i0_abab(p1_va, p2_vb, h1_oa, h2_ob)    +=  4.0  * a22_abab(p1_va, p2_vb, p2_va, p1_vb) * t2_abab(p2_va,p1_vb,h1_oa,h2_ob)");
+    }
+    else {
+      sch.execute(hw);
+      ccsd_pp_ladder(sch.ec(), i0_abab, t2_abab, _a021("aa"), _a021("bb"), 4.0);
+    }
     
     
     sch(_a019("abab")(h2_oa, h1_ob, h1_oa, h2_ob)   +=  0.25 * _a004("abab")(p1_va, p2_vb, h2_oa, h1_ob) * t2_abab(p1_va,p2_vb,h1_oa,h2_ob), 
@@ -726,62 +437,82 @@ cd_ccsd_cs_driver(SystemData& sys_data, ExecutionContext& ec, const TiledIndexSp
     Tensor<T> d_r1_residual{}, d_r2_residual{};
     Tensor<T>::allocate(&ec, d_r1_residual, d_r2_residual);
 
-    for(int titer = 0; titer < maxiter; titer += ndiis) {
-      for(int iter = titer; iter < std::min(titer + ndiis, maxiter); iter++) {
-        const auto timer_start = std::chrono::high_resolution_clock::now();
-
-        niter   = iter;
-        int off = iter - titer;
-        // clang-format off
-            sch
-               ((d_t1s[off])()  = t1_aa())
-               ((d_t2s[off])()  = t2_abab())
-               .execute();
-        // clang-format on
-
-        ccsd_e_cs(sch, MO, CI, d_e, t1_aa, t2_abab, t2_aaaa, f1_se, chol3d_se);
-        ccsd_t1_cs(sch, MO, CI, r1_aa, t1_aa, t2_abab, f1_se, chol3d_se);
-        ccsd_t2_cs(sch, MO, CI, r2_abab, t1_aa, t2_abab, t2_aaaa, f1_se, chol3d_se);
-
-        sch.execute(exhw, profile);
-
-        std::tie(residual, energy) = rest_cs(ec, MO, r1_aa, r2_abab, t1_aa, t2_abab, d_e,
-                                             d_r1_residual, d_r2_residual, p_evl_sorted, zshiftl,
-                                             n_occ_alpha, n_vir_alpha);
-
-        update_r2(ec, r2_abab());
-        // clang-format off
-            sch((d_r1s[off])() = r1_aa())
-                ((d_r2s[off])() = r2_abab())
-                .execute();
-        // clang-format on
-
-        const auto timer_end = std::chrono::high_resolution_clock::now();
-        auto       iter_time =
-          std::chrono::duration_cast<std::chrono::duration<double>>((timer_end - timer_start))
-            .count();
-
-        iteration_print(sys_data, ec.pg(), iter, residual, energy, iter_time);
-
-        if(writet && (((iter + 1) % writet_iter == 0) || (residual < thresh))) {
-          write_to_disk(t1_aa, t1file);
-          write_to_disk(t2_abab, t2file);
-        }
-
-        if(residual < thresh) { break; }
+    const auto&  ccsd_options  = sys_data.options_map.ccsd_options;
+    const bool   rolling_diis  = ccsd_options.diis_mode == "rolling";
+    const int    diis_start    = ccsd_options.diis_start;
+    const double diis_max_cond = ccsd_options.diis_max_cond;
+
+    // the DIIS history is in d_r1s, d_r2s, d_t1s, d_t2s unless it goes to disk or is compressed
+    DIIS<T> diis_state =
+      ccsd_options.diis_storage == "memory"
+        ? DIIS<T>{ec, {d_r1s, d_r2s}, {d_t1s, d_t2s}}
+        : DIIS<T>{ec, static_cast<size_t>(ndiis), 2,
+                  make_diis_history<T>(ec, ccsd_options.diis_storage, ndiis, 2,
+                                       ccsd_options.diis_disk_path,
+                                       std::filesystem::path(out_fp).filename().string(),
+                                       ccsd_options.diis_compress_tol)};
+
+    for(int iter = 0; iter < maxiter; iter++) {
+      const auto timer_start = std::chrono::high_resolution_clock::now();
+
+      niter = iter;
+      // block DIIS keeps the amplitudes an iteration starts from, rolling DIIS the ones its
+      // Jacobi step ends at
+      const size_t off = rolling_diis ? diis_state.next_slot() : iter % ndiis;
+      if(!rolling_diis) diis_state.store_t(off, {t1_aa, t2_abab});
+
+      ccsd_e_cs(sch, MO, CI, d_e, t1_aa, t2_abab, t2_aaaa, f1_se, chol3d_se);
+      ccsd_t1_cs(sch, MO, CI, r1_aa, t1_aa, t2_abab, f1_se, chol3d_se);
+      ccsd_t2_cs(sch, MO, CI, r2_abab, t1_aa, t2_abab, t2_aaaa, f1_se, chol3d_se);
+
+      sch.execute(exhw, profile);
+
+      std::tie(residual, energy) = rest_cs(ec, MO, r1_aa, r2_abab, t1_aa, t2_abab, d_e,
+                                           d_r1_residual, d_r2_residual, p_evl_sorted, zshiftl,
+                                           n_occ_alpha, n_vir_alpha);
+
+      update_r2(ec, r2_abab());
+      diis_state.store_r(off, {r1_aa, r2_abab});
+      if(rolling_diis) diis_state.store_t(off, {t1_aa, t2_abab});
+
+      const auto timer_end = std::chrono::high_resolution_clock::now();
+      auto       iter_time =
+        std::chrono::duration_cast<std::chrono::duration<double>>((timer_end - timer_start))
+          .count();
+
+      iteration_print(sys_data, ec.pg(), iter, residual, energy, iter_time);
+
+      if(writet && (((iter + 1) % writet_iter == 0) || (residual < thresh))) {
+        write_to_disk(t1_aa, t1file);
+        write_to_disk(t2_abab, t2file);
       }
 
-      if(residual < thresh || titer + ndiis >= maxiter) { break; }
-      if(ec.pg().rank() == 0) {
-        std::cout << " MICROCYCLE DIIS UPDATE:";
-        std::cout.width(21);
-        std::cout << std::right << std::min(titer + ndiis, maxiter) + 1 << std::endl;
+      if(residual < thresh || iter + 1 >= maxiter) { break; }
+
+      if(rolling_diis) {
+        if(iter + 1 >= diis_start && diis_state.roll({t1_aa, t2_abab}, diis_max_cond) &&
+           ec.pg().rank() == 0) {
+          std::cout << " DIIS RESTART:";
+          std::cout.width(31);
+          std::cout << std::right << iter + 2 << std::endl;
+        }
+      }
+      else if((iter + 1) % ndiis == 0) {
+        if(ec.pg().rank() == 0) {
+          std::cout << " MICROCYCLE DIIS UPDATE:";
+          std::cout.width(21);
+          std::cout << std::right << iter + 2 << std::endl;
+        }
+        diis_state.extrapolate({t1_aa, t2_abab});
       }
+    }
 
-      std::vector<std::vector<Tensor<T>>> rs{d_r1s, d_r2s};
-      std::vector<std::vector<Tensor<T>>> ts{d_t1s, d_t2s};
-      std::vector<Tensor<T>>              next_t{t1_aa, t2_abab};
-      diis<T>(ec, rs, ts, next_t);
+    if(ccsd_options.diis_storage != "memory") {
+      const double diis_gib = diis_state.history_gib();
+      if(ec.print())
+        std::cout << std::endl
+                  << "DIIS history (" << ccsd_options.diis_storage << "): " << std::fixed
+                  << std::setprecision(2) << diis_gib << " GiB" << std::endl;
     }
 
     if(profile && ec.print()) {
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "tamm/tamm.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace tamm;
+
+// L(x,y,:) as [x][y][Q] over all the Cholesky tiles; empty if it vanishes. block is scratch.
+template<typename T>
+void get_chol_slice(Tensor<T>& L, size_t x, size_t y, std::vector<T>& slice,
+                    std::vector<T>& block) {
+  slice.clear();
+  if(!L.is_non_zero({x, y, 0})) return;
+  const size_t nci  = L.tiled_index_spaces()[2].num_tiles();
+  const auto   dims = L.block_dims({x, y, 0});
+  const size_t nxy  = dims[0] * dims[1];
+  size_t       nq   = 0;
+  for(size_t k = 0; k < nci; k++) nq += L.block_dims({x, y, k})[2];
+  slice.resize(nxy * nq);
+  for(size_t k = 0, q0 = 0; k < nci; k++) {
+    block.resize(L.block_size({x, y, k}));
+    L.get({x, y, k}, block);
+    const size_t nk = block.size() / nxy;
+    for(size_t xy = 0; xy < nxy; xy++)
+      std::copy(&block[xy * nk], &block[xy * nk] + nk, &slice[xy * nq + q0]);
+    q0 += nk;
+  }
+}
+
+//
+//  lazy tensor v(a,b,c,d) = sum_Q L1(a,c,Q) L2(b,d,Q) on (Va,Vb,Va,Vb), for L1 on (Va,Va,CI) and
+//  L2 on (Vb,Vb,CI), like the _a022 intermediates of the CD-CCSD drivers. a block is one
+//  block_multiply over all of Q, with the integer labels of the product fixed once here.
+//
+//  the slices L1(A,C,:) and L2(B,D,:) are kept in a per-thread LRU cache large enough for a row
+//  (A,B) of output blocks, within chol_product_cache_mb. the cache, like the rest of the scratch
+//  space, is reused from block to block. L1 and L2 must not change while the tensor is used;
+//  make a new CholProductTensor when they do.
+//
+constexpr double chol_product_cache_mb = 1024;
+
+template<typename T>
+class CholProductTensor {
+public:
+  CholProductTensor() = default;
+
+  CholProductTensor(Tensor<T> L1, Tensor<T> L2, ExecutionHW hw, bool has_gpu):
+    gen_{std::make_shared<generator>()} {
+    auto& g   = *gen_;
+    g.L[0]    = L1;
+    g.L[1]    = L2;
+    g.hw      = hw;
+    g.has_gpu = has_gpu;
+    g.id      = ++instances();
+
+    const auto&  tis = L1.tiled_index_spaces();
+    const size_t nva = tis[0].num_tiles(), nvb = L2.tiled_index_spaces()[0].num_tiles();
+    size_t       max_tile = 0, nq = 0;
+    for(size_t x = 0; x < nva; x++) max_tile = std::max(max_tile, L1.block_dims({x, x, 0})[0]);
+    for(size_t x = 0; x < nvb; x++) max_tile = std::max(max_tile, L2.block_dims({x, x, 0})[0]);
+    for(size_t k = 0; k < tis[2].num_tiles(); k++) nq += L1.block_dims({0, 0, k})[2];
+
+    const double slice_mb = max_tile * max_tile * nq * sizeof(T) / (1024 * 1024.0);
+    const size_t fit      = chol_product_cache_mb / std::max(slice_mb, 1e-3);
+    g.cache_size          = std::clamp<size_t>(fit, 2, nva + nvb);
+  }
+
+  // the lazy tensor; it shares the generator, so it can outlive this object
+  Tensor<T> tensor() const {
+    const auto& tis1 = gen_->L[0].tiled_index_spaces();
+    const auto& tis2 = gen_->L[1].tiled_index_spaces();
+    auto        gen  = gen_;
+    return Tensor<T>{{tis1[0], tis2[0], tis1[0], tis2[0]},
+                     [gen](const IndexVector& blockid, span<T> cbuf) { (*gen)(blockid, cbuf); }};
+  }
+
+  // blocks this rank has built
+  double generated() const { return gen_->generated; }
+
+private:
+  struct scratch {
+    size_t                                           owner = 0;
+    std::unique_ptr<LRUCache<Index, std::vector<T>>> slices;
+    std::vector<T>                                   a, block;
+  };
+
+  struct generator {
+    Tensor<T>           L[2];
+    ExecutionHW         hw         = ExecutionHW::CPU;
+    bool                has_gpu    = false;
+    size_t              id         = 0;
+    size_t              cache_size = 2;
+    std::atomic<size_t> generated{0};
+
+    // v(a,b,c,d) <- L1(a,c,Q) L2(b,d,Q)
+    const IntLabelVec a_labels{-1, -3, -5};
+    const IntLabelVec b_labels{-2, -4, -5};
+    const IntLabelVec c_labels{-1, -2, -3, -4};
+
+    scratch& thread_scratch() {
+      thread_local scratch s;
+      if(s.owner != id) {
+        s.owner  = id;
+        s.slices = std::make_unique<LRUCache<Index, std::vector<T>>>(cache_size);
+      }
+      return s;
+    }
+
+    // L(x,y,:) through the cache of this thread, or nullptr if it vanishes
+    std::vector<T>* slice(scratch& s, size_t which, size_t x, size_t y) {
+      if(!L[which].is_non_zero({x, y, 0})) return nullptr;
+      auto [hit, value] = s.slices->log_access({which, x, y});
+      if(!hit) get_chol_slice(L[which], x, y, value, s.block);
+      return &value;
+    }
+
+    void operator()(const IndexVector& blockid, span<T> cbuf) {
+      const size_t A = blockid[0], B = blockid[1], C = blockid[2], D = blockid[3];
+      memset(cbuf.data(), 0x00, cbuf.size() * sizeof(T));
+
+      auto& s  = thread_scratch();
+      auto* l1 = slice(s, 0, A, C);
+      if(l1 == nullptr) return;
+      // the second slice may evict the first one from the cache
+      s.a.assign(l1->begin(), l1->end());
+      auto* l2 = slice(s, 1, B, D);
+      if(l2 == nullptr) return;
+      generated++;
+
+      const auto   d1 = L[0].block_dims({A, C, 0});
+      const auto   d2 = L[1].block_dims({B, D, 0});
+      const size_t nq = s.a.size() / (d1[0] * d1[1]);
+      SizeVec      adims{d1[0], d1[1], nq}, bdims{d2[0], d2[1], nq};
+      SizeVec      cdims{d1[0], d2[0], d1[1], d2[1]};
+      const size_t asize = s.a.size(), bsize = l2->size(), csize = cbuf.size();
+
+      T* cbuf_dev_ptr{nullptr};
+      T* cbuf_tmp_dev_ptr{nullptr};
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+      auto& thandle = tamm::GPUStreamPool::getInstance().getStream();
+      auto& memPool = tamm::GPUPooledStorageManager::getInstance();
+      T*    ta{nullptr};
+      T*    tb{nullptr};
+      if(hw == ExecutionHW::GPU) {
+        cbuf_dev_ptr     = static_cast<T*>(memPool.allocate(csize * sizeof(T)));
+        cbuf_tmp_dev_ptr = static_cast<T*>(memPool.allocate(csize * sizeof(T)));
+        memPool.gpuMemset(reinterpret_cast<void*&>(cbuf_dev_ptr), csize * sizeof(T));
+        memPool.gpuMemset(reinterpret_cast<void*&>(cbuf_tmp_dev_ptr), csize * sizeof(T));
+        ta = static_cast<T*>(memPool.allocate(asize * sizeof(T)));
+        tb = static_cast<T*>(memPool.allocate(bsize * sizeof(T)));
+      }
+#else
+      gpuStream_t thandle{};
+#endif
+
+      kernels::block_multiply<T, T, T, T>(false,
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+                                          ta, tb,
+#endif
+                                          thandle, 1.0, s.a.data(), adims, a_labels, l2->data(),
+                                          bdims, b_labels, T{1}, cbuf.data(), cdims, c_labels, hw,
+                                          has_gpu, false, cbuf_dev_ptr, cbuf_tmp_dev_ptr);
+
+#if defined(USE_CUDA) || defined(USE_HIP) || defined(USE_DPCPP)
+      if(hw == ExecutionHW::GPU) {
+        memPool.deallocate(static_cast<void*>(ta), asize * sizeof(T));
+        memPool.deallocate(static_cast<void*>(tb), bsize * sizeof(T));
+
+        // the product is on the device; add it to cbuf through the reused host block
+        s.block.resize(csize);
+        kernels::copy_result_to_host(hw, thandle, s.block, cbuf_dev_ptr);
+        kernels::stream_synchronize<T>(thandle);
+        blas::axpy(csize, T{1}, s.block.data(), 1, cbuf.data(), 1);
+        memPool.deallocate(static_cast<void*>(cbuf_dev_ptr), csize * sizeof(T));
+        memPool.deallocate(static_cast<void*>(cbuf_tmp_dev_ptr), csize * sizeof(T));
+      }
+#endif
+    }
+  };
+
+  // distinguishes generators in the thread-local scratch, also when one reuses another's address
+  static std::atomic<size_t>& instances() {
+    static std::atomic<size_t> n{0};
+    return n;
+  }
+
+  std::shared_ptr<generator> gen_;
+};
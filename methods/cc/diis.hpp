@@ -1,8 +1,15 @@
 #pragma once
 
+#include "diis_history.hpp"
 #include "ga/ga.h"
 #include "tamm/tamm.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mpi.h>
+
 namespace tamm {
 
 template<typename T>
@@ -321,71 +328,295 @@ inline T ddot(ExecutionContext& ec, LabeledTensor<T> lta, LabeledTensor<T> ltb)
 }
 
 /**
- * @brief DIIS routine
+ * @brief DIIS extrapolation that persists across iterations
+ *
+ * The residuals and amplitudes of each slot are kept in a DIISHistory: caller-owned tensors
+ * (rs[k][i], ts[k][i] for the k-th amplitude tensor), node-local files or compressed memory.
+ * The overlap matrix B of the residuals is kept: store_r() writes the residuals of a slot and
+ * computes its row, with one pass over its blocks that takes the dot products with all the
+ * filled slots at once and a single reduction. extrapolate() forms the new amplitudes block by
+ * block in one pass over the slots. A rank only reads back the blocks it owns: the blocks of
+ * each component are listed once, and every later pass over the component walks that list.
+ *
  * @tparam T Type of element in each tensor
- * @param ec Execution context in which this function invoked
- * @param[in] d_rs Vector of R tensors
- * @param[in] d_ts Vector of T tensors
- * @param[out] d_t Vector of T tensors produced by DIIS
- * @pre d_rs.size() == d_ts.size()
- * @pre 0<=i<d_rs.size(): d_rs[i].size() == d_t.size()
- * @pre 0<=i<d_ts.size(): d_ts[i].size() == d_t.size()
  */
 template<typename T>
-inline void diis(ExecutionContext& ec, std::vector<std::vector<Tensor<T>>>& d_rs,
-                 std::vector<std::vector<Tensor<T>>>& d_ts, std::vector<Tensor<T>> d_t) {
-  EXPECTS(d_t.size() == d_rs.size());
-  size_t ntensors = d_t.size();
-  EXPECTS(ntensors > 0);
-  size_t ndiis = d_rs[0].size();
-  EXPECTS(ndiis > 0);
-  for(auto i = 0U; i < ntensors; i++) { EXPECTS(d_rs[i].size() == ndiis); }
-
+class DIIS {
+public:
   using Matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
-  using Vector = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
-  Matrix A     = Matrix::Zero(ndiis + 1, ndiis + 1);
-  Vector b     = Vector::Zero(ndiis + 1, 1);
-  for(auto k = 0U; k < ntensors; k++) {
-    for(auto i = 0U; i < ndiis; i++) {
-      for(auto j = i; j < ndiis; j++) {
-        Tensor<T> d_r1{};
-        Tensor<T>::allocate(&ec, d_r1);
-        Tensor<T>& t1 = d_rs[k].at(i);
-        Tensor<T>& t2 = d_rs[k].at(j);
-        // A(i, j) += ddot(ec, (*d_rs[k]->at(i))(), (*d_rs[k]->at(j))());
-        Scheduler{ec}(d_r1() = t1() * t2()).execute();
-
-        A(i, j) += get_scalar(d_r1);
-        Tensor<T>::deallocate(d_r1);
+
+  // the history in the tensors rs, ts
+  DIIS(ExecutionContext& ec, std::vector<std::vector<Tensor<T>>> rs,
+       std::vector<std::vector<Tensor<T>>> ts):
+    ec_(ec), ncomp_(rs.size()) {
+    EXPECTS(ncomp_ > 0 && rs.size() == ts.size());
+    nslots_ = rs[0].size();
+    for(size_t k = 0; k < ncomp_; k++)
+      EXPECTS(rs[k].size() == nslots_ && ts[k].size() == nslots_);
+    tensors_ = rs;
+    tensors_.insert(tensors_.end(), ts.begin(), ts.end());
+    history_ = std::make_unique<DIISTensorHistory<T>>(tensors_);
+    init();
+  }
+
+  // nslots slots of ncomp residual and amplitude tensors in history
+  DIIS(ExecutionContext& ec, size_t nslots, size_t ncomp, std::unique_ptr<DIISHistory<T>> history):
+    ec_(ec), ncomp_(ncomp), nslots_(nslots), history_(std::move(history)) {
+    EXPECTS(ncomp_ > 0);
+    init();
+  }
+
+  size_t size() const { return nslots_; }
+  size_t filled() const { return std::count(filled_.begin(), filled_.end(), true); }
+  const Matrix& overlap() const { return B_; }
+
+  // collective. GiB of history held outside of TAMM tensors, in all
+  double history_gib() const {
+    double bytes = history_->bytes();
+    MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, ec_.pg().comm());
+    return bytes / (1024 * 1024 * 1024.0);
+  }
+
+  // forgets all the slots
+  void reset() {
+    B_.setZero();
+    filled_.assign(nslots_, false);
+    stamp_.assign(nslots_, 0);
+  }
+
+  // forgets slot i
+  void forget(size_t i) {
+    EXPECTS(i < nslots_);
+    B_.row(i).setZero();
+    B_.col(i).setZero();
+    filled_[i] = false;
+    stamp_[i]  = 0;
+  }
+
+  // the filled slot updated longest ago
+  size_t oldest() const {
+    size_t first = nslots_;
+    for(size_t j = 0; j < nslots_; j++)
+      if(filled_[j] && (first == nslots_ || stamp_[j] < stamp_[first])) first = j;
+    EXPECTS(first < nslots_);
+    return first;
+  }
+
+  // the slot to write next: an empty one, or the one updated longest ago
+  size_t next_slot() const {
+    auto it = std::find(filled_.begin(), filled_.end(), false);
+    return it != filled_.end() ? it - filled_.begin() : oldest();
+  }
+
+  // condition number of the overlap of the filled slots, with unit diagonal
+  double condition() const {
+    std::vector<size_t> slots = filled_slots();
+    const size_t        n     = slots.size();
+    if(n == 0) return 1;
+
+    Matrix S(n, n);
+    for(size_t i = 0; i < n; i++) {
+      for(size_t j = 0; j < n; j++) {
+        const double d = std::sqrt(B_(slots[i], slots[i]) * B_(slots[j], slots[j]));
+        if(d == 0) return std::numeric_limits<double>::infinity();
+        S(i, j) = B_(slots[i], slots[j]) / d;
       }
     }
+    Eigen::SelfAdjointEigenSolver<Matrix> es(S, Eigen::EigenvaluesOnly);
+    const double emin = es.eigenvalues().minCoeff(), emax = es.eigenvalues().maxCoeff();
+    return emin > 0 ? emax / emin : std::numeric_limits<double>::infinity();
   }
 
-  for(auto i = 0U; i < ndiis; i++) {
-    for(auto j = i; j < ndiis; j++) { A(j, i) = A(i, j); }
+  // collective. the residuals of slot i have been written to its tensors: its row of B
+  void update(size_t i) {
+    EXPECTS(!tensors_.empty());
+    std::vector<Tensor<T>> r;
+    for(size_t k = 0; k < ncomp_; k++) r.push_back(tensors_[k][i]);
+    residual_row(i, r, false);
   }
-  for(auto i = 0U; i < ndiis; i++) {
-    A(i, ndiis) = -1.0;
-    A(ndiis, i) = -1.0;
+
+  // collective. stores r as the residuals of slot i and computes its row of B
+  void store_r(size_t i, std::vector<Tensor<T>> r) {
+    EXPECTS(r.size() == ncomp_);
+    residual_row(i, r, true);
   }
 
-  b(ndiis, 0) = -1;
+  // collective. stores t as the amplitudes of slot i
+  void store_t(size_t i, std::vector<Tensor<T>> t) {
+    EXPECTS(i < nslots_ && t.size() == ncomp_);
+    std::vector<T> tbuf;
+    for(size_t k = 0; k < ncomp_; k++) {
+      Tensor<T>&                      tk       = t[k];
+      const std::vector<IndexVector>& blockids = blocks(k, tk);
+      for(size_t b = 0; b < blockids.size(); b++) {
+        tbuf.resize(tk.block_size(blockids[b]));
+        tk.get(blockids[b], tbuf);
+        history_->put(i, ncomp_ + k, b, tbuf);
+      }
+    }
+  }
 
-  // Solve AX = B
-  // call dgesv(diis+1,1,a,maxdiis+1,iwork,b,maxdiis+1,info)
-  // Vector x = A.colPivHouseholderQr().solve(b);
-  Vector x = A.lu().solve(b);
+  // collective. next_t[k] = sum_j c_j ts[k][j] over the filled slots, with sum_j c_j = 1
+  void extrapolate(std::vector<Tensor<T>> next_t) {
+    EXPECTS(next_t.size() == ncomp_);
+    const std::vector<double> c = coefficients();
+
+    std::vector<T> tbuf, sbuf;
+    for(size_t k = 0; k < ncomp_; k++) {
+      Tensor<T>&                      dt       = next_t[k];
+      const std::vector<IndexVector>& blockids = blocks(k, dt);
+      for(size_t b = 0; b < blockids.size(); b++) {
+        const size_t size = dt.block_size(blockids[b]);
+        tbuf.assign(size, 0);
+        for(size_t j = 0; j < nslots_; j++) {
+          if(!filled_[j]) continue;
+          history_->get(j, ncomp_ + k, b, sbuf);
+          for(size_t x = 0; x < size; x++) tbuf[x] += c[j] * sbuf[x];
+        }
+        dt.put(blockids[b], tbuf);
+      }
+    }
+    ec_.pg().barrier();
+  }
+
+  //
+  //  collective. a step of rolling DIIS: if the overlap of the filled slots has a condition
+  //  number above max_cond, restarts the history from the newest slots whose overlap is well
+  //  conditioned, dropping the oldest ones. then extrapolates into next_t if two slots or more
+  //  are left. true on a restart.
+  //
+  bool roll(std::vector<Tensor<T>> next_t, double max_cond) {
+    bool restarted = false;
+    while(filled() > 1 && condition() > max_cond) {
+      forget(oldest());
+      restarted = true;
+    }
+    if(filled() > 1) extrapolate(next_t);
+    return restarted;
+  }
+
+private:
+  void init() {
+    EXPECTS(nslots_ > 0);
+    B_ = Matrix::Zero(nslots_, nslots_);
+    filled_.assign(nslots_, false);
+    stamp_.assign(nslots_, 0);
+    blocks_.assign(ncomp_, {});
+    listed_.assign(ncomp_, false);
+  }
+
+  //
+  //  the blocks of component k this rank handles, listed by block_for over tensor the first time
+  //  the component is seen and given to the history. the residuals and amplitudes of k, in every
+  //  slot, are then put and read back by their position in this list.
+  //
+  const std::vector<IndexVector>& blocks(size_t k, Tensor<T>& tensor) {
+    if(!listed_[k]) {
+      std::vector<size_t> sizes;
+      block_for(ec_, tensor(), [&](IndexVector blockid) {
+        blocks_[k].push_back(blockid);
+        sizes.push_back(tensor.block_size(blockid));
+      });
+      history_->layout(k, blocks_[k], sizes);
+      history_->layout(ncomp_ + k, blocks_[k], sizes);
+      listed_[k] = true;
+    }
+    return blocks_[k];
+  }
+
+  std::vector<size_t> filled_slots() const {
+    std::vector<size_t> slots;
+    for(size_t j = 0; j < nslots_; j++)
+      if(filled_[j]) slots.push_back(j);
+    return slots;
+  }
+
+  // the row of B of slot i, with the residuals r; they go to the history if store
+  void residual_row(size_t i, std::vector<Tensor<T>>& r, bool store) {
+    EXPECTS(i < nslots_);
+    filled_[i] = true;
+    stamp_[i]  = ++clock_;
+    std::vector<size_t> slots = filled_slots();
+
+    std::vector<double> row(slots.size(), 0);
+    std::vector<T>      rbuf, sbuf;
+    for(size_t k = 0; k < ncomp_; k++) {
+      Tensor<T>&                      rk       = r[k];
+      const std::vector<IndexVector>& blockids = blocks(k, rk);
+      for(size_t b = 0; b < blockids.size(); b++) {
+        const size_t size = rk.block_size(blockids[b]);
+        rbuf.resize(size);
+        rk.get(blockids[b], rbuf);
+        if(store) history_->put(i, k, b, rbuf);
+        for(size_t s = 0; s < slots.size(); s++) {
+          const T* other = rbuf.data();
+          if(slots[s] != i) {
+            history_->get(slots[s], k, b, sbuf);
+            other = sbuf.data();
+          }
+          double dot = 0;
+          for(size_t x = 0; x < size; x++) dot += rbuf[x] * other[x];
+          row[s] += dot;
+        }
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, row.data(), row.size(), MPI_DOUBLE, MPI_SUM, ec_.pg().comm());
+    for(size_t s = 0; s < slots.size(); s++) B_(i, slots[s]) = B_(slots[s], i) = row[s];
+  }
 
-  auto sch = Scheduler{ec};
-  for(auto k = 0U; k < ntensors; k++) {
-    Tensor<T>& dt = d_t[k];
-    sch(dt() = 0);
-    for(auto j = 0U; j < ndiis; j++) {
-      auto& tb = d_ts[k].at(j);
-      sch(dt() += x(j, 0) * tb());
+  // the DIIS coefficients of the slots, 0 for the empty ones
+  std::vector<double> coefficients() const {
+    std::vector<size_t> slots = filled_slots();
+    const size_t        n     = slots.size();
+    EXPECTS(n > 0);
+
+    Matrix A = Matrix::Zero(n + 1, n + 1);
+    Matrix b = Matrix::Zero(n + 1, 1);
+    for(size_t i = 0; i < n; i++) {
+      for(size_t j = 0; j < n; j++) A(i, j) = B_(slots[i], slots[j]);
+      A(i, n) = -1.0;
+      A(n, i) = -1.0;
     }
+    b(n, 0) = -1;
+
+    // Solve AX = B
+    Matrix              x = A.lu().solve(b);
+    std::vector<double> c(nslots_, 0);
+    for(size_t i = 0; i < n; i++) c[slots[i]] = x(i, 0);
+    return c;
   }
-  sch.execute();
+
+  ExecutionContext&                     ec_;
+  size_t                                ncomp_;
+  size_t                                nslots_ = 0;
+  std::unique_ptr<DIISHistory<T>>       history_;
+  std::vector<std::vector<Tensor<T>>>   tensors_; // [residuals, amplitudes][slot] in tensors
+  Matrix                                B_;
+  std::vector<bool>                     filled_;
+  std::vector<size_t>                   stamp_; // order in which the slots were updated
+  size_t                                clock_ = 0;
+  std::vector<std::vector<IndexVector>> blocks_; // [k], see blocks()
+  std::vector<bool>                     listed_;
+};
+
+/**
+ * @brief DIIS routine
+ * @tparam T Type of element in each tensor
+ * @param ec Execution context in which this function invoked
+ * @param[in] d_rs Vector of R tensors
+ * @param[in] d_ts Vector of T tensors
+ * @param[out] d_t Vector of T tensors produced by DIIS
+ * @pre d_rs.size() == d_ts.size()
+ * @pre 0<=i<d_rs.size(): d_rs[i].size() == d_t.size()
+ * @pre 0<=i<d_ts.size(): d_ts[i].size() == d_t.size()
+ */
+template<typename T>
+inline void diis(ExecutionContext& ec, std::vector<std::vector<Tensor<T>>>& d_rs,
+                 std::vector<std::vector<Tensor<T>>>& d_ts, std::vector<Tensor<T>> d_t) {
+  EXPECTS(d_t.size() == d_rs.size());
+  DIIS<T> diis_state{ec, d_rs, d_ts};
+  for(size_t i = 0; i < diis_state.size(); i++) diis_state.update(i);
+  diis_state.extrapolate(d_t);
 }
 
 } // namespace tamm
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "tamm/tamm.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tamm {
+
+//
+//  the DIIS history: for each slot, the blocks of its residual and amplitude tensors (component
+//  k of the slot). a rank stores and reads back only the blocks it owns, so a store holds no
+//  more than a rank's share of the history. the blocks of a component are given once by
+//  layout(), and put() and get() then name a block by its position b in that list.
+//
+template<typename T>
+class DIISHistory {
+public:
+  virtual ~DIISHistory() = default;
+
+  // the blocks of component k and their sizes; set once, before the first put of k
+  virtual void layout(size_t k, const std::vector<IndexVector>& blockids,
+                      const std::vector<size_t>& sizes) = 0;
+  virtual void put(size_t slot, size_t k, size_t b, std::vector<T>& buf) = 0;
+  // buf is resized to the block
+  virtual void get(size_t slot, size_t k, size_t b, std::vector<T>& buf) = 0;
+  // bytes this rank holds outside of TAMM tensors, in memory or on disk
+  virtual size_t bytes() const = 0;
+};
+
+// the history in TAMM tensors, tensors[k][slot]
+template<typename T>
+class DIISTensorHistory: public DIISHistory<T> {
+public:
+  explicit DIISTensorHistory(std::vector<std::vector<Tensor<T>>> tensors):
+    tensors_(std::move(tensors)), blockids_(tensors_.size()) {}
+
+  void layout(size_t k, const std::vector<IndexVector>& blockids,
+              const std::vector<size_t>&) override {
+    blockids_[k] = blockids;
+  }
+
+  void put(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    tensors_[k][slot].put(blockids_[k][b], buf);
+  }
+
+  void get(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    buf.resize(tensors_[k][slot].block_size(blockids_[k][b]));
+    tensors_[k][slot].get(blockids_[k][b], buf);
+  }
+
+  size_t bytes() const override { return 0; }
+
+private:
+  std::vector<std::vector<Tensor<T>>>   tensors_;
+  std::vector<std::vector<IndexVector>> blockids_;
+};
+
+//
+//  the history in files <prefix>.<slot>, one per slot and rank, on node-local disk. a block is
+//  written at the same place in every slot, laid out one component after the other. the files
+//  are removed with the store.
+//
+template<typename T>
+class DIISDiskHistory: public DIISHistory<T> {
+public:
+  DIISDiskHistory(size_t nslots, const std::string& prefix) {
+    for(size_t slot = 0; slot < nslots; slot++) {
+      names_.push_back(prefix + "." + std::to_string(slot));
+      files_.emplace_back(names_.back(), std::ios::in | std::ios::out | std::ios::binary |
+                                           std::ios::trunc);
+      if(!files_.back()) tamm_terminate("Error opening DIIS history file " + names_.back());
+    }
+  }
+
+  ~DIISDiskHistory() override {
+    for(size_t slot = 0; slot < files_.size(); slot++) {
+      files_[slot].close();
+      std::filesystem::remove(names_[slot]);
+    }
+  }
+
+  void layout(size_t k, const std::vector<IndexVector>& blockids,
+              const std::vector<size_t>& sizes) override {
+    if(k >= offsets_.size()) {
+      offsets_.resize(k + 1);
+      sizes_.resize(k + 1);
+    }
+    offsets_[k].clear();
+    for(auto size: sizes) {
+      offsets_[k].push_back(end_);
+      end_ += size;
+    }
+    sizes_[k] = sizes;
+  }
+
+  void put(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    EXPECTS(buf.size() == sizes_[k][b]);
+    auto& file = files_[slot];
+    file.seekp(offsets_[k][b] * sizeof(T));
+    file.write(reinterpret_cast<const char*>(buf.data()), buf.size() * sizeof(T));
+    if(!file) tamm_terminate("Error writing DIIS history file " + names_[slot]);
+  }
+
+  void get(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    buf.resize(sizes_[k][b]);
+    auto& file = files_[slot];
+    file.seekg(offsets_[k][b] * sizeof(T));
+    file.read(reinterpret_cast<char*>(buf.data()), buf.size() * sizeof(T));
+    if(!file) tamm_terminate("Error reading DIIS history file " + names_[slot]);
+  }
+
+  size_t bytes() const override { return end_ * sizeof(T) * files_.size(); }
+
+private:
+  std::vector<std::string>         names_;
+  std::vector<std::fstream>        files_;
+  std::vector<std::vector<size_t>> offsets_, sizes_; // [k][b], in elements
+  size_t                           end_ = 0;
+};
+
+//
+//  compression of a block of the DIIS history. with tol = 0 it is lossless: every 64-bit word
+//  is XORed with the previous one and stored without the zero bytes at both of its ends, behind
+//  a byte holding their numbers. neighbouring amplitudes mostly share their sign and exponent,
+//  and the zeroed blocks shrink to a byte per element.
+//
+//  with tol > 0 (real T only) every element is rounded to a multiple of 2 tol, so that it is off
+//  by at most tol, and stored as a variable-length integer: small elements take a byte. an
+//  extrapolation from such a history is off by at most tol sum_j |c_j|. only amplitudes are
+//  stored so: an absolute error in the residuals, which shrink towards convergence, would swamp
+//  the overlaps they give.
+//
+//  a block is a byte for the mode, its number of elements and, if rounded, the step. a block
+//  that does not shrink is stored as it is.
+//
+template<typename T>
+void diis_compress(const std::vector<T>& buf, double tol, std::vector<uint8_t>& out) {
+  static_assert(sizeof(T) % sizeof(uint64_t) == 0);
+  const uint64_t n = buf.size();
+  out.clear();
+  out.resize(1 + sizeof(n));
+  std::memcpy(&out[1], &n, sizeof(n));
+
+  if constexpr(std::is_floating_point_v<T>) {
+    const double step = 2 * tol;
+    bool         fits = step > 0;
+    for(size_t i = 0; i < n && fits; i++) fits = std::fabs(buf[i] / step) < 4e18;
+    if(fits) {
+      out[0] = 1;
+      out.resize(out.size() + sizeof(step));
+      std::memcpy(&out[1 + sizeof(n)], &step, sizeof(step));
+      for(size_t i = 0; i < n; i++) {
+        const int64_t q = std::llround(buf[i] / step);
+        uint64_t      z = (static_cast<uint64_t>(q) << 1) ^ static_cast<uint64_t>(q >> 63);
+        for(; z >= 0x80; z >>= 7) out.push_back(static_cast<uint8_t>(z | 0x80));
+        out.push_back(static_cast<uint8_t>(z));
+      }
+      return;
+    }
+  }
+
+  out[0] = 0;
+
+  const size_t nwords = n * sizeof(T) / sizeof(uint64_t);
+  uint64_t     prev   = 0;
+  const char*  data   = reinterpret_cast<const char*>(buf.data());
+  for(size_t i = 0; i < nwords; i++) {
+    uint64_t w;
+    std::memcpy(&w, data + i * sizeof(w), sizeof(w));
+    const uint64_t x = w ^ prev;
+    prev             = w;
+    if(x == 0) {
+      out.push_back(0x80);
+      continue;
+    }
+    const int lz = __builtin_clzll(x) / 8, tz = __builtin_ctzll(x) / 8;
+    out.push_back(static_cast<uint8_t>(lz << 4 | tz));
+    for(int b = tz; b < 8 - lz; b++) out.push_back(static_cast<uint8_t>(x >> (8 * b)));
+  }
+
+  if(out.size() > 1 + sizeof(n) + n * sizeof(T)) {
+    out.resize(1 + sizeof(n) + n * sizeof(T));
+    out[0] = 2;
+    std::memcpy(&out[1 + sizeof(n)], buf.data(), n * sizeof(T));
+  }
+}
+
+template<typename T>
+void diis_decompress(const std::vector<uint8_t>& in, std::vector<T>& buf) {
+  uint64_t n;
+  std::memcpy(&n, &in[1], sizeof(n));
+  buf.resize(n);
+  size_t p = 1 + sizeof(n);
+
+  if constexpr(std::is_floating_point_v<T>) {
+    if(in[0] == 1) {
+      double step;
+      std::memcpy(&step, &in[p], sizeof(step));
+      p += sizeof(step);
+      for(size_t i = 0; i < n; i++) {
+        uint64_t z = 0;
+        for(int shift = 0;; shift += 7) {
+          const uint8_t byte = in[p++];
+          z |= static_cast<uint64_t>(byte & 0x7f) << shift;
+          if(byte < 0x80) break;
+        }
+        const int64_t q = static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+        buf[i]          = static_cast<T>(q * step);
+      }
+      return;
+    }
+  }
+
+  if(in[0] == 2) {
+    std::memcpy(buf.data(), &in[p], n * sizeof(T));
+    return;
+  }
+
+  const size_t nwords = n * sizeof(T) / sizeof(uint64_t);
+  uint64_t     prev   = 0;
+  char*        data   = reinterpret_cast<char*>(buf.data());
+  for(size_t i = 0; i < nwords; i++) {
+    const int lz = in[p] >> 4, tz = in[p] & 0xf;
+    p++;
+    uint64_t x = 0;
+    for(int b = tz; b < 8 - lz; b++) x |= static_cast<uint64_t>(in[p++]) << (8 * b);
+    prev ^= x;
+    std::memcpy(data + i * sizeof(prev), &prev, sizeof(prev));
+  }
+}
+
+// the history compressed in memory, see diis_compress. the residuals (k < ncomp) are lossless
+template<typename T>
+class DIISCompressedHistory: public DIISHistory<T> {
+public:
+  DIISCompressedHistory(size_t nslots, size_t ncomp, double tol):
+    blocks_(nslots), ncomp_(ncomp), tol_(tol) {}
+
+  void layout(size_t k, const std::vector<IndexVector>& blockids,
+              const std::vector<size_t>&) override {
+    for(auto& slot: blocks_) {
+      if(k >= slot.size()) slot.resize(k + 1);
+      slot[k].resize(blockids.size());
+    }
+  }
+
+  void put(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    auto& bytes = blocks_[slot][k][b];
+    bytes_ -= bytes.capacity();
+    diis_compress(buf, k < ncomp_ ? 0.0 : tol_, scratch_);
+    bytes.assign(scratch_.begin(), scratch_.end());
+    bytes.shrink_to_fit();
+    bytes_ += bytes.capacity();
+  }
+
+  void get(size_t slot, size_t k, size_t b, std::vector<T>& buf) override {
+    diis_decompress(blocks_[slot][k][b], buf);
+  }
+
+  size_t bytes() const override { return bytes_; }
+
+private:
+  std::vector<std::vector<std::vector<std::vector<uint8_t>>>> blocks_; // [slot][k][b]
+  size_t                                                      ncomp_;
+  double                                                      tol_;
+  std::vector<uint8_t>                                        scratch_;
+  size_t                                                      bytes_ = 0;
+};
+
+//
+//  a disk or compressed store for nslots slots of ncomp residual and amplitude tensors. the files
+//  of a disk store go to dir, or to the system's temporary directory if dir is empty, as
+//  <name>.diis.<rank>.<slot>.
+//
+template<typename T>
+std::unique_ptr<DIISHistory<T>> make_diis_history(ExecutionContext& ec, const std::string& storage,
+                                                  size_t nslots, size_t ncomp,
+                                                  const std::string& dir, const std::string& name,
+                                                  double tol) {
+  if(storage == "disk") {
+    const std::filesystem::path path = dir.empty() ? std::filesystem::temp_directory_path()
+                                                   : std::filesystem::path(dir);
+    std::filesystem::create_directories(path);
+    const std::string prefix =
+      (path / (name + ".diis." + std::to_string(ec.pg().rank().value()))).string();
+    return std::make_unique<DIISDiskHistory<T>>(nslots, prefix);
+  }
+  EXPECTS(storage == "compressed");
+  return std::make_unique<DIISCompressedHistory<T>>(nslots, ncomp, tol);
+}
+
+} // namespace tamm
@@ -295,6 +295,9 @@ public:
     tilesize       = 40;
     itilesize      = 1000;
     ndiis          = 5;
+    diis_mode      = "block";
+    diis_start     = 3;
+    diis_max_cond  = 1e12;
     lshift         = 0;
     nactive        = 0;
     ccsd_maxiter   = 50;
@@ -303,6 +306,10 @@ public:
     balance_tiles  = true;
     profile_ccsd   = false;
 
+    diis_storage      = "memory";
+    diis_disk_path    = "";
+    diis_compress_tol = 0;
+
     writet       = false;
     writev       = false;
     writet_iter  = ndiis;
@@ -322,9 +329,24 @@ public:
     TCutDOij      = 1e-5;
     TCutDOPre     = 3e-2;
 
-    cache_size     = 8;
-    skip_ccsd      = false;
-    ccsdt_tilesize = 32;
+    cache_size          = 8;
+    skip_ccsd           = false;
+    ccsdt_tilesize      = 32;
+    ccsdt_prefetch      = false;
+    ccsdt_node_cache_mb = 0;
+    ccsdt_task_schedule = "static";
+    ccsdt_task_order    = "loop";
+    ccsdt_ckpt_interval = 0;
+    ccsdt_engine        = "tiled";
+    ccsdt_screen_thresh = 0;
+    ccsdt_iabc_cholesky = false;
+    ccsdt_autotune      = false;
+    ccsdt_precision     = "double";
+    ccsdt_fp32_sample   = 0;
+    ccsdt_huge_pages    = false;
+    ccsdt_ccsd_nodes    = 0;
+    ccsdt_v2_nodes      = 0;
+    ccsdt_phase_overlap = false;
 
     eom_nroots    = 1;
     eom_threshold = 1e-6;
@@ -381,6 +403,17 @@ public:
   bool force_tilesize;
   int  ndiis;
   int  writet_iter;
+  // block: extrapolate every ndiis iterations; rolling: every iteration from diis_start on, over
+  // the last ndiis iterations, restarting when the overlap condition number exceeds diis_max_cond
+  std::string diis_mode;
+  int         diis_start;
+  double      diis_max_cond;
+  // the DIIS history of the CD-CCSD drivers: memory (TAMM tensors), disk (node-local files in
+  // diis_disk_path, the temporary directory if empty) or compressed in memory, with an error of
+  // at most diis_compress_tol per amplitude (0 is lossless; the residuals are always lossless)
+  std::string diis_storage;
+  std::string diis_disk_path;
+  double      diis_compress_tol;
   bool readt, writet, writev, gf_restart, gf_ip, gf_ea, gf_os, gf_cs, gf_itriples, gf_profile,
     balance_tiles, computeTData;
   bool                    profile_ccsd;
@@ -407,9 +440,24 @@ public:
   double h_max;    // max time-step factor
 
   // CCSD(T)
-  bool skip_ccsd;
-  int  cache_size;
-  int  ccsdt_tilesize;
+  bool        skip_ccsd;
+  int         cache_size;
+  int         ccsdt_tilesize;
+  bool        ccsdt_prefetch;
+  int         ccsdt_node_cache_mb; // per node, 0 disables the node-shared block cache
+  std::string ccsdt_task_schedule; // static: loop-order counter, guided: cost-sorted chunks
+  std::string ccsdt_task_order;    // loop, auto or one of ccsd_t_task_orders
+  int         ccsdt_ckpt_interval; // seconds between (T) checkpoints, 0 disables them
+  std::string ccsdt_engine;        // tiled (tile sextets), closed_shell (RHF) or ijk (CPU DGEMMs)
+  double      ccsdt_screen_thresh; // skip tiled (T) tasks with a smaller energy bound, 0 disables
+  bool        ccsdt_iabc_cholesky; // build v2iabc blocks from the Cholesky vectors when needed
+  bool        ccsdt_autotune;      // pick ccsdt_tilesize and cache_size from a time/memory model
+  std::string ccsdt_precision;     // double, or mixed: FP32 inputs and CPU kernels, FP64 sums
+  double      ccsdt_fp32_sample;   // fraction of mixed-precision tasks re-run in FP64
+  bool        ccsdt_huge_pages;    // back large (T) host buffers with transparent huge pages
+  int         ccsdt_ccsd_nodes;    // nodes of the CCSD phase, 0 uses all (or a model, with overlap)
+  int         ccsdt_v2_nodes;      // nodes of the v2 setup phase, 0 picks them from a model
+  bool        ccsdt_phase_overlap; // build the v2 blocks on the nodes CCSD leaves idle
 
   // DLPNO
   bool             localize;
@@ -467,8 +515,40 @@ public:
     cout << "{" << endl;
     cout << " cache_size           = " << cache_size << endl;
     cout << " ccsdt_tilesize       = " << ccsdt_tilesize << endl;
+    if(ccsdt_prefetch) cout << " ccsdt_prefetch       = true" << endl;
+    if(ccsdt_node_cache_mb > 0)
+      cout << " ccsdt_node_cache_mb  = " << ccsdt_node_cache_mb << endl;
+    cout << " ccsdt_task_schedule  = " << ccsdt_task_schedule << endl;
+    cout << " ccsdt_task_order     = " << ccsdt_task_order << endl;
+    if(ccsdt_ckpt_interval > 0)
+      cout << " ccsdt_ckpt_interval  = " << ccsdt_ckpt_interval << endl;
+    cout << " ccsdt_engine         = " << ccsdt_engine << endl;
+    if(ccsdt_screen_thresh > 0)
+      cout << " ccsdt_screen_thresh  = " << ccsdt_screen_thresh << endl;
+    if(ccsdt_iabc_cholesky) cout << " ccsdt_iabc_cholesky  = true" << endl;
+    if(ccsdt_autotune) cout << " ccsdt_autotune       = true" << endl;
+    if(ccsdt_precision != "double") {
+      cout << " ccsdt_precision      = " << ccsdt_precision << endl;
+      cout << " ccsdt_fp32_sample    = " << ccsdt_fp32_sample << endl;
+    }
+    if(ccsdt_huge_pages) cout << " ccsdt_huge_pages     = true" << endl;
+    if(ccsdt_ccsd_nodes > 0) cout << " ccsdt_ccsd_nodes     = " << ccsdt_ccsd_nodes << endl;
+    if(ccsdt_v2_nodes > 0) cout << " ccsdt_v2_nodes       = " << ccsdt_v2_nodes << endl;
+    if(ccsdt_phase_overlap) cout << " ccsdt_phase_overlap  = true" << endl;
 
     cout << " ndiis                = " << ndiis << endl;
+    if(diis_mode == "rolling") {
+      cout << " diis_mode            = rolling" << endl;
+      cout << " diis_start           = " << diis_start << endl;
+      cout << " diis_max_cond        = " << diis_max_cond << endl;
+    }
+    if(diis_storage != "memory") {
+      cout << " diis_storage         = " << diis_storage << endl;
+      if(diis_storage == "disk" && !diis_disk_path.empty())
+        cout << " diis_disk_path       = " << diis_disk_path << endl;
+      if(diis_storage == "compressed")
+        cout << " diis_compress_tol    = " << diis_compress_tol << endl;
+    }
     cout << " threshold            = " << threshold << endl;
     cout << " tilesize             = " << tilesize << endl;
     if(nactive > 0) cout << " nactive              = " << nactive << endl;
@@ -780,18 +860,22 @@ parse_json(json& jinput) {
   // CC
   json                      jcc = jinput["CC"];
   const std::vector<string> valid_cc{
-    "CCSD(T)",     "DLPNO",     "EOMCCSD",        "RT-EOMCC",      "GFCCSD",
-    "comments",    "threshold", "force_tilesize", "tilesize",      "itilesize",
-    "lshift",      "ndiis",     "ccsd_maxiter",   "freeze_core",   "freeze_virtual",
-    "PRINT",       "readt",     "writet",         "writev",        "writet_iter",
-    "debug",       "nactive",   "profile_ccsd",   "balance_tiles", "ext_data_path",
-    "computeTData"};
+    "CCSD(T)",        "DLPNO",             "EOMCCSD",        "RT-EOMCC",      "GFCCSD",
+    "comments",       "threshold",         "force_tilesize", "tilesize",      "itilesize",
+    "lshift",         "ndiis",             "ccsd_maxiter",   "freeze_core",   "freeze_virtual",
+    "PRINT",          "readt",             "writet",         "writev",        "writet_iter",
+    "debug",          "nactive",           "profile_ccsd",   "balance_tiles", "ext_data_path",
+    "computeTData",   "diis_mode",         "diis_start",     "diis_max_cond", "diis_storage",
+    "diis_disk_path", "diis_compress_tol"};
   for(auto& el: jcc.items()) {
     if(std::find(valid_cc.begin(), valid_cc.end(), el.key()) == valid_cc.end())
       tamm_terminate("INPUT FILE ERROR: Invalid CC option [" + el.key() + "] in the input file");
   }
   // clang-format off
   parse_option<int>   (ccsd_options.ndiis         , jcc, "ndiis");
+  parse_option<string>(ccsd_options.diis_mode     , jcc, "diis_mode");
+  parse_option<int>   (ccsd_options.diis_start    , jcc, "diis_start");
+  parse_option<double>(ccsd_options.diis_max_cond , jcc, "diis_max_cond");
   parse_option<int>   (ccsd_options.nactive       , jcc, "nactive");
   parse_option<int>   (ccsd_options.ccsd_maxiter  , jcc, "ccsd_maxiter");
   parse_option<int>   (ccsd_options.freeze_core   , jcc, "freeze_core");
@@ -811,6 +895,10 @@ parse_json(json& jinput) {
   parse_option<string>(ccsd_options.ext_data_path , jcc, "ext_data_path");
   parse_option<bool>  (ccsd_options.computeTData  , jcc, "computeTData");
 
+  parse_option<string>(ccsd_options.diis_storage     , jcc, "diis_storage");
+  parse_option<string>(ccsd_options.diis_disk_path   , jcc, "diis_disk_path");
+  parse_option<double>(ccsd_options.diis_compress_tol, jcc, "diis_compress_tol");
+
   json jcc_print = jcc["PRINT"];
   parse_option<bool> (ccsd_options.ccsd_diagnostics, jcc_print, "ccsd_diagnostics");
   parse_option<std::pair<bool, double>>(ccsd_options.tamplitudes, jcc_print, "tamplitudes");
@@ -845,9 +933,24 @@ parse_json(json& jinput) {
   parse_option<std::vector<int>>(ccsd_options.doubles_opt_eqns, jdlpno, "doubles_opt_eqns");
 
   json jccsd_t = jcc["CCSD(T)"];
-  parse_option<bool>(ccsd_options.skip_ccsd    , jccsd_t, "skip_ccsd");
-  parse_option<int>(ccsd_options.cache_size    , jccsd_t, "cache_size");
-  parse_option<int>(ccsd_options.ccsdt_tilesize, jccsd_t, "ccsdt_tilesize");
+  parse_option<bool>  (ccsd_options.skip_ccsd          , jccsd_t, "skip_ccsd");
+  parse_option<int>   (ccsd_options.cache_size         , jccsd_t, "cache_size");
+  parse_option<int>   (ccsd_options.ccsdt_tilesize     , jccsd_t, "ccsdt_tilesize");
+  parse_option<bool>  (ccsd_options.ccsdt_prefetch     , jccsd_t, "ccsdt_prefetch");
+  parse_option<int>   (ccsd_options.ccsdt_node_cache_mb, jccsd_t, "ccsdt_node_cache_mb");
+  parse_option<string>(ccsd_options.ccsdt_task_schedule, jccsd_t, "ccsdt_task_schedule");
+  parse_option<string>(ccsd_options.ccsdt_task_order   , jccsd_t, "ccsdt_task_order");
+  parse_option<int>   (ccsd_options.ccsdt_ckpt_interval, jccsd_t, "ccsdt_ckpt_interval");
+  parse_option<string>(ccsd_options.ccsdt_engine       , jccsd_t, "ccsdt_engine");
+  parse_option<double>(ccsd_options.ccsdt_screen_thresh, jccsd_t, "ccsdt_screen_thresh");
+  parse_option<bool>  (ccsd_options.ccsdt_iabc_cholesky, jccsd_t, "ccsdt_iabc_cholesky");
+  parse_option<bool>  (ccsd_options.ccsdt_autotune     , jccsd_t, "ccsdt_autotune");
+  parse_option<string>(ccsd_options.ccsdt_precision    , jccsd_t, "ccsdt_precision");
+  parse_option<double>(ccsd_options.ccsdt_fp32_sample  , jccsd_t, "ccsdt_fp32_sample");
+  parse_option<bool>  (ccsd_options.ccsdt_huge_pages   , jccsd_t, "ccsdt_huge_pages");
+  parse_option<int>   (ccsd_options.ccsdt_ccsd_nodes   , jccsd_t, "ccsdt_ccsd_nodes");
+  parse_option<int>   (ccsd_options.ccsdt_v2_nodes     , jccsd_t, "ccsdt_v2_nodes");
+  parse_option<bool>  (ccsd_options.ccsdt_phase_overlap, jccsd_t, "ccsdt_phase_overlap");
 
   json jeomccsd = jcc["EOMCCSD"];
   parse_option<int>   (ccsd_options.eom_nroots   , jeomccsd, "eom_nroots");
@@ -855,6 +958,52 @@ parse_json(json& jinput) {
   parse_option<string>(ccsd_options.eom_type     , jeomccsd, "eom_type");
   parse_option<double>(ccsd_options.eom_threshold, jeomccsd, "eom_threshold");
   // clang-format on
+  std::vector<string> tslist{"static", "guided"};
+  if(std::find(std::begin(tslist), std::end(tslist), ccsd_options.ccsdt_task_schedule) ==
+     std::end(tslist))
+    tamm_terminate("INPUT FILE ERROR: ccsdt_task_schedule can only be one of [static,guided]");
+
+  std::vector<string> tolist{"loop", "auto", "h14256", "p456123", "morton", "blocked"};
+  if(std::find(std::begin(tolist), std::end(tolist), ccsd_options.ccsdt_task_order) ==
+     std::end(tolist))
+    tamm_terminate("INPUT FILE ERROR: ccsdt_task_order can only be one of "
+                   "[loop,auto,h14256,p456123,morton,blocked]");
+
+  std::vector<string> enlist{"tiled", "closed_shell", "ijk"};
+  if(std::find(std::begin(enlist), std::end(enlist), ccsd_options.ccsdt_engine) ==
+     std::end(enlist))
+    tamm_terminate("INPUT FILE ERROR: ccsdt_engine can only be one of [tiled,closed_shell,ijk]");
+
+  if(ccsd_options.ccsdt_screen_thresh < 0)
+    tamm_terminate("INPUT FILE ERROR: ccsdt_screen_thresh cannot be negative");
+
+  std::vector<string> prlist{"double", "mixed"};
+  if(std::find(std::begin(prlist), std::end(prlist), ccsd_options.ccsdt_precision) ==
+     std::end(prlist))
+    tamm_terminate("INPUT FILE ERROR: ccsdt_precision can only be one of [double,mixed]");
+
+  if(ccsd_options.ccsdt_fp32_sample < 0 || ccsd_options.ccsdt_fp32_sample > 1)
+    tamm_terminate("INPUT FILE ERROR: ccsdt_fp32_sample must be in [0,1]");
+
+  if(ccsd_options.ccsdt_ccsd_nodes < 0 || ccsd_options.ccsdt_v2_nodes < 0)
+    tamm_terminate("INPUT FILE ERROR: ccsdt_ccsd_nodes and ccsdt_v2_nodes cannot be negative");
+
+  std::vector<string> dmlist{"block", "rolling"};
+  if(std::find(std::begin(dmlist), std::end(dmlist), ccsd_options.diis_mode) == std::end(dmlist))
+    tamm_terminate("INPUT FILE ERROR: diis_mode can only be one of [block,rolling]");
+
+  if(ccsd_options.diis_start < 1) tamm_terminate("INPUT FILE ERROR: diis_start must be at least 1");
+  if(ccsd_options.diis_max_cond <= 1)
+    tamm_terminate("INPUT FILE ERROR: diis_max_cond must be greater than 1");
+
+  std::vector<string> dslist{"memory", "disk", "compressed"};
+  if(std::find(std::begin(dslist), std::end(dslist), ccsd_options.diis_storage) ==
+     std::end(dslist))
+    tamm_terminate("INPUT FILE ERROR: diis_storage can only be one of [memory,disk,compressed]");
+
+  if(ccsd_options.diis_compress_tol < 0)
+    tamm_terminate("INPUT FILE ERROR: diis_compress_tol cannot be negative");
+
   std::vector<string> etlist{"right", "left", "RIGHT", "LEFT"};
   if(std::find(std::begin(etlist), std::end(etlist), string(ccsd_options.eom_type)) ==
      std::end(etlist))